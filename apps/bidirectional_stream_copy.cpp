@@ -12,8 +12,9 @@ void bidirectional_stream_copy(Socket &socket, std::string_view peer_name)
     EventLoop _eventloop{};                // 创建事件循环对象
     FileDescriptor _input{STDIN_FILENO};   // 创建文件描述符对象，表示标准输入
     FileDescriptor _output{STDOUT_FILENO}; // 创建文件描述符对象，表示标准输出
-    ByteStream _outbound{buffer_size};     // 创建字节流对象，用于存储从标准输入读取的数据
-    ByteStream _inbound{buffer_size};      // 创建字节流对象，用于存储从套接字读取的数据
+    // 两个字节流都使用双重映射存储，使每次 write() 都能写出全部缓冲数据
+    ByteStream _outbound{buffer_size, ByteStream::Storage::Mirrored}; // 创建字节流对象，用于存储从标准输入读取的数据
+    ByteStream _inbound{buffer_size, ByteStream::Storage::Mirrored};  // 创建字节流对象，用于存储从套接字读取的数据
     bool _outbound_shutdown{false};        // 标记是否关闭了输出流
     bool _inbound_shutdown{false};         // 标记是否关闭了输入流
 
@@ -28,10 +29,8 @@ void bidirectional_stream_copy(Socket &socket, std::string_view peer_name)
         Direction::In,                               // 方向为输入
         [&]
         {
-            std::string data;                                     // 创建字符串用于存储读取的数据
-            data.resize(_outbound.writer().available_capacity()); // 调整字符串大小以适应可用容量
-            _input.read(data);                                    // 从标准输入读取数据
-            _outbound.writer().push(std::move(data));             // 将读取的数据推入输出字节流
+            Writer &writer = _outbound.writer();                                  // 获取输出字节流的写入器
+            writer.commit(_input.read(writer.prepare(writer.available_capacity()))); // 从标准输入直接读入字节流存储
             if (_input.eof())
             {                               // 如果到达输入流的末尾
                 _outbound.writer().close(); // 关闭输出字节流
@@ -62,7 +61,7 @@ void bidirectional_stream_copy(Socket &socket, std::string_view peer_name)
         {
             if (_outbound.reader().bytes_buffered())
             {                                                                    // 如果输出字节流中有缓冲数据
-                _outbound.reader().pop(socket.write(_outbound.reader().peek())); // 将数据写入套接字
+                _outbound.reader().pop(socket.write(_outbound.reader().peek_iov())); // 一次 writev 将所有缓冲数据写入套接字
             }
             if (_outbound.reader().is_finished())
             {                                                                             // 如果输出字节流已完成
@@ -93,10 +92,8 @@ void bidirectional_stream_copy(Socket &socket, std::string_view peer_name)
         Direction::In,                               // 方向为输入
         [&]
         {
-            std::string data;                                    // 创建字符串用于存储读取的数据
-            data.resize(_inbound.writer().available_capacity()); // 调整字符串大小以适应可用容量
-            socket.read(data);                                   // 从套接字读取数据
-            _inbound.writer().push(std::move(data));             // 将读取的数据推入输入字节流
+            Writer &writer = _inbound.writer();                                  // 获取输入字节流的写入器
+            writer.commit(socket.read(writer.prepare(writer.available_capacity()))); // 从套接字直接读入字节流存储
             if (socket.eof())
             {                              // 如果到达套接字的末尾
                 _inbound.writer().close(); // 关闭输入字节流
@@ -127,7 +124,7 @@ void bidirectional_stream_copy(Socket &socket, std::string_view peer_name)
         {
             if (_inbound.reader().bytes_buffered())
             {                                                                   // 如果输入字节流中有缓冲数据
-                _inbound.reader().pop(_output.write(_inbound.reader().peek())); // 将数据写入标准输出
+                _inbound.reader().pop(_output.write(_inbound.reader().peek_iov())); // 一次 writev 将所有缓冲数据写入标准输出
             }
             if (_inbound.reader().is_finished())
             {                             // 如果输入字节流已完成
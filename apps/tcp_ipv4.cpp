@@ -56,6 +56,7 @@ namespace
     {
         TCPConfig c_fsm{};                          // 创建 TCP 配置对象
         c_fsm.isn = Wrap32{std::random_device()()}; // 初始化 ISN（初始序列号）
+        c_fsm.stream_storage = ByteStream::Storage::Mirrored; // 使用双重映射存储的收发字节流
 
         FdAdapterConfig c_filt{};     // 创建文件描述符适配器配置对象
         const char *tundev = nullptr; // TUN 设备名称初始化为 nullptr
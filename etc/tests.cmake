@@ -37,6 +37,14 @@ ttest(byte_stream_one_write)
 ttest(byte_stream_two_writes)
 ttest(byte_stream_many_writes)
 ttest(byte_stream_stress_test)
+ttest(byte_stream_mirrored)
+ttest(byte_stream_prepare_commit)
+ttest(byte_stream_peek_iov)
+ttest(byte_stream_writev)
+ttest(byte_stream_spsc)
+ttest(byte_stream_spsc_socket)
+ttest(byte_stream_buffer_pool)
+ttest(byte_stream_resize)
 
 ttest(reassembler_single)
 ttest(reassembler_cap)
@@ -45,6 +53,9 @@ ttest(reassembler_dup)
 ttest(reassembler_holes)
 ttest(reassembler_overlapping)
 ttest(reassembler_win)
+ttest(reassembler_bitmap)
+ttest(reassembler_limits)
+ttest(reassembler_resize)
 
 ttest(wrapping_integers_cmp)
 ttest(wrapping_integers_wrap)
@@ -59,6 +70,10 @@ ttest(recv_reorder)
 ttest(recv_reorder_more)
 ttest(recv_close)
 ttest(recv_special)
+ttest(recv_sack)
+ttest(recv_window_scale)
+ttest(recv_autotune)
+ttest(recv_demux)
 
 ttest(send_connect)
 ttest(send_transmit)
@@ -67,6 +82,15 @@ ttest(send_window)
 ttest(send_ack)
 ttest(send_close)
 ttest(send_extra)
+ttest(send_congestion)
+ttest(send_rtt)
+ttest(send_fast_retx)
+ttest(send_sack)
+ttest(send_window_scale)
+ttest(send_pacing)
+ttest(send_mss)
+ttest(send_rack)
+ttest(send_timer_wheel)
 
 ttest(net_interface)
 ttest(router)
@@ -138,3 +162,8 @@ set_tests_properties(${compile_name_opt} PROPERTIES FIXTURES_SETUP compile_opt)
 # 使用宏 stest 添加多个速度测试
 stest(byte_stream_speed_test)
 stest(reassembler_speed_test)
+stest(congestion_speed_test)
+stest(timer_wheel_speed_test)
+stest(ack_ratio_speed_test)
+stest(header_prediction_speed_test)
+stest(demux_speed_test)
@@ -1,3 +1,5 @@
+#include <cstring>
+#include <algorithm>
 #include "byte_stream.h"
 
 /*
@@ -50,19 +52,44 @@ const Writer& ByteStream::writer() const
     return static_cast<const Writer&>(*this); // NOLINT(*-downcast)
 }
 
-ByteStream::ByteStream(uint64_t capacity) : capacity_(capacity) {}
+ByteStream::ByteStream(uint64_t capacity, Storage storage) : capacity_(capacity), buffer_(capacity, storage) {}
 
 bool Writer::is_closed() const
 {
     return closed_;
 }
 
-void Writer::push(std::string data)
+void Writer::push(std::string_view data)
 {
-    if (!is_closed() && available_capacity() > 0 && !data.empty())
+    const uint64_t len = std::min(static_cast<uint64_t>(data.size()), available_capacity());
+    if (is_closed() || len == 0)
     {
-        uint64_t len = std::min(static_cast<uint64_t>(data.size()), available_capacity());
-        bytes_stream_.emplace_back(data.substr(0, len)), bytes_pushed_ += len, bytes_buffered_ += len;
+        return;
+    }
+
+    // 堆存储下数据可能需要在缓冲区末尾折回到开头，双重映射时总是连续的
+    const auto spans = prepare(len);
+    std::memcpy(spans[0].data(), data.data(), spans[0].size());
+    std::memcpy(spans[1].data(), data.data() + spans[0].size(), spans[1].size());
+    commit(len);
+}
+
+std::array<std::span<char>, 2> Writer::prepare(uint64_t n)
+{
+    const uint64_t len = is_closed() ? 0 : std::min(n, available_capacity());
+    const uint64_t ring = buffer_.size();
+    uint64_t tail = head_ + bytes_buffered_;
+    tail -= tail >= ring ? ring : 0;
+    const uint64_t first = buffer_.mirrored() ? len : std::min(len, ring - tail);
+    return {std::span<char>{buffer_.data() + tail, first}, std::span<char>{buffer_.data(), len - first}};
+}
+
+void Writer::commit(uint64_t n)
+{
+    if (!is_closed())
+    {
+        n = std::min(n, available_capacity());
+        bytes_pushed_ += n, bytes_buffered_ += n;
     }
 }
 
@@ -71,6 +98,38 @@ void Writer::close()
     closed_ = true;
 }
 
+void Writer::set_capacity(uint64_t capacity)
+{
+    capacity = std::max(capacity, bytes_buffered_);
+    const uint64_t ring = buffer_.size();
+
+    // 新容量放得下、而且按新容量分配的环不会小一半以上时，原地修改即可
+    if (capacity <= ring && RingStorage::size_for(capacity, buffer_.mode()) * 2 > ring)
+    {
+        capacity_ = capacity;
+        return;
+    }
+
+    // 从读位置起按环的顺序搬到新环的开头，至多分为两段
+    RingStorage resized{capacity, buffer_.mode()};
+    const uint64_t keep = std::min(capacity_, capacity);
+    const uint64_t first = buffer_.mirrored() ? keep : std::min(keep, ring - head_);
+    if (keep > 0)
+    {
+        std::memcpy(resized.data(), buffer_.data() + head_, first);
+        std::memcpy(resized.data() + first, buffer_.data(), keep - first);
+    }
+
+    buffer_ = std::move(resized);
+    head_ = 0;
+    capacity_ = capacity;
+}
+
+uint64_t Writer::capacity() const
+{
+    return capacity_;
+}
+
 uint64_t Writer::available_capacity() const
 {
     return capacity_ - bytes_buffered_;
@@ -93,23 +152,37 @@ uint64_t Reader::bytes_popped() const
 
 std::string_view Reader::peek() const
 {
-    return bytes_buffered() > 0 ? std::string_view(bytes_stream_.front()).substr(remove_prefix_len_) : std::string_view();
+    // 堆存储只返回从读位置开始的连续部分，折回的数据在下一次 peek 时返回；
+    // 双重映射存储中所有缓冲数据在虚拟地址上都是连续的
+    const uint64_t len = buffer_.mirrored() ? bytes_buffered_ : std::min(bytes_buffered_, buffer_.size() - head_);
+    return {buffer_.data() + head_, len};
+}
+
+std::array<std::string_view, 2> Reader::peek_iov(uint64_t max_bytes) const
+{
+    // 环形缓冲区中的数据至多分为两段：读位置到末尾，以及开头的折回部分
+    return peek_range(0, max_bytes);
+}
+
+std::array<std::string_view, 2> Reader::peek_range(uint64_t offset, uint64_t len) const
+{
+    offset = std::min(offset, bytes_buffered_);
+    len = std::min(len, bytes_buffered_ - offset);
+    uint64_t pos = head_ + offset;
+    pos -= pos >= buffer_.size() ? buffer_.size() : 0;
+    const uint64_t first = buffer_.mirrored() ? len : std::min(len, buffer_.size() - pos);
+    return {std::string_view{buffer_.data() + pos, first}, std::string_view{buffer_.data(), len - first}};
 }
 
 void Reader::pop(uint64_t len)
 {
+    len = std::min(len, bytes_buffered_);
     bytes_popped_ += len, bytes_buffered_ -= len;
-    while (len > 0)
-    {
-        uint64_t sz = static_cast<uint64_t>(bytes_stream_.front().size() - remove_prefix_len_);
-        if (len < sz)
-        {
-            remove_prefix_len_ += len;
-            break;
-        }
-        bytes_stream_.pop_front();
-        remove_prefix_len_ = 0, len -= sz;
-    }
+
+    // 读位置只随弹出前进，缓冲区清空时也不移回开头：
+    // 写位置因此保持不变，prepare() 返回的区间在 commit() 之前始终有效
+    head_ += len;
+    head_ -= head_ >= buffer_.size() ? buffer_.size() : 0;
 }
 
 uint64_t Reader::bytes_buffered() const
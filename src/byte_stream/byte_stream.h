@@ -1,11 +1,13 @@
 #ifndef BYTE_STREAM_H
 #define BYTE_STREAM_H
 
+#include <array>
 #include <cstdint>
-#include <deque>
+#include <span>
 #include <string>
 #include <string_view>
 #include <stdexcept>
+#include "ring_storage.h"
 
 // 前向声明 Reader 和 Writer 类
 class Reader;
@@ -15,8 +17,11 @@ class Writer;
 class ByteStream
 {
 public:
-    // 构造函数，初始化流的容量
-    explicit ByteStream(uint64_t capacity);
+    // 底层存储模式：Heap 为普通堆内存；Mirrored 为双重映射的环，peek() 总能一次返回全部缓冲数据
+    using Storage = RingStorage::Mode;
+
+    // 构造函数，初始化流的容量和存储模式
+    explicit ByteStream(uint64_t capacity, Storage storage = Storage::Heap);
 
     // 获取 Reader 和 Writer 的引用
     Reader &reader();
@@ -29,14 +34,14 @@ public:
     bool has_error() const { return error_; };
 
 protected:
-    uint64_t capacity_;                      // 流的最大容量
-    bool error_{false};                      // 错误状态标志
-    bool closed_{false};                     // 流是否已关闭
-    uint64_t bytes_pushed_{0};               // 已推入的字节数
-    uint64_t bytes_popped_{0};               // 已弹出的字节数
-    uint64_t bytes_buffered_{0};             // 当前缓冲的字节数
-    uint64_t remove_prefix_len_{0};          // 用于管理缓冲区前缀的长度
-    std::deque<std::string> bytes_stream_{}; // 用于存储字节流的数据结构
+    uint64_t capacity_;          // 流的最大容量
+    bool error_{false};          // 错误状态标志
+    bool closed_{false};         // 流是否已关闭
+    uint64_t bytes_pushed_{0};   // 已推入的字节数
+    uint64_t bytes_popped_{0};   // 已弹出的字节数
+    uint64_t bytes_buffered_{0}; // 当前缓冲的字节数
+    uint64_t head_{0};           // 环形缓冲区中下一个可读字节的位置
+    RingStorage buffer_;         // 环形缓冲区，按 capacity_ 分配，容量超出时由 set_capacity() 重新分配
 };
 
 // Writer 类继承自 ByteStream，提供写入功能
@@ -44,12 +49,25 @@ class Writer : public ByteStream
 {
 public:
     // 将数据推入流中
-    void push(std::string data);
+    void push(std::string_view data);
+
+    // 在流的存储中预留至多 n 字节（不超过可用容量）的可写空间。
+    // 返回至多两段可写区间，调用者直接写入后再用 commit() 提交，避免中间缓冲区。
+    std::array<std::span<char>, 2> prepare(uint64_t n);
+    // 提交最近一次 prepare() 返回区间中已写入的前 n 字节
+    void commit(uint64_t n);
     // 关闭流
     void close();
 
+    // 运行时调整流的容量，不会小于当前缓冲的字节数。
+    // 容量仍在环内时只修改上限；否则换用新的环，并把读位置起的 min(旧容量, 新容量) 字节搬到开头，
+    // 已 prepare() 但尚未 commit() 的内容也随之保留。之前 prepare() 返回的区间随即失效，需要重新获取
+    void set_capacity(uint64_t capacity);
+
     // 检查流是否已关闭
     bool is_closed() const;
+    // 获取流的容量
+    uint64_t capacity() const;
     // 获取流的可用容量
     uint64_t available_capacity() const;
     // 获取已推入的字节数
@@ -62,6 +80,11 @@ class Reader : public ByteStream
 public:
     // 查看流中当前可读取的数据
     std::string_view peek() const;
+    // 以分散/聚集的形式查看至多 max_bytes 字节的缓冲数据：环形缓冲区中至多两段，不折回时第二段为空。
+    // 可直接交给 FileDescriptor::write() 一次 writev 写出，再 pop() 实际写出的字节数
+    std::array<std::string_view, 2> peek_iov(uint64_t max_bytes = UINT64_MAX) const;
+    // 查看读位置之后第 offset 字节起的至多 len 字节，不弹出；堆存储中折回的数据在第二段，不折回时第二段为空
+    std::array<std::string_view, 2> peek_range(uint64_t offset, uint64_t len) const;
     // 从流中弹出指定长度的数据
     void pop(uint64_t len);
 
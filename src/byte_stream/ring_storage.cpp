@@ -0,0 +1,125 @@
+#include <cstring>
+#include <algorithm>
+#include <utility>
+#include <unistd.h>
+#include <sys/mman.h>
+#include "exception.h"
+#include "buffer_pool.h"
+#include "ring_storage.h"
+
+RingStorage::RingStorage(uint64_t min_size, Mode mode) : mode_(mode), size_(size_for(min_size, mode))
+{
+    acquire();
+}
+
+uint64_t RingStorage::size_for(uint64_t min_size, Mode mode)
+{
+    if (mode != Mode::Mirrored)
+    {
+        return min_size;
+    }
+    // 双重映射要求环的大小是页大小的整数倍
+    const auto page = static_cast<uint64_t>(CheckSystemCall("sysconf", static_cast<int>(sysconf(_SC_PAGESIZE))));
+    return std::max(page, (min_size + page - 1) / page * page);
+}
+
+RingStorage::~RingStorage()
+{
+    release();
+}
+
+RingStorage::RingStorage(const RingStorage &other) : mode_(other.mode_), size_(other.size_)
+{
+    acquire();
+    if (size_ > 0)
+    {
+        std::memcpy(data_, other.data_, size_);
+    }
+}
+
+RingStorage &RingStorage::operator=(const RingStorage &other)
+{
+    if (this != &other)
+    {
+        RingStorage copy{other};
+        *this = std::move(copy);
+    }
+    return *this;
+}
+
+RingStorage::RingStorage(RingStorage &&other) noexcept
+    : mode_(other.mode_), size_(std::exchange(other.size_, 0)), data_(std::exchange(other.data_, nullptr))
+{
+}
+
+RingStorage &RingStorage::operator=(RingStorage &&other) noexcept
+{
+    if (this != &other)
+    {
+        release();
+        mode_ = other.mode_;
+        size_ = std::exchange(other.size_, 0);
+        data_ = std::exchange(other.data_, nullptr);
+    }
+    return *this;
+}
+
+void RingStorage::acquire()
+{
+    if (mirrored())
+    {
+        map_mirrored();
+    }
+    else
+    {
+        data_ = BufferPool::global().allocate(size_);
+    }
+}
+
+void RingStorage::release()
+{
+    if (data_ == nullptr)
+    {
+        return;
+    }
+    if (mirrored())
+    {
+        munmap(data_, 2 * size_);
+    }
+    else
+    {
+        BufferPool::global().deallocate(data_, size_);
+    }
+    data_ = nullptr;
+}
+
+void RingStorage::map_mirrored()
+{
+    const int fd = CheckSystemCall("memfd_create", memfd_create("minnow_bytestream", MFD_CLOEXEC));
+    try
+    {
+        CheckSystemCall("ftruncate", ftruncate(fd, static_cast<off_t>(size_)));
+
+        // 先保留 2 * size_ 的连续地址空间，再把同一个 memfd 固定映射到前后两半
+        void *base = mmap(nullptr, 2 * size_, PROT_NONE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (base == MAP_FAILED)
+        {
+            throw unix_error{"mmap"};
+        }
+        data_ = static_cast<char *>(base);
+        for (const uint64_t offset : {uint64_t{0}, size_})
+        {
+            if (mmap(data_ + offset, size_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_FIXED, fd, 0) == MAP_FAILED)
+            {
+                throw unix_error{"mmap"};
+            }
+        }
+    }
+    catch (...)
+    {
+        release();
+        ::close(fd);
+        throw;
+    }
+    ::close(fd); // 映射建立后不再需要文件描述符
+}
@@ -0,0 +1,55 @@
+#ifndef RING_STORAGE_H
+#define RING_STORAGE_H
+
+#include <cstdint>
+
+// RingStorage 管理 ByteStream 环形缓冲区的底层内存。
+//
+// 两种模式：
+//   - Heap：从进程共享的 BufferPool 借出的内存块，大小等于请求的容量；
+//   - Mirrored：用 memfd 在一段连续的虚拟地址上映射两次（"magic ring"），
+//     大小按页向上取整。data()[i] 与 data()[i + size()] 指向同一个物理字节，
+//     因此从任意位置开始的 size() 字节总是连续可访问的，环形数据不会被折断。
+class RingStorage
+{
+public:
+    enum class Mode
+    {
+        Heap,    // 堆内存
+        Mirrored // memfd 双重映射
+    };
+
+    RingStorage(uint64_t min_size, Mode mode);
+    ~RingStorage();
+
+    // 拷贝时按相同模式和大小重新分配存储并复制内容
+    RingStorage(const RingStorage &other);
+    RingStorage &operator=(const RingStorage &other);
+    RingStorage(RingStorage &&other) noexcept;
+    RingStorage &operator=(RingStorage &&other) noexcept;
+
+    char *data() { return data_; }
+    const char *data() const { return data_; }
+
+    // 环的模长，Mirrored 模式下可能大于请求的容量
+    uint64_t size() const { return size_; }
+    Mode mode() const { return mode_; }
+    bool mirrored() const { return mode_ == Mode::Mirrored; }
+
+    // 以 mode 申请至少 min_size 字节时环的实际大小
+    static uint64_t size_for(uint64_t min_size, Mode mode);
+
+private:
+    Mode mode_;
+    uint64_t size_;
+    char *data_{nullptr}; // Heap 模式下为内存池中的块；Mirrored 模式下为映射区域的起始地址（长度为 2 * size_）
+
+    // 按当前模式和大小申请存储
+    void acquire();
+    // 归还存储
+    void release();
+    // 建立双重映射
+    void map_mirrored();
+};
+
+#endif
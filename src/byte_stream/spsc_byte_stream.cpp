@@ -0,0 +1,163 @@
+#include <cstring>
+#include <algorithm>
+#include "spsc_byte_stream.h"
+
+SPSCByteStream::SPSCByteStream(uint64_t capacity) : capacity_(capacity), buffer_(capacity, RingStorage::Mode::Heap) {}
+
+uint64_t SPSCByteStream::push(std::string_view data)
+{
+    const auto spans = prepare(data.size());
+    const uint64_t len = spans[0].size() + spans[1].size();
+    if (len == 0)
+    {
+        return 0;
+    }
+    std::memcpy(spans[0].data(), data.data(), spans[0].size());
+    std::memcpy(spans[1].data(), data.data() + spans[0].size(), spans[1].size());
+    commit(len);
+    return len;
+}
+
+std::array<std::span<char>, 2> SPSCByteStream::prepare(uint64_t n)
+{
+    const uint64_t len = (is_closed() || has_error()) ? 0 : std::min(n, available_capacity());
+    if (len == 0)
+    {
+        return {};
+    }
+    const uint64_t tail = bytes_pushed_.load() % capacity_;
+    const uint64_t first = std::min(len, capacity_ - tail);
+    return {std::span<char>{buffer_.data() + tail, first}, std::span<char>{buffer_.data(), len - first}};
+}
+
+void SPSCByteStream::commit(uint64_t n)
+{
+    n = is_closed() ? 0 : std::min(n, available_capacity());
+    if (n == 0)
+    {
+        return;
+    }
+    const uint64_t old_pushed = bytes_pushed_.load();
+    bytes_pushed_.store(old_pushed + n);
+
+    // 发布前缓冲区为空，消费者可能正在等待
+    if (bytes_popped_.load() == old_pushed)
+    {
+        readable_.notify();
+    }
+}
+
+void SPSCByteStream::close()
+{
+    closed_.store(true);
+    readable_.notify();
+}
+
+bool SPSCByteStream::is_closed() const
+{
+    return closed_.load();
+}
+
+uint64_t SPSCByteStream::available_capacity() const
+{
+    return capacity_ - bytes_buffered();
+}
+
+uint64_t SPSCByteStream::bytes_pushed() const
+{
+    return bytes_pushed_.load();
+}
+
+std::array<std::string_view, 2> SPSCByteStream::peek_iov(uint64_t max_bytes) const
+{
+    const uint64_t len = std::min(max_bytes, bytes_buffered());
+    if (len == 0)
+    {
+        return {};
+    }
+    // 缓冲数据至多分为两段：读位置到末尾，以及开头的折回部分
+    const uint64_t head = bytes_popped_.load() % capacity_;
+    const uint64_t first = std::min(len, capacity_ - head);
+    return {std::string_view{buffer_.data() + head, first}, std::string_view{buffer_.data(), len - first}};
+}
+
+uint64_t SPSCByteStream::read(std::span<char> out)
+{
+    uint64_t copied = 0;
+    for (const auto view : peek_iov(out.size()))
+    {
+        if (view.empty())
+        {
+            continue; // 不折回时第二段为空
+        }
+        std::memcpy(out.data() + copied, view.data(), view.size());
+        copied += view.size();
+    }
+    pop(copied);
+    return copied;
+}
+
+void SPSCByteStream::pop(uint64_t len)
+{
+    len = std::min(len, bytes_buffered());
+    if (len == 0)
+    {
+        return;
+    }
+    const uint64_t old_popped = bytes_popped_.load();
+    bytes_popped_.store(old_popped + len);
+
+    // 弹出前缓冲区是满的，生产者可能正在等待
+    if (bytes_pushed_.load() - old_popped == capacity_)
+    {
+        writable_.notify();
+    }
+}
+
+bool SPSCByteStream::is_finished() const
+{
+    // 先读关闭标志再读计数器：看到关闭时，关闭前推入的所有数据都已可见
+    return is_closed() && bytes_buffered() == 0;
+}
+
+uint64_t SPSCByteStream::bytes_buffered() const
+{
+    const uint64_t popped = bytes_popped_.load();
+    return bytes_pushed_.load() - popped;
+}
+
+uint64_t SPSCByteStream::bytes_popped() const
+{
+    return bytes_popped_.load();
+}
+
+void SPSCByteStream::set_error()
+{
+    error_.store(true);
+    readable_.notify();
+    writable_.notify();
+}
+
+bool SPSCByteStream::has_error() const
+{
+    return error_.load();
+}
+
+void SPSCByteStream::wait_readable()
+{
+    // 先检查、再等待、最后清除信号后重新检查：清除之后到达的信号会留在计数器中，不会丢失
+    while (bytes_buffered() == 0 && !is_closed() && !has_error())
+    {
+        readable_.wait();
+        readable_.drain();
+    }
+}
+
+void SPSCByteStream::wait_writable()
+{
+    while (capacity_ > 0 && available_capacity() == 0 && !has_error())
+    {
+        writable_.wait();
+        writable_.drain();
+    }
+}
@@ -0,0 +1,72 @@
+#ifndef SPSC_BYTE_STREAM_H
+#define SPSC_BYTE_STREAM_H
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <span>
+#include <string_view>
+#include "eventfd.h"
+#include "ring_storage.h"
+
+// SPSCByteStream 是 ByteStream 的线程安全变体，供恰好一个生产者线程和一个消费者线程共享。
+//
+// 两端各自只写自己的计数器：生产者推进 bytes_pushed_，消费者推进 bytes_popped_，
+// 因此读写都不需要加锁，拷贝只发生在用户态。为了在对端休眠时把它叫醒，附带两个 eventfd：
+//   - readable_event()：有新数据、流被关闭或出错时由生产者触发，消费者等待它；
+//   - writable_event()：缓冲区从满变为不满时由消费者触发，生产者等待它。
+// 只有在对端可能正在等待（缓冲区此前为空/满）时才会触发 eventfd，稳态下不产生系统调用。
+class SPSCByteStream
+{
+public:
+    explicit SPSCByteStream(uint64_t capacity);
+
+    // 生产者接口
+    uint64_t push(std::string_view data);               // 推入尽可能多的数据，返回实际推入的字节数
+    std::array<std::span<char>, 2> prepare(uint64_t n); // 预留至多 n 字节的可写空间（同 Writer::prepare）
+    void commit(uint64_t n);                            // 发布最近一次 prepare() 中已写入的前 n 字节
+    void close();                                       // 关闭流
+    bool is_closed() const;
+    uint64_t available_capacity() const;
+    uint64_t bytes_pushed() const;
+
+    // 消费者接口
+    std::array<std::string_view, 2> peek_iov(uint64_t max_bytes = UINT64_MAX) const; // 查看至多两段缓冲数据，不折回时第二段为空
+    uint64_t read(std::span<char> out);                                                // 拷贝出至多 out.size() 字节并弹出
+    void pop(uint64_t len);                                                            // 弹出 len 字节
+    bool is_finished() const;
+    uint64_t bytes_buffered() const;
+    uint64_t bytes_popped() const;
+
+    // 任意一端都可以设置错误，两端的等待者都会被唤醒
+    void set_error();
+    bool has_error() const;
+
+    // 唤醒描述符，可以交给 EventLoop 轮询
+    EventFD &readable_event() { return readable_; }
+    EventFD &writable_event() { return writable_; }
+
+    // 阻塞等待，直到有数据可读（或流已结束/出错）/ 有空间可写（或出错）
+    void wait_readable();
+    void wait_writable();
+
+    // 两端共享原子变量和 eventfd，不允许拷贝或移动
+    SPSCByteStream(const SPSCByteStream &) = delete;
+    SPSCByteStream &operator=(const SPSCByteStream &) = delete;
+
+private:
+    uint64_t capacity_;
+    RingStorage buffer_;
+    EventFD readable_{};
+    EventFD writable_{};
+
+    // 两个计数器分处不同的缓存行，避免生产者和消费者互相使对方的缓存行失效。
+    // 计数器只增不减，位置由对环大小取模得到；所有访问使用顺序一致的内存序，
+    // 以保证"发布数据后检查对端是否可能在等待"不会与对端的"检查后等待"交错而丢失唤醒。
+    alignas(64) std::atomic<uint64_t> bytes_pushed_{0}; // 仅由生产者写入
+    std::atomic<bool> closed_{false};                   // 仅由生产者写入
+    alignas(64) std::atomic<uint64_t> bytes_popped_{0}; // 仅由消费者写入
+    std::atomic<bool> error_{false};
+};
+
+#endif
@@ -32,7 +32,9 @@ void NetworkInterface::send_datagram(const InternetDatagram &dgram, const Addres
     {
         transmit(make_frame(EthernetHeader::TYPE_ARP,
                             serialize(make_arp_mesg(ARPMessage::OPCODE_REQUEST, target_ip))));
-        arp_requests_.emplace(target_ip, 0);
+        // 超过 5 秒后才允许再次请求
+        arp_requests_.emplace(target_ip, now_ms_ + rto_arp_ + 1);
+        request_expiry_.emplace(now_ms_ + rto_arp_ + 1, target_ip);
     }
 }
 
@@ -60,7 +62,7 @@ void NetworkInterface::recv_frame(const EthernetFrame &frame)
         if (parse(arp_msg, frame.payload))
         {
             // 更新 ARP 地址映射表
-            arp_addr_table_.insert_or_assign(arp_msg.sender_ip_address, AddrMapping(arp_msg.sender_ethernet_address));
+            remember_mapping(arp_msg.sender_ip_address, arp_msg.sender_ethernet_address);
 
             if (arp_msg.opcode == ARPMessage::OPCODE_REQUEST &&
                 arp_msg.target_ip_address == ip_address_.ipv4_numeric())
@@ -88,17 +90,33 @@ void NetworkInterface::recv_frame(const EthernetFrame &frame)
 // 定期调用以处理时间流逝
 void NetworkInterface::tick(size_t ms_since_last_tick)
 {
-    // 刷新数据表，删除超时项
-    auto flush_timer = [ms_since_last_tick](auto &data_table, const uint32_t deadline)
+    now_ms_ += ms_since_last_tick;
+
+    // 删除到期的表项和请求；表中的过期时间与队列里的记录不同，说明表项在那之后刷新过
+    for (; !mapping_expiry_.empty() && mapping_expiry_.front().first <= now_ms_; mapping_expiry_.pop())
     {
-        std::erase_if(data_table, [ms_since_last_tick, deadline](auto &entry)
+        const auto [deadline, ip] = mapping_expiry_.front();
+        if (auto iter = arp_addr_table_.find(ip); iter != arp_addr_table_.end() && iter->second.deadline() == deadline)
         {
-            entry.second += ms_since_last_tick;
-            return entry.second > deadline;
-        });
-    };
-    flush_timer(arp_addr_table_, rto_map_);
-    flush_timer(arp_requests_, rto_arp_);
+            arp_addr_table_.erase(iter);
+        }
+    }
+    for (; !request_expiry_.empty() && request_expiry_.front().first <= now_ms_; request_expiry_.pop())
+    {
+        const auto [deadline, ip] = request_expiry_.front();
+        if (auto iter = arp_requests_.find(ip); iter != arp_requests_.end() && iter->second == deadline)
+        {
+            arp_requests_.erase(iter);
+        }
+    }
+}
+
+// 记录地址映射，超过 30 秒没有刷新就过期
+void NetworkInterface::remember_mapping(uint32_t ip, const EthernetAddress &ether)
+{
+    const uint64_t deadline = now_ms_ + rto_map_ + 1;
+    arp_addr_table_.insert_or_assign(ip, AddrMapping(ether, deadline));
+    mapping_expiry_.emplace(deadline, ip);
 }
 
 // 创建 ARP 消息
@@ -116,10 +134,3 @@ EthernetFrame NetworkInterface::make_frame(const uint16_t protocol, std::vector<
 {
     return EthernetFrame{{dst.value_or(ETHERNET_BROADCAST), ethernet_address_, protocol}, std::move(payload)};
 }
-
-// 更新 AddrMapping 的计时器
-NetworkInterface::AddrMapping &NetworkInterface::AddrMapping::tick(const size_t ms_time_passed) noexcept
-{
-    timer_ += ms_time_passed;
-    return *this;
-}
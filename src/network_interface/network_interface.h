@@ -5,6 +5,7 @@
 #include <compare>
 #include <optional>
 #include <unordered_map>
+#include <utility>
 #include "address.h"
 #include "arp_message.h"
 #include "ethernet_frame.h"
@@ -50,21 +51,16 @@ public:
     std::queue<InternetDatagram> &datagrams_received() { return datagrams_received_; }
 
 private:
-    // 辅助类，用于存储以太网地址映射及其过期计时器。
+    // 辅助类，用于存储以太网地址映射及其过期时间。
     class AddrMapping
     {
         EthernetAddress ether_addr_; // 以太网地址。
-        size_t timer_;               // 计时器。
+        uint64_t deadline_ms_;       // 过期时间。
 
     public:
-        explicit AddrMapping(EthernetAddress ether_addr) : ether_addr_{std::move(ether_addr)}, timer_{} {}
+        AddrMapping(EthernetAddress ether_addr, uint64_t deadline_ms) : ether_addr_{std::move(ether_addr)}, deadline_ms_{deadline_ms} {}
         EthernetAddress get_ether() const noexcept { return ether_addr_; }
-        // 提供一种方便的方法来更新计时器，在 `tick()` 方法中使用。
-        AddrMapping &operator+=(const size_t ms_time_passed) noexcept { return tick(ms_time_passed); }
-        // 将计时器与截止时间进行比较，以确定映射是否已过期。
-        auto operator<=>(const size_t deadline) const { return timer_ <=> deadline; }
-        // 按指定的时间量更新计时器。
-        AddrMapping &tick(const size_t ms_time_passed) noexcept;
+        uint64_t deadline() const noexcept { return deadline_ms_; }
     };
 
     std::string name_; // 网络接口名称。
@@ -82,11 +78,21 @@ private:
     const uint32_t rto_map_ = 30000; // ARP 表项的超时时间（30 秒）。
     const uint32_t rto_arp_ = 5000;  // ARP 请求的超时时间（5 秒）。
 
-    // ARP 表，将 IP 地址映射到以太网地址，并带有过期计时器。
+    uint64_t now_ms_{}; // 由 tick() 累计的当前时间。
+
+    // ARP 表，将 IP 地址映射到以太网地址，并带有过期时间。
     std::unordered_map<uint32_t, AddrMapping> arp_addr_table_{};
 
-    // 跟踪为特定 IP 地址发送的 ARP 请求，带有计时器以防止频繁重发。
-    std::unordered_map<uint32_t, uint32_t> arp_requests_{};
+    // 跟踪为特定 IP 地址发送的 ARP 请求及其过期时间，以防止频繁重发。
+    std::unordered_map<uint32_t, uint64_t> arp_requests_{};
+
+    // 两种表项的超时时间都是固定的，按设置的顺序排队就是按过期时间排序：tick() 只弹出到期的队首，
+    // 不遍历两张表。刷新过的表项在表中有更晚的过期时间，它在队列里的旧记录到期时跳过。
+    std::queue<std::pair<uint64_t, uint32_t>> mapping_expiry_{}; // （过期时间，IP 地址）
+    std::queue<std::pair<uint64_t, uint32_t>> request_expiry_{}; // （过期时间，IP 地址）
+
+    // 记录（或刷新）一个地址映射，重新开始它的过期计时。
+    void remember_mapping(uint32_t ip, const EthernetAddress &ether);
 
     // 存储等待 ARP 解析的 IP 数据报，以目标 IP 地址为键。
     std::unordered_multimap<uint32_t, InternetDatagram> datagrams_waiting_{};
@@ -1,5 +1,44 @@
+#include <atomic>
+#include <bit>
+#include <cstring>
+#include <utility>
 #include "reassembler.h"
 
+namespace
+{
+    // 全进程所有 IntervalMap 重组器共享的乱序字节统计
+    std::atomic<uint64_t> global_pending{0};
+    std::atomic<uint64_t> global_pending_limit{UINT64_MAX};
+    std::atomic<uint64_t> global_evicted{0};
+
+    // 一个区间占用的池内存：容量加结尾空字符所在的块；放得进字符串对象本身的短区间也按最小的块计
+    uint64_t footprint(const PooledString &interval)
+    {
+        return BufferPool::chunk_size(interval.capacity() + 1);
+    }
+
+    // 占用不超过 budget 字节池内存时，一个区间最多能保留的字节数；连最小的块都放不下时为 0
+    uint64_t max_length_within(uint64_t budget)
+    {
+        if (budget > BufferPool::CHUNK_SIZES.back())
+        {
+            return budget - 1;
+        }
+        const auto *it = std::upper_bound(BufferPool::CHUNK_SIZES.begin(), BufferPool::CHUNK_SIZES.end(), budget);
+        return it == BufferPool::CHUNK_SIZES.begin() ? 0 : *std::prev(it) - 1;
+    }
+}
+
+Reassembler::Reassembler(ByteStream &&output, Engine engine, uint64_t pending_limit)
+    : output_(std::move(output)), pending_limit_(pending_limit), engine_(engine)
+{
+    if (engine_ == Engine::Bitmap)
+    {
+        window_size_ = output_.writer().available_capacity() + output_.reader().bytes_buffered();
+        present_.resize((window_size_ + 63) / 64);
+    }
+}
+
 // 插入数据片段到重组器中
 void Reassembler::insert(uint64_t first_index, std::string data, bool is_last_substring)
 {
@@ -30,83 +69,289 @@ void Reassembler::insert(uint64_t first_index, std::string data, bool is_last_su
         return;
     }
 
-    // 创建一个新的数据区间
-    Interval itv(beg_idx, end_idx, data.substr(beg_idx - first_index, end_idx - beg_idx));
+    if (beg_idx == first_unassembled_index_ && bytes_pending_ == 0)
+    {
+        // 快速路径：按序到达且没有缓存的乱序数据，直接从调用者的字符串拷贝进输出流，
+        // 不经过区间合并或位图（两种引擎在没有待组装字节时都处于空状态）
+        output_.writer().push(std::string_view{data}.substr(beg_idx - first_index, end_idx - beg_idx));
+        first_unassembled_index_ = end_idx;
+    }
+    else if (engine_ == Engine::Bitmap)
+    {
+        insert_bitmap(first_index, data, beg_idx, end_idx);
+    }
+    else
+    {
+        insert_intervals(first_index, data, beg_idx, end_idx);
+    }
+
+    // 如果所有数据都已重组，关闭输出流
+    if (first_unassembled_index_ >= eof_index_)
+    {
+        output_.writer().close();
+    }
+}
 
-    // 如果缓冲区为空，直接插入
-    if (buffers_.empty())
+// 区间树引擎：与相邻区间合并后存入 buffers_，能够直接输出时写入输出流
+void Reassembler::insert_intervals(uint64_t first_index, std::string_view data, uint64_t beg_idx, uint64_t end_idx)
+{
+    // 与新数据重叠或相邻的第一个区间：起始索引不大于 beg_idx 的最后一个区间，或其后的第一个区间
+    auto it = buffers_.upper_bound(beg_idx);
+    PooledString merged;
+    uint64_t merged_beg = beg_idx;
+    if (it != buffers_.begin() && std::prev(it)->first + std::prev(it)->second.size() >= beg_idx)
     {
-        buffers_.push_back(itv);
+        auto prev = std::prev(it);
+        const uint64_t prev_end = prev->first + prev->second.size();
+        if (prev_end >= end_idx)
+        {
+            return; // 新数据已被完全覆盖
+        }
+        // 以前一个区间为基础，接上新数据中超出它的部分
+        merged_beg = prev->first;
+        bytes_charged_ -= footprint(prev->second);
+        merged = std::move(prev->second);
+        merged.append(data.substr(prev_end - first_index, end_idx - prev_end));
+        bytes_pending_ -= prev_end - prev->first;
+        buffers_.erase(prev);
     }
     else
     {
-        // 找到插入位置
-        auto it = std::lower_bound(buffers_.begin(), buffers_.end(), itv);
-        auto prev = it;
+        merged.assign(data.substr(beg_idx - first_index, end_idx - beg_idx));
+    }
 
-        // 如果是第一个位置，直接插入
-        if (it == buffers_.begin())
+    // 吞并后续所有与合并结果重叠或相邻的区间
+    while (it != buffers_.end() && it->first <= merged_beg + merged.size())
+    {
+        const uint64_t merged_end = merged_beg + merged.size();
+        const uint64_t it_end = it->first + it->second.size();
+        if (it_end > merged_end)
         {
-            buffers_.insert(it, itv);
-            prev = buffers_.begin();
+            merged.append(it->second, merged_end - it->first);
         }
-        else
+        bytes_pending_ -= it->second.size();
+        bytes_charged_ -= footprint(it->second);
+        it = buffers_.erase(it);
+    }
+
+    // 合并结果从第一个未组装的字节开始时直接写入输出流，否则存入缓冲区
+    if (merged_beg == first_unassembled_index_)
+    {
+        output_.writer().push(merged);
+        first_unassembled_index_ += merged.size();
+    }
+    else
+    {
+        bytes_pending_ += merged.size();
+        bytes_charged_ += footprint(merged);
+        buffers_.emplace_hint(it, merged_beg, std::move(merged));
+    }
+    evict_pending();
+}
+
+void Reassembler::evict_pending()
+{
+    pending_charge_.set(bytes_charged_);
+    while (!buffers_.empty())
+    {
+        const uint64_t global = global_pending.load();
+        const uint64_t global_limit = global_pending_limit.load();
+        const uint64_t excess = std::max(bytes_charged_ > pending_limit_ ? bytes_charged_ - pending_limit_ : 0,
+                                         global > global_limit ? global - global_limit : 0);
+        if (excess == 0)
         {
-            // 否则检查前一个区间是否可以合并
-            prev = std::prev(it);
-            if (prev->end_idx >= itv.beg_idx)
-            {
-                if (prev->end_idx <= itv.end_idx)
-                {
-                    prev->interval_str = prev->interval_str.substr(0, itv.beg_idx - prev->beg_idx) + itv.interval_str;
-                    prev->end_idx = itv.end_idx;
-                }
-                itv = *prev;
-            }
-            else
-            {
-                buffers_.insert(it, itv);
-                prev++;
-            }
+            break;
         }
 
-        // 合并重叠的区间
-        while (it != buffers_.end() && itv.end_idx >= it->beg_idx)
+        // 最后一个区间离 first_unassembled_index_ 最远，从它的尾部截掉足够多的字节，使它换用的块小到能抵消超出的部分
+        const auto last = std::prev(buffers_.end());
+        const uint64_t held = footprint(last->second);
+        const uint64_t keep = excess >= held ? 0 : std::min<uint64_t>(last->second.size(), max_length_within(held - excess));
+        const uint64_t drop = last->second.size() - keep;
+        bytes_charged_ -= held;
+        if (keep == 0)
+        {
+            buffers_.erase(last);
+        }
+        else
         {
-            if (it->end_idx > itv.end_idx)
-            {
-                prev->interval_str.replace(it->beg_idx - itv.beg_idx, std::string::npos, it->interval_str);
-                prev->end_idx = it->end_idx;
-            }
-            it = buffers_.erase(it);
-            itv = *prev;
+            last->second.resize(keep);
+            last->second.shrink_to_fit(); // 换用更小的内存块，真正归还内存
+            bytes_charged_ += footprint(last->second);
         }
+        bytes_pending_ -= drop;
+        bytes_evicted_ += drop;
+        global_evicted += drop;
+        pending_charge_.set(bytes_charged_);
     }
+}
 
-    // 将可以输出的数据推送到输出流
-    std::erase_if(buffers_, [this](const Interval& interval)
+Reassembler::PendingCharge::PendingCharge(const PendingCharge &other) : bytes_(other.bytes_)
+{
+    global_pending += bytes_;
+}
+
+Reassembler::PendingCharge::PendingCharge(PendingCharge &&other) noexcept : bytes_(std::exchange(other.bytes_, 0)) {}
+
+Reassembler::PendingCharge &Reassembler::PendingCharge::operator=(const PendingCharge &other)
+{
+    set(other.bytes_);
+    return *this;
+}
+
+Reassembler::PendingCharge &Reassembler::PendingCharge::operator=(PendingCharge &&other) noexcept
+{
+    if (this != &other)
+    {
+        global_pending -= bytes_;
+        bytes_ = std::exchange(other.bytes_, 0);
+    }
+    return *this;
+}
+
+Reassembler::PendingCharge::~PendingCharge()
+{
+    global_pending -= bytes_;
+}
+
+void Reassembler::PendingCharge::set(uint64_t bytes)
+{
+    global_pending += bytes - bytes_; // 无符号回绕，减少时同样正确
+    bytes_ = bytes;
+}
+
+void Reassembler::set_global_pending_limit(uint64_t limit)
+{
+    global_pending_limit = limit;
+}
+
+uint64_t Reassembler::global_bytes_charged()
+{
+    return global_pending.load();
+}
+
+uint64_t Reassembler::global_bytes_evicted()
+{
+    return global_evicted.load();
+}
+
+// 位图引擎：拷贝到输出流存储中的对应位置，再提交已连续的前缀
+void Reassembler::insert_bitmap(uint64_t first_index, std::string_view data, uint64_t beg_idx, uint64_t end_idx)
+{
+    // 可写区间至多两段（环的末尾和开头），按偏移逐段拷贝
+    const auto spans = output_.writer().prepare(end_idx - first_unassembled_index_);
+    uint64_t offset = beg_idx - first_unassembled_index_;
+    for (auto rest = data.substr(beg_idx - first_index, end_idx - beg_idx); !rest.empty();)
     {
-        if (interval.beg_idx == first_unassembled_index_)
+        const bool second = offset >= spans[0].size();
+        const std::span<char> span = spans.at(second ? 1 : 0);
+        const uint64_t pos = second ? offset - spans[0].size() : offset;
+        const uint64_t len = std::min<uint64_t>(rest.size(), span.size() - pos);
+        std::memcpy(span.data() + pos, rest.data(), len);
+        rest.remove_prefix(len);
+        offset += len;
+    }
+    bytes_pending_ += mark(beg_idx, end_idx, true);
+
+    // 连续的前缀已经在输出流的存储里，提交即可
+    const uint64_t ready = run_length(first_unassembled_index_, true);
+    if (ready > 0)
+    {
+        mark(first_unassembled_index_, first_unassembled_index_ + ready, false);
+        output_.writer().commit(ready);
+        first_unassembled_index_ += ready;
+        bytes_pending_ -= ready;
+    }
+}
+
+uint64_t Reassembler::mark(uint64_t beg_idx, uint64_t end_idx, bool present)
+{
+    uint64_t changed = 0;
+    uint64_t pos = beg_idx % window_size_;
+    for (uint64_t remaining = end_idx - beg_idx; remaining > 0;)
+    {
+        // 每次处理一个 64 位字内、且不跨越位图末尾的一段
+        const uint64_t bit = pos % 64;
+        const uint64_t len = std::min({remaining, 64 - bit, window_size_ - pos});
+        const uint64_t mask = (len == 64 ? ~uint64_t{0} : (uint64_t{1} << len) - 1) << bit;
+        uint64_t &word = present_[pos / 64];
+        changed += std::popcount(present ? mask & ~word : mask & word);
+        word = present ? word | mask : word & ~mask;
+        remaining -= len;
+        pos += len;
+        pos = pos == window_size_ ? 0 : pos;
+    }
+    return changed;
+}
+
+uint64_t Reassembler::run_length(uint64_t index, bool present) const
+{
+    const uint64_t limit = first_unassembled_index_ + window_size_ - index;
+    uint64_t count = 0;
+    uint64_t pos = index % window_size_;
+    while (count < limit)
+    {
+        const uint64_t bit = pos % 64;
+        const uint64_t len = std::min({64 - bit, window_size_ - pos, limit - count});
+        const uint64_t word = present ? present_[pos / 64] : ~present_[pos / 64];
+        const auto ones = std::min<uint64_t>(std::countr_one(word >> bit), len);
+        count += ones;
+        if (ones < len)
         {
-            output_.writer().push(interval.interval_str);
-            first_unassembled_index_ = interval.end_idx;
-            return true;
+            break;
         }
-        return false;
-    });
+        pos += len;
+        pos = pos == window_size_ ? 0 : pos;
+    }
+    return count;
+}
 
-    // 如果所有数据都已重组，关闭输出流
-    if (first_unassembled_index_ >= eof_index_)
+void Reassembler::set_capacity(uint64_t capacity)
+{
+    const auto intervals = pending_intervals();
+    const uint64_t extent = intervals.empty() ? 0 : intervals.back().second - first_unassembled_index_;
+    output_.writer().set_capacity(std::max(capacity, output_.reader().bytes_buffered() + extent));
+    if (engine_ != Engine::Bitmap)
     {
-        output_.writer().close();
+        return;
+    }
+
+    // 输出流搬迁时保留了写位置之后的内容，乱序字节相对写位置的偏移不变，只需按新的模重新标记位图
+    window_size_ = output_.writer().capacity();
+    present_.assign((window_size_ + 63) / 64, 0);
+    for (const auto &[first, last] : intervals)
+    {
+        mark(first, last, true);
     }
 }
 
 // 返回当前缓冲区中待重组的字节数
 uint64_t Reassembler::bytes_pending() const
 {
-    return std::accumulate(buffers_.begin(), buffers_.end(), uint64_t{0}, [](uint64_t sum, const Interval& interval)
+    return bytes_pending_;
+}
+
+std::vector<std::pair<uint64_t, uint64_t>> Reassembler::pending_intervals() const
+{
+    std::vector<std::pair<uint64_t, uint64_t>> intervals;
+    if (engine_ == Engine::IntervalMap)
     {
-        return sum + (interval.end_idx - interval.beg_idx);
-    });
+        for (const auto &[first, data] : buffers_)
+        {
+            intervals.emplace_back(first, first + data.size());
+        }
+        return intervals;
+    }
+
+    // 位图引擎：交替跳过未到达和已到达的位，直到找齐所有缓存的字节
+    uint64_t index = first_unassembled_index_;
+    for (uint64_t found = 0; found < bytes_pending_;)
+    {
+        index += run_length(index, false);
+        const uint64_t len = run_length(index, true);
+        intervals.emplace_back(index, index + len);
+        found += len;
+        index += len;
+    }
+    return intervals;
 }
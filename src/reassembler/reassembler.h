@@ -2,18 +2,27 @@
 #define REASSEMBLER_H
 
 #include <iostream>
-#include <list>
-#include <unordered_map>
+#include <map>
+#include <vector>
 #include <algorithm>
-#include <numeric>
+#include <string_view>
+#include <utility>
 #include "byte_stream.h"
+#include "buffer_pool.h"
 
 // Reassembler 类用于将分段的字节流重新组装成完整的字节流。
 class Reassembler
 {
 public:
-    // 构造函数，接受一个 ByteStream 对象用于输出。
-    explicit Reassembler(ByteStream &&output) : output_(std::move(output)) {}
+    // 乱序数据的存储方式
+    enum class Engine
+    {
+        IntervalMap, // 有序区间树，只为已到达的字节分配内存
+        Bitmap       // 直接写入输出流存储中的对应位置，用位图记录哪些字节已到达，内存固定为窗口大小
+    };
+
+    // 构造函数，接受一个 ByteStream 对象用于输出、乱序数据的存储方式，以及本重组器的乱序数据最多占用的池内存。
+    explicit Reassembler(ByteStream &&output, Engine engine = Engine::IntervalMap, uint64_t pending_limit = UINT64_MAX);
 
     /*
      * 插入一个新的子字符串以重新组装成 ByteStream。
@@ -37,6 +46,30 @@ public:
     // 返回存储在 Reassembler 中的字节数。
     uint64_t bytes_pending() const;
 
+    // 已缓存的乱序字节区间 [first, last)（流索引），按起始索引升序、互不相邻；TCPReceiver 据此生成 SACK 块。
+    std::vector<std::pair<uint64_t, uint64_t>> pending_intervals() const;
+
+    /*
+     * 乱序数据的内存上限。
+     * 上限按区间实际占用的 BufferPool 内存计：每个区间计入它所在块的大小，而不是其中的字节数。
+     * IntervalMap 引擎占用的内存超过本重组器的上限，或者全进程所有重组器占用的总量超过进程上限时，
+     * 从距离 first_unassembled_index 最远的字节开始丢弃，直到两个上限都满足（或本重组器已无可丢弃的数据）。
+     * 被丢弃的字节可能已经被 SACK 确认过，之后由对端在超时后重传。
+     * Bitmap 引擎的乱序数据位于输出流自身的存储中，不额外占用内存，不受上限约束。
+     */
+    uint64_t bytes_charged() const { return bytes_charged_; } // 本重组器的乱序区间占用的池内存
+    uint64_t bytes_evicted() const { return bytes_evicted_; } // 本重组器因超出上限而丢弃的字节数
+    static void set_global_pending_limit(uint64_t limit);    // 设置进程上限（字节，按占用的池内存计），默认不限制
+    static uint64_t global_bytes_charged();                  // 全进程乱序区间占用的池内存
+    static uint64_t global_bytes_evicted();                  // 全进程因超出上限而丢弃的字节数
+
+    /*
+     * 调整输出流的容量（即重组窗口的大小），用于接收缓冲区的自动调整。
+     * 新容量不会小于已缓冲的字节数加上最远的乱序字节到 first_unassembled_index_ 的距离，
+     * 已缓存的乱序数据因此都仍在窗口内。Bitmap 引擎按新的窗口大小重建到达位图。
+     */
+    void set_capacity(uint64_t capacity);
+
     // 访问输出流的读取器
     Reader &reader() { return output_.reader(); }
     const Reader &reader() const { return output_.reader(); }
@@ -46,20 +79,54 @@ public:
 
 private:
     ByteStream output_; // Reassembler 写入这个 ByteStream
-    struct Interval
-    {
-        uint64_t beg_idx;         // 区间的起始索引
-        uint64_t end_idx;         // 区间的结束索引
-        std::string interval_str; // 区间内的字符串
-        // 定义区间的比较运算符，用于排序
-        bool operator<(const Interval &other) const
-        {
-            return beg_idx != other.beg_idx ? beg_idx < other.beg_idx : end_idx < other.end_idx;
-        };
-    };
-    std::list<Interval> buffers_{};       // 用于存储未组装的字节区间
+
+    // 未组装的字节区间，按起始索引有序，互不重叠也互不相邻（相邻的区间在插入时合并）。
+    // 区间 [key, key + value.size()) 的内容为 value，内存来自 BufferPool。
+    // 有序树使定位和合并为 O(log n)，与区间（空洞）的数量几乎无关。
+    std::map<uint64_t, PooledString> buffers_{};
+    uint64_t bytes_pending_{0};           // 已缓存但尚未组装的字节数，随插入和合并增量维护
+    uint64_t bytes_charged_{0};           // 各区间占用的池内存之和，与上限比较
     uint64_t first_unassembled_index_{0}; // 第一个未组装的字节的索引
     uint64_t eof_index_{UINT64_MAX};      // 流结束的索引，初始为最大值
+
+    // 计入进程总量的池内存：复制时重复计入，移动时转移，析构时归还
+    class PendingCharge
+    {
+    public:
+        PendingCharge() = default;
+        PendingCharge(const PendingCharge &other);
+        PendingCharge(PendingCharge &&other) noexcept;
+        PendingCharge &operator=(const PendingCharge &other);
+        PendingCharge &operator=(PendingCharge &&other) noexcept;
+        ~PendingCharge();
+
+        void set(uint64_t bytes); // 把计入的数量更新为 bytes
+
+    private:
+        uint64_t bytes_{0};
+    };
+
+    uint64_t pending_limit_;     // 本重组器的乱序数据内存上限
+    uint64_t bytes_evicted_{0};  // 因超出上限而丢弃的字节数
+    PendingCharge pending_charge_{};
+
+    // Bitmap 引擎：乱序字节直接拷贝进输出流 Writer::prepare() 返回的空闲区间，
+    // 位图按 "流索引 mod 窗口大小" 记录每个字节是否已到达；连续前缀就绪后用 commit() 交给输出流，无需再拷贝。
+    Engine engine_;
+    uint64_t window_size_{0};         // 输出流的容量，即位图的位数
+    std::vector<uint64_t> present_{}; // 到达位图
+
+    // 两种引擎各自处理已裁剪到窗口内的 [beg_idx, end_idx)
+    void insert_intervals(uint64_t first_index, std::string_view data, uint64_t beg_idx, uint64_t end_idx);
+    void insert_bitmap(uint64_t first_index, std::string_view data, uint64_t beg_idx, uint64_t end_idx);
+
+    // 超出本重组器或进程的上限时，从最远的区间尾部开始丢弃乱序字节
+    void evict_pending();
+
+    // 把 [beg_idx, end_idx) 对应的位置为 present，返回实际改变的位数
+    uint64_t mark(uint64_t beg_idx, uint64_t end_idx, bool present);
+    // 从流索引 index 开始连续为 present 的位数，不超过窗口末尾，逐个 64 位字扫描
+    uint64_t run_length(uint64_t index, bool present) const;
 };
 
 #endif
@@ -26,8 +26,10 @@ void TCPReceiver::receive(TCPSenderMessage message)
             std::cerr << "message syn is invalid.\n";
             return;
         }
-        // 设置初始序列号为接收到的消息的序列号。
+        // 设置初始序列号为接收到的消息的序列号，并记录对方是否支持 SACK 和窗口扩大。
         isn_ = message.seqno;
+        sack_permitted_ = message.sack_permitted;
+        window_shift_ = window_scale_.has_value() && message.window_scale.has_value() ? *window_scale_ : 0;
     }
 
     // 计算当前的检查点（ckpt），即已经推送的字节数加 1。
@@ -38,30 +40,143 @@ void TCPReceiver::receive(TCPSenderMessage message)
 
     // 计算流的索引，如果消息包含 SYN 标志，则索引为 0，否则为绝对序列号减 1。
     uint64_t stream_idx = message.SYN ? 0 : absseq - 1;
+    last_segment_idx_ = stream_idx;
+    if (message.FIN)
+    {
+        fin_idx_ = stream_idx + message.payload.size();
+    }
 
     // 将消息的有效载荷插入到流重组器中。
     reassembler_.insert(stream_idx, std::move(message.payload), message.FIN);
 }
 
+bool TCPReceiver::predicted(const TCPSenderMessage &message) const
+{
+    // 流未关闭时确认号就是下一个期望的字节的序列号
+    return isn_.has_value() && !message.SYN && !message.FIN && !message.RST && !writer().is_closed() && !writer().has_error()
+           && reassembler_.bytes_pending() == 0 && message.payload.size() <= writer().available_capacity()
+           && message.seqno == Wrap32::wrap(writer().bytes_pushed() + 1, isn_.value());
+}
+
+void TCPReceiver::receive_predicted(TCPSenderMessage message)
+{
+    // 流索引就是已写入的字节数，不必展开序列号
+    last_segment_idx_ = writer().bytes_pushed();
+    if (!message.payload.empty())
+    {
+        reassembler_.insert(last_segment_idx_, std::move(message.payload), false);
+    }
+}
+
+std::optional<Wrap32> TCPReceiver::ackno() const
+{
+    if (!isn_.has_value())
+    {
+        return std::nullopt;
+    }
+    return Wrap32::wrap(writer().bytes_pushed() + 1 + writer().is_closed(), isn_.value());
+}
+
 // 生成并返回一个 TCPReceiverMessage，表示接收方的状态。
 TCPReceiverMessage TCPReceiver::send() const
 {
     TCPReceiverMessage res;
 
-    // 如果初始序列号（ISN）已设置，则计算应答序列号（ackno）。
-    if (isn_.has_value())
-    {
-        // 计算绝对序列号，考虑到已经推送的字节数和流是否关闭。
-        uint64_t absseq = writer().bytes_pushed() + 1 + writer().is_closed();
-        // 将绝对序列号封装为相对序列号。
-        res.ackno = Wrap32::wrap(absseq, isn_.value());
-    }
+    // 如果初始序列号（ISN）已设置，则计算应答序列号（ackno），考虑到已经推送的字节数和流是否关闭。
+    res.ackno = ackno();
 
-    // 设置窗口大小为 writer 的可用容量和 UINT16_MAX 的较小值。
-    res.window_size = static_cast<uint16_t>(std::min(writer().available_capacity(), static_cast<uint64_t>(UINT16_MAX)));
+    // 设置窗口大小，向下取整到移位后能在线路上表示的值，但不让窗口收缩。
+    res.window_size = window_size();
 
     // 设置 RST 标志为 writer 的错误状态。
     res.RST = writer().has_error();
 
+    // 对方支持 SACK 且有乱序数据时报告已收到的区间：最近收到的报文段所在的区间在前，其余按序列号升序。
+    if (sack_permitted_ && reassembler_.bytes_pending() > 0)
+    {
+        auto intervals = reassembler_.pending_intervals();
+        const auto recent = std::find_if(intervals.begin(), intervals.end(), [&](const auto &interval)
+                                         { return interval.first <= last_segment_idx_ && last_segment_idx_ < interval.second; });
+        if (recent != intervals.end())
+        {
+            std::rotate(intervals.begin(), recent, recent + 1);
+        }
+        intervals.resize(std::min(intervals.size(), TCPReceiverMessage::MAX_SACK_BLOCKS));
+        for (const auto &[first, last] : intervals)
+        {
+            // 流索引加 1 得到绝对序列号（SYN 占用一个序列号），以流的结尾结束的区间还包括 FIN
+            const uint64_t end = last + 1 + (fin_idx_ == last);
+            res.sack_blocks.push_back({Wrap32::wrap(first + 1, isn_.value()), Wrap32::wrap(end, isn_.value())});
+        }
+    }
+
     return res;
 }
+
+// writer 的可用容量和线路上能表示的最大窗口的较小值，
+// 并去掉移位后会被截断的低位，保证对方看到的窗口与这里一致。
+uint64_t TCPReceiver::floored_window() const
+{
+    const uint64_t max_window = static_cast<uint64_t>(UINT16_MAX) << window_shift_;
+    return std::min(writer().available_capacity(), max_window) >> window_shift_ << window_shift_;
+}
+
+uint32_t TCPReceiver::window_size() const
+{
+    const uint64_t left_edge = writer().bytes_pushed();
+    const uint64_t window = floored_window();
+    if (left_edge + window >= advertised_right_edge_)
+    {
+        return static_cast<uint32_t>(window);
+    }
+
+    // 向下取整使右边缘比记录的更靠左（窗口收缩），改为把到记录的右边缘的距离向上取整。
+    // 记录的右边缘不超过缓冲区的末尾，多通告的不到一个单位的字节超出缓冲区时由 Reassembler 丢弃，之后由对方重传；
+    // 左边缘到达记录的右边缘后窗口为 0
+    const uint64_t unit = uint64_t{1} << window_shift_;
+    const uint64_t ceiled = std::min<uint64_t>(UINT16_MAX, (advertised_right_edge_ - left_edge + unit - 1) >> window_shift_);
+    return static_cast<uint32_t>(ceiled << window_shift_);
+}
+
+void TCPReceiver::sent()
+{
+    // 只记录向下取整的右边缘，向上取整多出的部分不累积到之后的窗口中
+    advertised_right_edge_ = std::max(advertised_right_edge_, writer().bytes_pushed() + floored_window());
+}
+
+size_t TCPReceiver::sack_option_length() const
+{
+    if (!sack_permitted_ || !isn_.has_value() || reassembler_.bytes_pending() == 0)
+    {
+        return 0;
+    }
+    return 4 + 8 * std::min(reassembler_.pending_intervals().size(), TCPReceiverMessage::MAX_SACK_BLOCKS);
+}
+
+// 每个 RTT 测量一次应用读取的字节数，据此扩大接收缓冲区。
+void TCPReceiver::autotune(uint64_t now_ms, std::optional<uint64_t> rtt_ms)
+{
+    if (!isn_.has_value() || !rtt_ms.has_value() || writer().capacity() >= max_capacity_ || writer().is_closed())
+    {
+        return;
+    }
+    if (!space_time_.has_value())
+    {
+        space_time_ = now_ms;
+        space_popped_ = reader().bytes_popped();
+        return;
+    }
+    if (now_ms - *space_time_ < std::max<uint64_t>(*rtt_ms, 1))
+    {
+        return;
+    }
+
+    // 应用一个 RTT 内读走的字节数就是需要的窗口；留出一倍余量，发送端才能在下一个 RTT 里继续增长
+    const uint64_t copied = reader().bytes_popped() - space_popped_;
+    if (2 * copied > writer().capacity())
+    {
+        reassembler_.set_capacity(std::min(2 * copied, max_capacity_));
+    }
+    space_time_ = now_ms;
+    space_popped_ = reader().bytes_popped();
+}
@@ -2,6 +2,8 @@
 #define TCP_RECEIVER_H
 
 #include <algorithm>
+#include <cstdint>
+#include <optional>
 #include "reassembler.h"
 #include "tcp_receiver_message.h"
 #include "tcp_sender_message.h"
@@ -19,8 +21,13 @@ public:
     /**
      * @brief 使用给定的 Reassembler 构造 TCPReceiver。
      * @param reassembler 用于重组数据流的 Reassembler 对象。
+     * @param window_scale 本端 SYN 中声明的窗口扩大移位数（RFC 7323），为空表示不声明。
+     * @param max_capacity 自动调整接收缓冲区时容量的上限，不大于初始容量时不调整。
      */
-    explicit TCPReceiver(Reassembler &&reassembler) : reassembler_(std::move(reassembler)) {}
+    explicit TCPReceiver(Reassembler &&reassembler, std::optional<uint8_t> window_scale = {}, uint64_t max_capacity = 0)
+        : reassembler_(std::move(reassembler)), window_scale_(window_scale), max_capacity_(max_capacity)
+    {
+    }
 
     /**
      * @brief 接收来自 TCPSender 的消息，并将其有效载荷插入到 Reassembler 中。
@@ -30,14 +37,75 @@ public:
      */
     void receive(TCPSenderMessage message);
 
+    /**
+     * @brief 首部预测：message 是否恰好是下一个期望的、不带 SYN/FIN/RST 的报文段。
+     * @param message 来自 TCPSender 的消息。
+     * @return 连接已建立、没有缓存的乱序数据，message 是纯确认或整个有效载荷都能放进窗口的按序数据时为 true。
+     *
+     * 这样的报文段可以交给 receive_predicted()，跳过序列号展开和重组器中的一般处理。
+     */
+    bool predicted(const TCPSenderMessage &message) const;
+
+    /**
+     * @brief 接收 predicted() 为 true 的报文段，有效载荷直接追加到输出流。
+     * @param message 来自 TCPSender 的消息。
+     */
+    void receive_predicted(TCPSenderMessage message);
+
+    /**
+     * @brief 当前的确认号，与 send().ackno 相同，但不生成整个消息。
+     * @return 收到 SYN 之前为空。
+     */
+    std::optional<Wrap32> ackno() const;
+
     /**
      * @brief 发送 TCPReceiverMessage 给对等方的 TCPSender。
      * @return 构造的 TCPReceiverMessage。
      *
      * 该方法用于生成并返回一个 TCPReceiverMessage，供对等方的 TCPSender 使用。
+     * 对方支持 SACK 时，用 Reassembler 中缓存的乱序区间填写 SACK 块（RFC 2018）。
+     * 不改变接收器的状态；生成的消息发出后调用 sent()。
      */
     TCPReceiverMessage send() const;
 
+    /**
+     * @brief send() 生成的消息发出后调用，记录通告的窗口右边缘。
+     *
+     * 记录的是向下取整的右边缘，向上取整多通告的部分不记录，之后的窗口不会在它的基础上继续前移。
+     */
+    void sent();
+
+    /**
+     * @brief send() 将要通告的窗口大小，不生成整个消息。
+     * @return 窗口大小。
+     *
+     * 双方都声明了窗口扩大选项时，窗口可以超过 65535，并向下取整到移位后能在线路上表示的值；
+     * 向下取整会使窗口右边缘比 sent() 记录的更靠左时，改为把到记录的右边缘的距离向上取整，窗口不收缩（RFC 7323 2.4）。
+     */
+    uint32_t window_size() const;
+
+    /**
+     * @brief send() 将要通告的窗口右边缘（流索引），即已写入的字节数加上 window_size()。
+     * @return 窗口右边缘。
+     */
+    uint64_t window_right_edge() const { return writer().bytes_pushed() + window_size(); }
+
+    /**
+     * @brief send() 生成的消息中 SACK 选项占用的字节数，不生成整个消息。
+     * @return 字节数，不带 SACK 块时为 0。
+     */
+    size_t sack_option_length() const;
+
+    /**
+     * @brief 按应用读取数据的速度自动调整接收缓冲区（类似 Linux 的 tcp_rcv_space_adjust）。
+     * @param now_ms 当前时间，单位为毫秒。
+     * @param rtt_ms 连接的 RTT 估计，尚无估计时不调整。
+     *
+     * 每经过一个 RTT，统计这段时间内应用读走的字节数；缓冲区不足它的两倍时扩大到两倍，
+     * 不超过 max_capacity，使窗口能跟上带宽时延积。只扩大不缩小，已通告的窗口右沿不会后退。
+     */
+    void autotune(uint64_t now_ms, std::optional<uint64_t> rtt_ms);
+
     /**
      * @brief 获取 Reassembler 的常量引用。
      * @return Reassembler 的常量引用。
@@ -67,8 +135,22 @@ public:
     const Writer &writer() const { return reassembler_.writer(); }
 
 private:
-    Reassembler reassembler_;     ///< 用于重组数据流的 Reassembler 实例。
-    std::optional<Wrap32> isn_{}; ///< 初始序列号（ISN），用于 TCP 序列号的处理。
+    /**
+     * @brief 向下取整到移位后能在线路上表示的窗口，不考虑右边缘是否收缩。
+     */
+    uint64_t floored_window() const;
+
+    Reassembler reassembler_;                  ///< 用于重组数据流的 Reassembler 实例。
+    std::optional<Wrap32> isn_{};              ///< 初始序列号（ISN），用于 TCP 序列号的处理。
+    bool sack_permitted_{};                    ///< 对方在 SYN 中声明支持 SACK，send() 才附带 SACK 块。
+    uint64_t last_segment_idx_{};              ///< 最近收到的报文段的流索引，它所在的区间作为第一个 SACK 块。
+    std::optional<uint64_t> fin_idx_{};        ///< 收到 FIN 时流的结束索引，到达这里的 SACK 块也覆盖 FIN 的序列号。
+    std::optional<uint8_t> window_scale_{};    ///< 本端在 SYN 中声明的窗口扩大移位数。
+    uint8_t window_shift_{};                   ///< 生效的移位数：双方都声明时为本端的值，否则为 0。
+    uint64_t advertised_right_edge_{};         ///< sent() 记录的最靠右的向下取整的窗口右边缘（流索引），窗口不让它左移。
+    uint64_t max_capacity_;                    ///< 自动调整的容量上限。
+    std::optional<uint64_t> space_time_{};     ///< 本轮测量的开始时间，尚未开始时为空。
+    uint64_t space_popped_{};                  ///< 本轮测量开始时应用已读走的字节数。
 };
 
 #endif
@@ -0,0 +1,148 @@
+#include <algorithm>
+#include <cmath>
+#include "congestion_control.h"
+
+namespace
+{
+    // RFC 5681 3.1 的初始窗口
+    uint64_t initial_window(uint64_t mss)
+    {
+        return std::min(4 * mss, std::max<uint64_t>(2 * mss, 4380));
+    }
+
+    // 不做拥塞控制：窗口无限大
+    class Unlimited : public CongestionControl
+    {
+    public:
+        void on_ack(uint64_t, uint64_t, uint64_t) override {}
+        void on_loss(uint64_t, uint64_t) override {}
+        void on_rto(uint64_t, uint64_t) override {}
+        uint64_t cwnd() const override { return UINT64_MAX; }
+        uint64_t ssthresh() const override { return UINT64_MAX; }
+    };
+}
+
+std::unique_ptr<CongestionControl> CongestionControl::make(Algorithm algorithm, uint64_t mss)
+{
+    switch (algorithm)
+    {
+    case Algorithm::NewReno:
+        return std::make_unique<NewReno>(mss);
+    case Algorithm::Cubic:
+        return std::make_unique<Cubic>(mss);
+    case Algorithm::None:
+        break;
+    }
+    return std::make_unique<Unlimited>();
+}
+
+void CongestionControl::on_send(uint64_t, uint64_t) {}
+
+void CongestionControl::set_mss(uint64_t) {}
+
+void CongestionControl::set_initial_mss(uint64_t) {}
+
+NewReno::NewReno(uint64_t mss) : mss_(mss), cwnd_(initial_window(mss)) {}
+
+void NewReno::set_initial_mss(uint64_t mss)
+{
+    mss_ = mss;
+    cwnd_ = initial_window(mss);
+}
+
+void NewReno::on_ack(uint64_t acked, uint64_t, uint64_t)
+{
+    if (cwnd_ < ssthresh_)
+    {
+        // 慢启动：每个确认至多增加一个 MSS
+        cwnd_ += std::min(acked, mss_);
+        return;
+    }
+    // 拥塞避免：每确认一个窗口的数据增加一个 MSS
+    bytes_acked_ += acked;
+    if (bytes_acked_ >= cwnd_)
+    {
+        bytes_acked_ -= cwnd_;
+        cwnd_ += mss_;
+    }
+}
+
+void NewReno::on_loss(uint64_t bytes_in_flight, uint64_t)
+{
+    ssthresh_ = std::max(bytes_in_flight / 2, 2 * mss_);
+    cwnd_ = ssthresh_;
+    bytes_acked_ = 0;
+}
+
+void NewReno::on_rto(uint64_t bytes_in_flight, uint64_t)
+{
+    ssthresh_ = std::max(bytes_in_flight / 2, 2 * mss_);
+    cwnd_ = mss_; // 超时后从一个报文段重新慢启动
+    bytes_acked_ = 0;
+}
+
+Cubic::Cubic(uint64_t mss) : mss_(mss), cwnd_(static_cast<double>(initial_window(mss))) {}
+
+void Cubic::set_initial_mss(uint64_t mss)
+{
+    mss_ = mss;
+    cwnd_ = static_cast<double>(initial_window(mss));
+}
+
+void Cubic::on_ack(uint64_t acked, uint64_t, uint64_t now_ms)
+{
+    const double mss = static_cast<double>(mss_);
+    if (cwnd_ < static_cast<double>(ssthresh_))
+    {
+        cwnd_ += static_cast<double>(std::min(acked, mss_));
+        return;
+    }
+
+    const double segments = cwnd_ / mss;
+    if (!epoch_start_ms_.has_value())
+    {
+        // 新一轮拥塞避免：三次函数从当前窗口出发，在 k_ 秒后回到 w_max_
+        epoch_start_ms_ = now_ms;
+        k_ = segments < w_max_ ? std::cbrt((w_max_ - segments) / C) : 0.0;
+        origin_ = std::max(w_max_, segments);
+        w_est_ = segments;
+    }
+
+    const double t = static_cast<double>(now_ms - *epoch_start_ms_) / 1000.0;
+    const double target = std::clamp(origin_ + C * std::pow(t - k_, 3), segments, 1.5 * segments);
+
+    // Reno 友好区域：按 Reno 的平均速率估计窗口，CUBIC 不应比它慢
+    constexpr double ALPHA = 3 * (1 - BETA) / (1 + BETA);
+    const double acked_segments = static_cast<double>(acked) / mss;
+    w_est_ += ALPHA * acked_segments / segments;
+
+    if (w_est_ > target)
+    {
+        cwnd_ = w_est_ * mss;
+    }
+    else
+    {
+        cwnd_ += (target - segments) / segments * acked_segments * mss;
+    }
+}
+
+void Cubic::reduce()
+{
+    const double segments = cwnd_ / static_cast<double>(mss_);
+    // 快速收敛：窗口在上次拥塞之前就开始减小，说明有新的流加入，主动让出更多带宽
+    w_max_ = segments < w_max_ ? segments * (1 + BETA) / 2 : segments;
+    ssthresh_ = std::max(static_cast<uint64_t>(cwnd_ * BETA), 2 * mss_);
+    epoch_start_ms_.reset();
+}
+
+void Cubic::on_loss(uint64_t, uint64_t)
+{
+    reduce();
+    cwnd_ = static_cast<double>(ssthresh_);
+}
+
+void Cubic::on_rto(uint64_t, uint64_t)
+{
+    reduce();
+    cwnd_ = static_cast<double>(mss_);
+}
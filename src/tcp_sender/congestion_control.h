@@ -0,0 +1,99 @@
+#ifndef CONGESTION_CONTROL_H
+#define CONGESTION_CONTROL_H
+
+#include <cstdint>
+#include <memory>
+#include <optional>
+
+// 拥塞控制算法的接口。TCPSender 在发送、确认、丢包和超时时通知它，
+// 并以 min(接收窗口, cwnd()) 作为允许在途的序列号数量。所有窗口均以字节为单位，时间以毫秒为单位。
+class CongestionControl
+{
+public:
+    // 可选的算法
+    enum class Algorithm
+    {
+        None,    // 不做拥塞控制，只受接收窗口限制
+        NewReno, // RFC 5681 / RFC 6582：慢启动、拥塞避免（按确认字节数增长）、丢包时减半
+        Cubic    // RFC 9438：拥塞避免阶段按距上次拥塞的时间以三次函数增长
+    };
+
+    // 创建指定算法的实例，mss 为最大报文段长度
+    static std::unique_ptr<CongestionControl> make(Algorithm algorithm, uint64_t mss);
+
+    virtual ~CongestionControl() = default;
+
+    // 发送了 bytes 个序列号（包括重传）
+    virtual void on_send(uint64_t bytes, uint64_t now_ms);
+    // 最大报文段长度改变（MSS 协商或路径 MTU 探测之后），已有的窗口保持不变
+    virtual void set_mss(uint64_t mss);
+    // 还没有发出数据时报文段长度确定：按它重新计算初始窗口
+    virtual void set_initial_mss(uint64_t mss);
+    // 新确认了 acked 字节的数据，bytes_in_flight 为确认之后仍在途的序列号数量
+    virtual void on_ack(uint64_t acked, uint64_t bytes_in_flight, uint64_t now_ms) = 0;
+    // 通过重复确认等方式发现了丢包（不含超时）
+    virtual void on_loss(uint64_t bytes_in_flight, uint64_t now_ms) = 0;
+    // 重传超时
+    virtual void on_rto(uint64_t bytes_in_flight, uint64_t now_ms) = 0;
+
+    // 拥塞窗口
+    virtual uint64_t cwnd() const = 0;
+    // 慢启动阈值
+    virtual uint64_t ssthresh() const = 0;
+};
+
+// RFC 5681 / RFC 6582 NewReno
+class NewReno : public CongestionControl
+{
+public:
+    explicit NewReno(uint64_t mss);
+
+    void set_mss(uint64_t mss) override { mss_ = mss; }
+    void set_initial_mss(uint64_t mss) override;
+    void on_ack(uint64_t acked, uint64_t bytes_in_flight, uint64_t now_ms) override;
+    void on_loss(uint64_t bytes_in_flight, uint64_t now_ms) override;
+    void on_rto(uint64_t bytes_in_flight, uint64_t now_ms) override;
+
+    uint64_t cwnd() const override { return cwnd_; }
+    uint64_t ssthresh() const override { return ssthresh_; }
+
+private:
+    uint64_t mss_;
+    uint64_t cwnd_;
+    uint64_t ssthresh_{UINT64_MAX};
+    uint64_t bytes_acked_{}; // 拥塞避免阶段累计确认的字节数（RFC 3465 按字节计数）
+};
+
+// RFC 9438 CUBIC
+class Cubic : public CongestionControl
+{
+public:
+    explicit Cubic(uint64_t mss);
+
+    void set_mss(uint64_t mss) override { mss_ = mss; }
+    void set_initial_mss(uint64_t mss) override;
+    void on_ack(uint64_t acked, uint64_t bytes_in_flight, uint64_t now_ms) override;
+    void on_loss(uint64_t bytes_in_flight, uint64_t now_ms) override;
+    void on_rto(uint64_t bytes_in_flight, uint64_t now_ms) override;
+
+    uint64_t cwnd() const override { return static_cast<uint64_t>(cwnd_); }
+    uint64_t ssthresh() const override { return ssthresh_; }
+
+private:
+    static constexpr double C = 0.4;    // 三次函数的缩放系数
+    static constexpr double BETA = 0.7; // 乘性减小因子
+
+    uint64_t mss_;
+    double cwnd_; // 拥塞避免阶段每次确认的增量可能不足一个字节，用浮点数累积
+    uint64_t ssthresh_{UINT64_MAX};
+    double w_max_{};                          // 上次拥塞时的窗口（报文段数）
+    double w_est_{};                          // 按 Reno 速率估计的窗口（报文段数），保证不慢于 Reno
+    double k_{};                              // 三次函数回到 w_max_ 所需的时间（秒）
+    double origin_{};                         // 三次函数的平台（报文段数）
+    std::optional<uint64_t> epoch_start_ms_{}; // 本轮拥塞避免开始的时间
+
+    // 记录一次拥塞，更新 w_max_ 与 ssthresh_
+    void reduce();
+};
+
+#endif
@@ -3,10 +3,145 @@
 #include <utility>
 #include <string_view>
 #include <algorithm>
+#include <cmath>
 #include "tcp_sender.h"
 #include "tcp_config.h"
 #include "wrapping_integers.h"
 
+void RetransmissionTimer::sample_rtt(uint64_t rtt_ms)
+{
+    const auto r = static_cast<double>(rtt_ms);
+    if (srtt_ < 0)
+    {
+        // RFC 6298 2.2：第一个样本
+        srtt_ = r;
+        rttvar_ = r / 2;
+    }
+    else
+    {
+        // RFC 6298 2.3：alpha = 1/8，beta = 1/4，先用旧的 SRTT 更新 RTTVAR
+        rttvar_ = 0.75 * rttvar_ + 0.25 * std::abs(srtt_ - r);
+        srtt_ = 0.875 * srtt_ + 0.125 * r;
+    }
+    if (policy_.adaptive)
+    {
+        // RTO = SRTT + max(G, 4 * RTTVAR)，时钟粒度 G 为 1 毫秒，再限制在 [min, max] 内
+        const double rto = srtt_ + std::max(1.0, 4 * rttvar_);
+        base_rto_ms_ = std::clamp(static_cast<uint64_t>(std::ceil(rto)), policy_.min_ms, policy_.max_ms);
+    }
+}
+
+std::optional<uint64_t> RetransmissionTimer::srtt_ms() const
+{
+    if (srtt_ < 0)
+    {
+        return std::nullopt;
+    }
+    return static_cast<uint64_t>(std::lround(srtt_));
+}
+
+void RackState::on_delivered(uint64_t xmit_ms, uint64_t end_absseq, uint64_t now_ms, bool retransmitted)
+{
+    // 重传过的报文段比最小 RTT 还快被确认，多半确认的是原来那次发送，不能说明重传何时送达
+    const uint64_t rtt = now_ms - xmit_ms;
+    if (retransmitted && rtt < min_rtt_)
+    {
+        return;
+    }
+    min_rtt_ = std::min(min_rtt_, rtt);
+    if (!delivered_ || xmit_ms > xmit_ms_ || (xmit_ms == xmit_ms_ && end_absseq > end_absseq_))
+    {
+        delivered_ = true;
+        xmit_ms_ = xmit_ms;
+        end_absseq_ = end_absseq;
+        rtt_ = rtt;
+    }
+}
+
+TCPSender::Options TCPSender::Options::from_config(const TCPConfig &cfg)
+{
+    return {.congestion_control = cfg.congestion_control,
+            .rto_policy = {.adaptive = cfg.adaptive_rto, .min_ms = cfg.rto_min, .max_ms = cfg.rto_max},
+            .syn_options = {.sack_permitted = cfg.sack, .window_scale = cfg.window_scale(), .mss = cfg.mss},
+            .pacing = {.enabled = cfg.pacing, .rate_bytes_per_ms = cfg.pacing_rate},
+            .mtu_probing = cfg.mtu_probing,
+            .rack_tlp = cfg.rack};
+}
+
+TCPSender::TCPSender(ByteStream &&input, Wrap32 isn, uint64_t initial_RTO_ms, const Options &options, WheelRef timers)
+    : input_(std::move(input)),
+      isn_(isn),
+      timer_(initial_RTO_ms, options.rto_policy),
+      timers_(std::move(timers)),
+      cc_(CongestionControl::make(options.congestion_control, TCPConfig::MAX_PAYLOAD_SIZE)),
+      pacer_(options.pacing, TCPConfig::MAX_PAYLOAD_SIZE),
+      syn_options_(options.syn_options),
+      max_mss_(options.syn_options.mss.value_or(TCPConfig::MAX_PAYLOAD_SIZE)),
+      prober_(options.mtu_probing, TCPConfig::MAX_PAYLOAD_SIZE),
+      rack_tlp_(options.rack_tlp)
+{
+    prober_.set_limit(max_mss_);
+    set_mss(prober_.is_enabled() ? prober_.mss() : max_mss_);
+    cc_->set_initial_mss(mss_);
+    pacer_.set_initial_mss(mss_);
+}
+
+void TCPSender::set_peer_mss(std::optional<uint16_t> mss)
+{
+    max_mss_ = std::min<uint64_t>(syn_options_.mss.value_or(TCPConfig::MAX_PAYLOAD_SIZE), mss.value_or(DEFAULT_PEER_MSS));
+    prober_.set_limit(max_mss_);
+    set_mss(prober_.is_enabled() ? prober_.mss() : max_mss_);
+
+    // 初始窗口以报文段为单位（RFC 5681 3.1），按协商后的长度重新计算；已经发出数据后（例如对方重传 SYN）不再改变
+    if (next_absseq_ <= 1)
+    {
+        cc_->set_initial_mss(mss_);
+        pacer_.set_initial_mss(mss_);
+    }
+}
+
+uint64_t TCPSender::max_payload(bool SYN) const
+{
+    const uint64_t syn_options
+        = SYN ? 4 * (syn_options_.mss.has_value() + syn_options_.sack_permitted + syn_options_.window_scale.has_value()) : 0;
+    const uint64_t options = option_length_ + syn_options;
+    return options < mss_ ? mss_ - options : 1;
+}
+
+void TCPSender::set_mss(uint64_t mss)
+{
+    mss_ = mss;
+    cc_->set_mss(mss);
+    pacer_.set_mss(mss);
+}
+
+std::optional<uint64_t> MtuProber::next_probe() const
+{
+    if (!enabled_ || probe_.has_value() || high_ < low_ + SEARCH_DONE_GAP)
+    {
+        return std::nullopt;
+    }
+    return ceiling_failed_ ? (low_ + high_ + 1) / 2 : high_;
+}
+
+void MtuProber::on_probe_acked()
+{
+    low_ = probe_->second;
+    failures_ = 0;
+    probe_.reset();
+}
+
+void MtuProber::on_probe_lost()
+{
+    if (++failures_ >= MAX_PROBES)
+    {
+        high_ = probe_->second - 1;
+        ceiling_failed_ = true;
+        failures_ = 0;
+    }
+    probe_.reset();
+}
+
 // 返回当前未确认的序列号数量
 uint64_t TCPSender::sequence_numbers_in_flight() const
 {
@@ -19,59 +154,114 @@ uint64_t TCPSender::consecutive_retransmissions() const
     return total_retransmissions_;
 }
 
+// 返回在途数据中已被 SACK 的序列号数量
+uint64_t TCPSender::sequence_numbers_sacked() const
+{
+    uint64_t sacked = 0;
+    for (const auto& segment : qmesg_)
+    {
+        sacked += segment.sacked ? segment.sequence_length() : 0;
+    }
+    return sacked;
+}
+
 // 负责将数据推送到网络中
 void TCPSender::push(const TransmitFunction& transmit)
 {
-    // 确定最大窗口大小，如果窗口大小为0，则设为1以确保至少能发送一个字节
-    uint64_t max_wdsize = (wdsize_ > 0 ? wdsize_ : 1);
-
-    // 只要窗口允许并且没有发送FIN，就继续发送数据
-    while (max_wdsize > total_outstandings_ && !FIN_flag_)
+    // 快速重传和部分确认要求立即补上空洞
+    if (retransmit_pending_)
     {
-        // 创建一个空的TCP消息
-        TCPSenderMessage msg = make_empty_message();
-
-        // 如果还没有发送SYN，则发送SYN
-        if (!SYN_flag_)
+        retransmit_pending_ = false;
+        if (!qmesg_.empty())
         {
-            msg.SYN = true;
-            SYN_flag_ = true;
+            retransmit_front(transmit);
         }
+    }
+
+    // 有 SACK 信息时先补上判定丢失的空洞（RFC 6675 NextSeg 规则 1）
+    if (scoreboard_active())
+    {
+        retransmit_lost(transmit, false);
+    }
+
+    // 确定最大窗口大小，如果窗口大小为0，则设为1以确保至少能发送一个字节
+    const uint64_t max_wdsize = wdsize_ > 0 ? wdsize_ : 1;
+    const uint64_t first_new_absseq = next_absseq_;
+
+    // 只要接收窗口、拥塞窗口和发送节奏都允许并且没有发送FIN，就继续发送数据
+    while (max_wdsize > total_outstandings_ && congestion_room() > 0 && pacer_.can_send() && !FIN_flag_)
+    {
+        // 新报文段的记录，如果还没有发送SYN，则发送SYN
+        Outstanding segment{.absseq = next_absseq_, .sent_ms = now_ms(), .xmit_ms = now_ms(), .SYN = !SYN_flag_};
+        SYN_flag_ = true;
 
         // 计算剩余的窗口大小
-        uint64_t remains = max_wdsize - total_outstandings_;
+        uint64_t remains = std::min(max_wdsize - total_outstandings_, congestion_room());
         // 从输入流中读取数据，读取的大小不能超过最大负载和剩余窗口大小
-        uint64_t payload_size = std::min(TCPConfig::MAX_PAYLOAD_SIZE, remains - msg.sequence_length());
-        read(input_.reader(), payload_size, msg.payload);
+        uint64_t payload_size = std::min(max_payload(segment.SYN), remains - segment.SYN);
+
+        // 连接建立后、不在恢复期间，用已经写入的新数据填满一个更大的探测报文段
+        const auto probe = prober_.next_probe();
+        const bool probing = probe.has_value() && !segment.SYN && !in_recovery_ && ack_absseq_ >= recover_absseq_ && remains >= *probe
+                             && unsent_bytes() >= *probe;
+        if (probing)
+        {
+            payload_size = *probe - std::min(*probe, option_length_);
+            prober_.on_probe_sent(next_absseq_, *probe);
+        }
+        // 数据留在输入流中，记录中只保存长度
+        segment.length = static_cast<uint32_t>(std::min(payload_size, unsent_bytes()));
+        bytes_sent_ += segment.length;
 
         // 如果可以发送FIN并且输入流已结束，则发送FIN
-        if (!FIN_flag_ && remains > msg.sequence_length() && reader().is_finished())
+        if (!FIN_flag_ && remains > segment.sequence_length() && input_sent())
         {
-            msg.FIN = true;
+            segment.FIN = true;
             FIN_flag_ = true;
         }
 
         // 如果消息长度为0，退出循环
-        if (msg.sequence_length() == 0)
+        if (segment.sequence_length() == 0)
         {
             break;
         }
 
         // 发送消息
-        transmit(msg);
+        transmit(make_message(segment.absseq, segment.SYN, segment.length, segment.FIN));
+        cc_->on_send(segment.sequence_length(), now_ms());
+        pacer_.on_send(segment.sequence_length());
 
         // 如果计时器未激活，则启动计时器
-        if (!timer_.is_active())
+        if (!timers_.is_armed(rto_timer_))
         {
-            timer_.start();
+            restart_rto_timer();
         }
 
         // 更新下一个绝对序列号和未完成的数量
-        next_absseq_ += msg.sequence_length();
-        total_outstandings_ += msg.sequence_length();
+        next_absseq_ += segment.sequence_length();
+        total_outstandings_ += segment.sequence_length();
+
+        // 将记录加入队列
+        qmesg_.push_back(segment);
+    }
+
+    // 发出了新数据，重新设置尾部丢失探测计时器
+    if (next_absseq_ != first_new_absseq)
+    {
+        arm_loss_probe();
+    }
+
+    // 发送节奏推迟了新数据：令牌足够时再 tick 一次（上层只 tick 定时器到期的连接）
+    const bool more_to_send = unsent_bytes() > 0 || (input_sent() && !FIN_flag_);
+    if (SYN_flag_ && !pacer_.can_send() && more_to_send && !timers_.is_armed(pace_timer_))
+    {
+        pace_timer_ = timers_.arm(now_ms() + pacer_.ms_until_send());
+    }
 
-        // 将消息加入队列
-        qmesg_.emplace(std::move(msg));
+    // 恢复期间没有新数据可发时，重传其余未被 SACK 的报文段（RFC 6675 NextSeg 规则 3）
+    if (sack_seen_ && in_recovery_)
+    {
+        retransmit_lost(transmit, true);
     }
 }
 
@@ -82,7 +272,106 @@ TCPSenderMessage TCPSender::make_empty_message() const
     return {Wrap32::wrap(next_absseq_, isn_), false, {}, false, input_.has_error()};
 }
 
+TCPSenderMessage TCPSender::make_message(uint64_t absseq, bool SYN, uint64_t length, bool FIN) const
+{
+    TCPSenderMessage msg{Wrap32::wrap(absseq, isn_), SYN, {}, FIN, input_.has_error()};
+    // 有效载荷仍是 std::string，每个报文段复制一次；数据本身只在输入流中保存一份
+    msg.payload.reserve(length);
+    for (const std::string_view part : reader().peek_range(absseq + SYN - 1 - reader().bytes_popped(), length))
+    {
+        msg.payload.append(part);
+    }
+    if (SYN)
+    {
+        msg.sack_permitted = syn_options_.sack_permitted;
+        msg.window_scale = syn_options_.window_scale;
+        msg.mss = syn_options_.mss;
+    }
+    return msg;
+}
+
+bool TCPSender::is_idle(const TCPReceiverMessage& msg) const
+{
+    // 没有在途的报文段时确认号就是下一个序列号；FIN 已发送或流未关闭时 push() 也无事可做
+    return SYN_flag_ && total_outstandings_ == 0 && !retransmit_pending_ && !input_.has_error() && unsent_bytes() == 0
+           && (FIN_flag_ || !writer().is_closed()) && !msg.RST && msg.ackno == Wrap32::wrap(next_absseq_, isn_)
+           && msg.window_size == wdsize_ && msg.sack_blocks.empty();
+}
+
 // 处理接收到的TCPReceiverMessage
+bool TCPSender::predicted(const TCPReceiverMessage& msg) const
+{
+    if (input_.has_error() || msg.RST || !msg.ackno.has_value() || !msg.sack_blocks.empty() || ack_absseq_ == 0 || in_recovery_ || total_retransmissions_ > 0 || retransmit_pending_ || tlp_end_absseq_.has_value())
+    {
+        return false;
+    }
+    const uint64_t recv_ack_absseq = msg.ackno->unwrap(isn_, next_absseq_);
+    if (recv_ack_absseq <= ack_absseq_ || recv_ack_absseq > next_absseq_)
+    {
+        return false;
+    }
+
+    // 通常只确认一两个报文段，逐个检查它们和之后的第一个报文段
+    uint64_t absseq = ack_absseq_;
+    for (const auto& segment : qmesg_)
+    {
+        if (segment.retransmitted || segment.sacked || segment.lost || prober_.is_probe(segment.absseq))
+        {
+            return false;
+        }
+        if (absseq == recv_ack_absseq)
+        {
+            return true;
+        }
+        absseq += segment.sequence_length();
+        if (absseq > recv_ack_absseq)
+        {
+            return false;
+        }
+    }
+    return absseq == recv_ack_absseq;
+}
+
+void TCPSender::receive_predicted(const TCPReceiverMessage& msg)
+{
+    // 确认号推进时窗口的变化只影响重复确认的判断，直接更新
+    wdsize_ = msg.window_size;
+    const uint64_t recv_ack_absseq = msg.ackno->unwrap(isn_, next_absseq_);
+    uint64_t acked_bytes = 0;
+    uint64_t sent_ms = 0;
+    while (ack_absseq_ < recv_ack_absseq)
+    {
+        const auto& segment = qmesg_.front();
+        ack_absseq_ += segment.sequence_length();
+        total_outstandings_ -= segment.sequence_length();
+        acked_bytes += segment.length;
+        sent_ms = segment.sent_ms;
+        rack_.on_delivered(segment.xmit_ms, ack_absseq_, now_ms(), false);
+        release(segment.stream_index() + segment.length);
+        qmesg_.pop_front();
+    }
+
+    dup_acks_ = 0;
+    cc_->on_ack(acked_bytes, total_outstandings_, now_ms());
+    timer_.sample_rtt(now_ms() - sent_ms);
+    timer_.reload();
+    if (qmesg_.empty())
+    {
+        timers_.cancel(rto_timer_);
+    }
+    else
+    {
+        restart_rto_timer();
+    }
+    // 其后的报文段没有重传过，比最近送达的报文段发得晚，RACK 不会判定丢失，不必扫描
+    if (rack_tlp_)
+    {
+        timers_.cancel(reorder_timer_);
+    }
+    arm_loss_probe();
+    update_pacing_rate();
+}
+
 void TCPSender::receive(const TCPReceiverMessage& msg)
 {
     // 如果输入流有错误，直接返回
@@ -99,6 +388,7 @@ void TCPSender::receive(const TCPReceiverMessage& msg)
     }
 
     // 更新窗口大小
+    const bool window_changed = wdsize_ != msg.window_size;
     wdsize_ = msg.window_size;
 
     // 如果没有ackno，直接返回
@@ -117,51 +407,462 @@ void TCPSender::receive(const TCPReceiverMessage& msg)
     }
 
     bool has_ackno_flag = false;
+    uint64_t acked_bytes = 0;             // 新确认的数据字节数（不含 SYN 和 FIN），交给拥塞控制
+    std::optional<uint64_t> rtt_sample{}; // 由最新确认的报文段得到的RTT
+    bool ambiguous = false;               // 确认了重传过的报文段，无法判断确认对应哪一次发送
 
     // 处理确认的消息
     while (!qmesg_.empty())
     {
-        const auto& message = qmesg_.front();
+        const auto& segment = qmesg_.front();
 
         // 如果消息的序列号超出接收到的ack序列号，停止处理
-        if (ack_absseq_ + message.sequence_length() > recv_ack_absseq)
+        if (ack_absseq_ + segment.sequence_length() > recv_ack_absseq)
         {
             break;
         }
 
+        // 探测报文段完整到达：之后的报文段使用这个长度
+        if (prober_.is_probe(ack_absseq_))
+        {
+            prober_.on_probe_acked();
+            set_mss(prober_.mss());
+        }
+
         // 更新确认的序列号和未完成的数量
         has_ackno_flag = true;
-        ack_absseq_ += message.sequence_length();
-        total_outstandings_ -= message.sequence_length();
-        qmesg_.pop();
+        ack_absseq_ += segment.sequence_length();
+        total_outstandings_ -= segment.sequence_length();
+        acked_bytes += segment.length;
+        ambiguous |= segment.retransmitted;
+        rtt_sample = now_ms() - segment.sent_ms;
+        rack_.on_delivered(segment.xmit_ms, ack_absseq_, now_ms(), segment.retransmitted);
+        release(segment.stream_index() + segment.length);
+        qmesg_.pop_front();
     }
 
-    // 如果有新的ack，重置重传计数器和计时器
-    if (has_ackno_flag)
+    // 队首报文段只被确认了一部分（例如途中被重新分段）：裁掉已确认的前缀，之后只重传未确认的部分
+    if (!qmesg_.empty() && recv_ack_absseq > ack_absseq_)
     {
-        total_retransmissions_ = 0;
-        timer_.reload(initial_RTO_ms_);
-        qmesg_.empty() ? timer_.stop() : timer_.start();
+        auto& segment = qmesg_.front();
+        const uint64_t trimmed = recv_ack_absseq - ack_absseq_;
+        const uint64_t trimmed_bytes = trimmed - segment.SYN;
+
+        // 探测报文段没有完整到达，不能说明这个长度可以通过路径
+        if (prober_.is_probe(segment.absseq))
+        {
+            prober_.on_probe_lost();
+        }
+
+        release(segment.stream_index() + trimmed_bytes);
+        segment.absseq += trimmed;
+        segment.length -= static_cast<uint32_t>(trimmed_bytes);
+        segment.SYN = false;
+
+        has_ackno_flag = true;
+        ack_absseq_ += trimmed;
+        total_outstandings_ -= trimmed;
+        acked_bytes += trimmed_bytes;
     }
+    update_scoreboard(msg.sack_blocks);
+    const bool rack_lost = rack_tlp_ && rack_detect_loss();
+
+    // 确认号没有推进、窗口也没有变化、且仍有数据在途：重复确认
+    if (!has_ackno_flag)
+    {
+        if (recv_ack_absseq == ack_absseq_ && !window_changed && !qmesg_.empty())
+        {
+            on_duplicate_ack();
+        }
+        // SACK 表明队首已经丢失时，不必等满三个重复确认
+        enter_recovery_if_lost(rack_lost);
+        return;
+    }
+    dup_acks_ = 0;
+
+    if (in_recovery_ && ack_absseq_ < recover_absseq_)
+    {
+        // 部分确认：队首是下一个空洞，立即重传（有 SACK 时它可能已作为丢失的报文段重传过）；
+        // 没有 SACK 时收缩膨胀的窗口，但保留一个报文段让新数据继续流动
+        inflation_ = inflation_ > acked_bytes ? inflation_ - acked_bytes : 0;
+        inflation_ += !sack_seen_ && acked_bytes >= mss_ ? mss_ : 0;
+        retransmit_pending_ = !qmesg_.front().repaired;
+    }
+    else if (in_recovery_)
+    {
+        // 完全确认：恢复结束，窗口回到 ssthresh
+        in_recovery_ = false;
+        inflation_ = 0;
+    }
+    else
+    {
+        cc_->on_ack(acked_bytes, total_outstandings_, now_ms());
+    }
+
+    // 恢复结束后 SACK 表明新的窗口里又有丢失：新的拥塞事件
+    enter_recovery_if_lost(rack_lost);
+
+    // 探测覆盖的数据都已确认而没有经过快速恢复：探测补上了尾部的丢失，同样减小拥塞窗口（RFC 8985 7.4.2）
+    if (tlp_end_absseq_.has_value() && ack_absseq_ >= *tlp_end_absseq_)
+    {
+        tlp_end_absseq_.reset();
+        cc_->on_loss(total_outstandings_, now_ms());
+    }
+
+    // 有新的ack，重置重传计数器和计时器
+    if (rtt_sample.has_value() && !ambiguous)
+    {
+        timer_.sample_rtt(*rtt_sample);
+    }
+    total_retransmissions_ = 0;
+    timer_.reload();
+    if (qmesg_.empty())
+    {
+        timers_.cancel(rto_timer_);
+    }
+    else
+    {
+        restart_rto_timer();
+    }
+    arm_loss_probe();
+    update_pacing_rate();
+}
+
+// 取消所有定时器
+void TCPSender::cancel_timers()
+{
+    timers_.cancel(rto_timer_);
+    timers_.cancel(pace_timer_);
+    timers_.cancel(reorder_timer_);
+    timers_.cancel(pto_timer_);
 }
 
 // 处理计时器的tick事件
 void TCPSender::tick(uint64_t ms_since_last_tick, const TransmitFunction& transmit)
 {
-    // 更新计时器，如果计时器过期且消息队列不为空，进行重传
-    if (timer_.tick(ms_since_last_tick).is_expired() && !qmesg_.empty())
+    timers_.advance(ms_since_last_tick);
+
+    // 重排序计时器到期：仍未送达的报文段判定丢失，补上新发现的空洞
+    if (timers_.has_expired(reorder_timer_) && rack_detect_loss())
     {
-        // 重传队列中的第一个消息
-        transmit(qmesg_.front());
+        enter_recovery_if_lost(true);
+        push(transmit);
+    }
+
+    // 尾部丢失探测计时器到期（进入快速恢复时已被取消）
+    if (timers_.has_expired(pto_timer_))
+    {
+        send_loss_probe(transmit);
+    }
 
-        // 如果窗口大小不为0，则进行指数退避
+    // 如果重传计时器到期且消息队列不为空，进行重传
+    if (timers_.has_expired(rto_timer_) && !qmesg_.empty())
+    {
+        // 如果窗口大小不为0，说明是拥塞导致的超时（而不是零窗口探测），通知拥塞控制并进行指数退避
         if (wdsize_ != 0)
         {
+            // 超时结束快速恢复；之后直到越过当前最高序列号之前都不再进入快速重传（RFC 6582 3.2）
+            in_recovery_ = false;
+            inflation_ = 0;
+            dup_acks_ = 0;
+            recover_absseq_ = next_absseq_;
+            cc_->on_rto(total_outstandings_, now_ms());
+            timers_.cancel(pto_timer_);
+            tlp_end_absseq_.reset();
             ++total_retransmissions_;
             timer_.exponential_backoff();
+
+            // 接收端可能已经丢弃了 SACK 过的数据，超时后不再信任记分板：清除 SACK 标记（RFC 2018 第 8 节），
+            // 所有未确认的报文段都视为丢失，有 SACK 信息时随着窗口增长逐个重传（RFC 6675 5.1）
+            for (auto& segment : qmesg_)
+            {
+                segment.sacked = false;
+                segment.lost = true;
+                segment.repaired = false;
+            }
+        }
+
+        // 重传队列中的第一个消息
+        retransmit_front(transmit);
+
+        // 按（退避后的）RTO 重新启动计时器
+        restart_rto_timer();
+    }
+
+    // 积累令牌，发出之前因发送节奏而推迟的新数据（连接由 push() 发起之后）
+    if (pacer_.is_enabled() && SYN_flag_)
+    {
+        pacer_.tick(now_ms() - pace_ms_);
+        push(transmit);
+    }
+    pace_ms_ = now_ms();
+}
+
+void TCPSender::update_pacing_rate()
+{
+    const auto srtt = timer_.srtt_ms();
+    if (!pacer_.is_enabled() || !srtt.has_value())
+    {
+        return;
+    }
+    const uint64_t window = std::min<uint64_t>(cc_->cwnd(), std::max<uint32_t>(wdsize_, 1));
+    const double gain = cc_->cwnd() < cc_->ssthresh() ? 2.0 : 1.25;
+    const double rate = gain * static_cast<double>(window) / static_cast<double>(std::max<uint64_t>(*srtt, 1));
+    pacer_.set_rate(std::max<uint64_t>(static_cast<uint64_t>(rate), 1));
+}
+
+void TCPSender::retransmit(Outstanding& segment, const TransmitFunction& transmit)
+{
+    // 重传探测报文段说明这个长度可能无法通过路径
+    if (prober_.is_probe(segment.absseq))
+    {
+        prober_.on_probe_lost();
+    }
+
+    // 从输入流中重新切出有效载荷；超过当前报文段长度的报文段（探测失败）拆成多个报文段重传，
+    // 第一段保留 SYN 及其选项，最后一段保留 FIN
+    uint64_t offset = 0;
+    do
+    {
+        const bool first = offset == 0;
+        const uint64_t length = std::min<uint64_t>(max_payload(segment.SYN && first), segment.length - offset);
+        const bool last = offset + length == segment.length;
+        transmit(make_message(segment.absseq + (first ? 0 : segment.SYN + offset), segment.SYN && first, length, segment.FIN && last));
+        offset += length;
+    } while (offset < segment.length);
+    segment.retransmitted = true;
+    segment.repaired = true;
+    segment.xmit_ms = now_ms();
+    cc_->on_send(segment.sequence_length(), now_ms());
+    pacer_.on_send(segment.sequence_length());
+}
+
+void TCPSender::retransmit_front(const TransmitFunction& transmit)
+{
+    retransmit(qmesg_.front(), transmit);
+}
+
+void TCPSender::on_duplicate_ack()
+{
+    ++dup_acks_;
+    if (in_recovery_)
+    {
+        // 又一个报文段离开了网络，窗口膨胀一个报文段，保持管道充满（有 SACK 时由记分板计算）
+        inflation_ += sack_seen_ ? 0 : mss_;
+        return;
+    }
+    // 第三个重复确认且确认号已越过上次恢复点：快速重传并进入快速恢复
+    if (dup_acks_ == DUP_ACK_THRESHOLD && ack_absseq_ >= recover_absseq_)
+    {
+        enter_recovery();
+    }
+}
+
+void TCPSender::enter_recovery()
+{
+    // 丢失的是探测报文段时，更可能是它超过了路径 MTU，而不是发生了拥塞（RFC 4821 7.5）
+    if (!prober_.is_probe(ack_absseq_))
+    {
+        cc_->on_loss(total_outstandings_, now_ms());
+    }
+    in_recovery_ = true;
+    recover_absseq_ = next_absseq_;
+    // 快速恢复本身就是对这次丢失的响应，不再需要尾部丢失探测
+    timers_.cancel(pto_timer_);
+    tlp_end_absseq_.reset();
+    // 没有 SACK 时，三个重复确认代表三个已离开网络的报文段；有 SACK 时由记分板直接计算
+    inflation_ = sack_seen_ ? 0 : DUP_ACK_THRESHOLD * mss_;
+    for (auto& segment : qmesg_)
+    {
+        segment.repaired = false;
+    }
+    retransmit_pending_ = true;
+}
+
+void TCPSender::update_scoreboard(const std::vector<SackBlock>& blocks)
+{
+    bool changed = false;
+    for (const auto& block : blocks)
+    {
+        // 忽略已确认范围内（D-SACK）或超出已发送范围的块
+        const uint64_t begin = block.begin.unwrap(isn_, next_absseq_);
+        const uint64_t end = block.end.unwrap(isn_, next_absseq_);
+        if (begin >= end || begin < ack_absseq_ || end > next_absseq_)
+        {
+            continue;
+        }
+        sack_seen_ = true;
+
+        // 完全落在块内的报文段都已收到
+        uint64_t seqno = ack_absseq_;
+        for (auto& segment : qmesg_)
+        {
+            if (seqno >= end)
+            {
+                break;
+            }
+            const uint64_t len = segment.sequence_length();
+            if (!segment.sacked && seqno >= begin && seqno + len <= end)
+            {
+                segment.sacked = true;
+                changed = true;
+                rack_.on_delivered(segment.xmit_ms, seqno + len, now_ms(), segment.retransmitted);
+            }
+            seqno += len;
+        }
+    }
+    if (!changed)
+    {
+        return;
+    }
+
+    // 从后往前数被 SACK 的报文段，其后有足够多报文段到达的空洞判定为丢失（RFC 6675 IsLost）
+    uint64_t sacked_above = 0;
+    for (auto it = qmesg_.rbegin(); it != qmesg_.rend(); ++it)
+    {
+        sacked_above += it->sacked;
+        it->lost |= !it->sacked && sacked_above >= DUP_ACK_THRESHOLD;
+    }
+}
+
+void TCPSender::enter_recovery_if_lost(bool rack_lost)
+{
+    if (sack_seen_ && !in_recovery_ && !qmesg_.empty() && (qmesg_.front().lost || rack_lost) && ack_absseq_ >= recover_absseq_)
+    {
+        enter_recovery();
+    }
+}
+
+bool TCPSender::rack_detect_loss()
+{
+    timers_.cancel(reorder_timer_);
+    if (!rack_.has_delivered())
+    {
+        return false;
+    }
+
+    bool detected = false;
+    uint64_t reorder_deadline = 0;
+    uint64_t end = ack_absseq_;
+    for (auto& segment : qmesg_)
+    {
+        end += segment.sequence_length();
+        // 已收到的、已判定丢失而还没有重传的、以及比最近送达的报文段发得晚的报文段都不用判断
+        if (segment.sacked || (segment.lost && !segment.repaired))
+        {
+            continue;
+        }
+        if (!rack_.sent_before_delivered(segment.xmit_ms, end))
+        {
+            // 没有重传过的报文段按首次发送的顺序排在队列里，它之后的报文段（重传过的只会发得更晚）
+            // 也都不比最近送达的报文段发得早：稳定状态下扫描到第一个在途的报文段就结束
+            if (!segment.retransmitted)
+            {
+                break;
+            }
+            continue;
+        }
+        // 重传过的报文段按重传时间判断，重传也丢失时可以再次重传
+        const uint64_t deadline = rack_.loss_deadline(segment.xmit_ms);
+        if (deadline <= now_ms())
+        {
+            segment.lost = true;
+            segment.repaired = false;
+            detected = true;
+        }
+        else
+        {
+            reorder_deadline = std::max(reorder_deadline, deadline);
+        }
+    }
+    if (reorder_deadline != 0)
+    {
+        reorder_timer_ = timers_.arm(reorder_deadline);
+    }
+    return detected;
+}
+
+void TCPSender::arm_loss_probe()
+{
+    timers_.cancel(pto_timer_);
+    const auto srtt = timer_.srtt_ms();
+    // 恢复期间、超时重传之后和上一个探测还没有结果时不探测（RFC 8985 7.2）
+    if (!rack_tlp_ || !srtt.has_value() || qmesg_.empty() || in_recovery_ || total_retransmissions_ > 0 || tlp_end_absseq_.has_value())
+    {
+        return;
+    }
+    uint64_t pto = 2 * *srtt;
+    if (qmesg_.size() == 1)
+    {
+        pto += WORST_CASE_DELAYED_ACK_MS;
+    }
+    pto_timer_ = timers_.arm(now_ms() + std::clamp<uint64_t>(pto, 1, timer_.rto_ms()));
+}
+
+void TCPSender::send_loss_probe(const TransmitFunction& transmit)
+{
+    timers_.cancel(pto_timer_);
+    const auto last = std::find_if(qmesg_.rbegin(), qmesg_.rend(), [](const Outstanding& segment) { return !segment.sacked; });
+    if (last == qmesg_.rend())
+    {
+        return;
+    }
+    retransmit(*last, transmit);
+    tlp_end_absseq_ = next_absseq_;
+    // 探测之后重新开始 RTO 计时
+    restart_rto_timer();
+}
+
+void TCPSender::restart_rto_timer()
+{
+    timers_.cancel(rto_timer_);
+    rto_timer_ = timers_.arm(now_ms() + timer_.rto_ms());
+}
+
+uint64_t TCPSender::pipe() const
+{
+    uint64_t pipe = 0;
+    for (const auto& segment : qmesg_)
+    {
+        if (!segment.sacked)
+        {
+            pipe += (segment.lost ? 0 : segment.sequence_length()) + (segment.repaired ? segment.sequence_length() : 0);
         }
+    }
+    return pipe;
+}
 
-        // 重置计时器
-        timer_.reset();
+uint64_t TCPSender::congestion_room() const
+{
+    // 其他时候在途数据就是全部未确认的序列号，没有 SACK 的快速恢复期间窗口按重复确认膨胀
+    const uint64_t cwnd = cc_->cwnd() > UINT64_MAX - inflation_ ? UINT64_MAX : cc_->cwnd() + inflation_;
+    const uint64_t flight = scoreboard_active() ? pipe() : total_outstandings_;
+    return cwnd > flight ? cwnd - flight : 0;
+}
+
+void TCPSender::retransmit_lost(const TransmitFunction& transmit, bool any_unsacked)
+{
+    // 规则 3 只考虑最高的被 SACK 的报文段之前的空洞，其后的报文段可能仍在途中
+    auto end = qmesg_.end();
+    if (any_unsacked)
+    {
+        end = std::find_if(qmesg_.rbegin(), qmesg_.rend(), [](const Outstanding& segment) { return segment.sacked; }).base();
+    }
+
+    uint64_t room = congestion_room();
+    for (auto it = qmesg_.begin(); it != end; ++it)
+    {
+        auto& segment = *it;
+        if (segment.sacked || segment.repaired || !(segment.lost || any_unsacked))
+        {
+            continue;
+        }
+        const uint64_t len = segment.sequence_length();
+        if (room < len)
+        {
+            break;
+        }
+        retransmit(segment, transmit);
+        room -= len;
     }
 }
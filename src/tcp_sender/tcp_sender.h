@@ -1,52 +1,208 @@
 #ifndef TCP_SENDER_H
 #define TCP_SENDER_H
 
+#include <algorithm>
 #include <cstdint>
-#include <queue>
+#include <deque>
+#include <vector>
 #include <functional>
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
 #include "byte_stream.h"
+#include "congestion_control.h"
 #include "tcp_receiver_message.h"
 #include "tcp_sender_message.h"
+#include "timer_wheel.h"
 
-// 重传计时器类，用于管理TCP段的重传超时
+class TCPConfig;
+
+// 重传超时的计算方式
+struct RTOPolicy
+{
+    bool adaptive{false};   // 为 true 时按 RFC 6298 由 RTT 估计 RTO，否则始终从初始 RTO 开始
+    uint64_t min_ms{200};   // 自适应 RTO 的下限
+    uint64_t max_ms{60000}; // 自适应 RTO（包括退避后）的上限
+};
+
+// 发送节奏的控制方式
+struct PacingPolicy
+{
+    bool enabled{false};          // 为 true 时新数据按令牌桶逐步发出，否则窗口允许多少就立即发送多少
+    uint64_t rate_bytes_per_ms{}; // 固定的发送速率，0 表示由拥塞窗口和 SRTT 计算
+};
+
+// 令牌桶：以发送速率积累可发送的字节数，最多积累两个报文段和 1 毫秒数据中较多的一个；
+// 有令牌时就可以发送一个报文段，发送后可能透支，透支的部分由之后积累的令牌偿还
+class Pacer
+{
+public:
+    explicit Pacer(PacingPolicy policy, uint64_t mss)
+        : policy_(policy), mss_(mss), rate_(policy.rate_bytes_per_ms), tokens_(static_cast<int64_t>(depth()))
+    {
+    }
+    // 最大报文段长度改变
+    void set_mss(uint64_t mss) { mss_ = mss; }
+    // 连接建立时报文段长度确定：按它重新装满令牌桶
+    void set_initial_mss(uint64_t mss)
+    {
+        mss_ = mss;
+        tokens_ = static_cast<int64_t>(depth());
+    }
+    // 是否启用了发送节奏控制
+    bool is_enabled() const { return policy_.enabled; }
+    // 是否允许现在发送一个新的报文段；还不知道速率时不加限制
+    bool can_send() const { return !policy_.enabled || rate_ == 0 || tokens_ > 0; }
+    // 发送了 bytes 个字节（包括重传），消耗令牌
+    void on_send(uint64_t bytes) { tokens_ -= static_cast<int64_t>(bytes); }
+    // 更新发送速率（字节/毫秒）；配置了固定速率时忽略
+    void set_rate(uint64_t rate_bytes_per_ms) { rate_ = policy_.rate_bytes_per_ms ? policy_.rate_bytes_per_ms : rate_bytes_per_ms; }
+    // 当前的发送速率，0 表示还不知道
+    uint64_t rate() const { return rate_; }
+    // 不允许发送时，积累的令牌再过多少毫秒足够发送一个报文段
+    uint64_t ms_until_send() const { return can_send() ? 0 : static_cast<uint64_t>(-tokens_) / rate_ + 1; }
+    // 经过给定的毫秒数，积累令牌
+    void tick(uint64_t ms_since_last_tick)
+    {
+        tokens_ = std::min(tokens_ + static_cast<int64_t>(rate_ * ms_since_last_tick), static_cast<int64_t>(depth()));
+    }
+
+private:
+    uint64_t depth() const { return std::max(2 * mss_, rate_); }
+
+    PacingPolicy policy_; // 发送节奏的控制方式
+    uint64_t mss_;        // 最大报文段长度
+    uint64_t rate_;       // 当前的发送速率（字节/毫秒）
+    int64_t tokens_;      // 桶中的令牌（字节），为负表示透支
+};
+
+// 路径 MTU 探测（RFC 4821 PLPMTUD）：报文段长度从已知能通过路径的 base 开始，
+// 先用一个协商 MSS 大小的报文段探测，失败后在已知可行与已知过大的长度之间二分查找
+class MtuProber
+{
+public:
+    MtuProber(bool enabled, uint64_t base) : enabled_(enabled), low_(base), high_(base) {}
+    // 是否启用了探测
+    bool is_enabled() const { return enabled_; }
+    // 已知能通过路径的最大报文段长度
+    uint64_t mss() const { return low_; }
+    // 设置探测的上限（协商的 MSS）
+    void set_limit(uint64_t limit) { low_ = std::min(low_, limit), high_ = limit; }
+    // 下一个探测报文段的长度，不需要探测（未启用、已有探测在途或查找已经结束）时为空
+    std::optional<uint64_t> next_probe() const;
+    // 绝对序列号 absseq 处发出了长度为 size 的探测报文段
+    void on_probe_sent(uint64_t absseq, uint64_t size) { probe_ = {absseq, size}; }
+    // 以 absseq 开始的报文段是否是在途的探测
+    bool is_probe(uint64_t absseq) const { return probe_.has_value() && probe_->first == absseq; }
+    // 探测报文段被确认：这个长度可以通过路径
+    void on_probe_acked();
+    // 探测报文段被判定丢失：连续 MAX_PROBES 次后认为这个长度过大
+    void on_probe_lost();
+
+private:
+    static constexpr uint64_t MAX_PROBES = 3;      // 同一长度连续失败多少次后认为过大（RFC 4821 7.2）
+    static constexpr uint64_t SEARCH_DONE_GAP = 8; // 上下界相差不到这么多字节时停止查找
+
+    bool enabled_;
+    uint64_t low_;                                          // 已知能通过路径的长度
+    uint64_t high_;                                         // 可能通过路径的最大长度
+    bool ceiling_failed_{};                                 // 上限本身是否已经探测失败过，之后改为二分查找
+    uint64_t failures_{};                                   // 当前长度连续失败的次数
+    std::optional<std::pair<uint64_t, uint64_t>> probe_{}; // 在途探测的起始绝对序列号和长度
+};
+
+// RACK（RFC 8985）：按发送时间而不是重复确认的个数判定丢失。在途报文段之后发送的报文段已经送达，
+// 且从它最后一次发送起已经过去一个 RTT 加重排序窗口，就认为它丢失了
+class RackState
+{
+public:
+    // 最后一次在 xmit_ms 发送、结束于 end_absseq 的报文段在 now_ms 被确认或 SACK
+    void on_delivered(uint64_t xmit_ms, uint64_t end_absseq, uint64_t now_ms, bool retransmitted);
+    // 是否已有报文段送达
+    bool has_delivered() const { return delivered_; }
+    // 在 xmit_ms 发送、结束于 end_absseq 的报文段是否比最近送达的报文段发送得早
+    bool sent_before_delivered(uint64_t xmit_ms, uint64_t end_absseq) const
+    {
+        return xmit_ms < xmit_ms_ || (xmit_ms == xmit_ms_ && end_absseq < end_absseq_);
+    }
+    // 在 xmit_ms 发送的这样的报文段到这个时刻仍未送达即判定丢失
+    uint64_t loss_deadline(uint64_t xmit_ms) const { return xmit_ms + rtt_ + min_rtt_ / 4; }
+
+private:
+    bool delivered_{};
+    uint64_t xmit_ms_{};           // 最近送达的报文段（按发送时间）最后一次发送的时间
+    uint64_t end_absseq_{};        // 该报文段的结束序列号，发送时间相同时区分先后
+    uint64_t rtt_{};               // 该报文段的 RTT
+    uint64_t min_rtt_{UINT64_MAX}; // 最小 RTT，重排序窗口取它的四分之一
+};
+
+// 发送端在 SYN 中声明的选项
+struct SynOptions
+{
+    bool sack_permitted{false};            // 支持 SACK（RFC 2018）
+    std::optional<uint8_t> window_scale{}; // 本端接收窗口的扩大移位数（RFC 7323），为空表示不声明
+    std::optional<uint16_t> mss{};         // 本端能接收的最大报文段长度，也是发出的报文段长度上限；
+                                           // 为空表示不声明，按 TCPConfig::MAX_PAYLOAD_SIZE 发送
+};
+
+// 重传超时类，按 RFC 6298 由 RTT 样本计算 RTO 并负责指数退避；计时本身由发送器的时间轮完成
 class RetransmissionTimer
 {
 public:
-    // 构造函数，初始化重传超时（RTO）
-    explicit RetransmissionTimer(uint64_t initial_RTO_ms) : rto_ms_(initial_RTO_ms) {}
-    // 检查计时器是否处于活动状态
-    bool is_active() const { return is_active_; }
-    // 检查计时器是否已过期
-    bool is_expired() const { return is_active_ && time_ms_ >= rto_ms_; }
-    // 重置计时器
-    void reset() { time_ms_ = 0; }
-    // 指数退避，翻倍RTO
-    void exponential_backoff() { rto_ms_ <<= 1; }
-    // 重新加载初始RTO并重置计时器
-    void reload(uint64_t initial_RTO_ms) { rto_ms_ = initial_RTO_ms, reset(); }
-    // 启动计时器
-    void start() { is_active_ = true, reset(); }
-    // 停止计时器
-    void stop() { is_active_ = false, reset(); }
-    // 更新计时器，增加经过的时间
-    RetransmissionTimer &tick(uint64_t ms_since_last_tick)
+    // 构造函数，初始化重传超时（RTO）及其计算方式
+    explicit RetransmissionTimer(uint64_t initial_RTO_ms, RTOPolicy policy = {})
+        : policy_(policy), base_rto_ms_(initial_RTO_ms), rto_ms_(initial_RTO_ms)
     {
-        time_ms_ += is_active_ ? ms_since_last_tick : 0;
-        return *this;
     }
+    // 指数退避，翻倍RTO（自适应时不超过上限）
+    void exponential_backoff() { rto_ms_ = policy_.adaptive ? std::min(rto_ms_ << 1, policy_.max_ms) : rto_ms_ << 1; }
+    // 撤销退避，重新加载未退避的RTO
+    void reload() { rto_ms_ = base_rto_ms_; }
+    // 加入一个 RTT 样本，按 RFC 6298 更新 SRTT、RTTVAR，自适应时还更新未退避的 RTO
+    void sample_rtt(uint64_t rtt_ms);
+    // 平滑后的 RTT，还没有样本时为空
+    std::optional<uint64_t> srtt_ms() const;
+    // 当前的 RTO（包括退避）
+    uint64_t rto_ms() const { return rto_ms_; }
 
 private:
-    bool is_active_{};   // 计时器是否处于活动状态
-    uint64_t rto_ms_{};  // 当前RTO值
-    uint64_t time_ms_{}; // 计时器累计的时间
+    RTOPolicy policy_;       // RTO 的计算方式
+    uint64_t base_rto_ms_{}; // 未退避的RTO：初始值，或自适应时由RTT估计得出
+    uint64_t rto_ms_{};      // 当前RTO值
+    double srtt_{-1};        // 平滑后的RTT，负数表示还没有样本
+    double rttvar_{};        // RTT 的平均偏差
 };
 
 // TCP发送器类，负责管理TCP段的发送和重传
 class TCPSender
 {
 public:
-    /* 构造函数，使用给定的默认重传超时和可能的初始序列号(ISN) */
-    TCPSender(ByteStream &&input, Wrap32 isn, uint64_t initial_RTO_ms) : input_(std::move(input)), isn_(isn), initial_RTO_ms_(initial_RTO_ms), timer_(initial_RTO_ms) {}
+    // 发送器的可选行为，默认全部关闭；TCPPeer 等调用者用 from_config() 由 TCPConfig 一次构造
+    struct Options
+    {
+        CongestionControl::Algorithm congestion_control = CongestionControl::Algorithm::None; // 拥塞控制算法
+        RTOPolicy rto_policy{};     // RTO 的计算方式
+        SynOptions syn_options{};   // SYN 中声明的选项（无论是否声明 SACK，收到的 SACK 块都会用于重传）
+        PacingPolicy pacing{};      // 发送节奏的控制方式
+        bool mtu_probing{false};    // 是否探测路径 MTU
+        bool rack_tlp{false};       // 是否启用 RACK-TLP 丢失检测
+
+        // TCPConfig 中对应的设置
+        static Options from_config(const TCPConfig &cfg);
+    };
+
+    /* 构造函数，使用给定的默认重传超时、可能的初始序列号(ISN)、可选行为，以及使用的时间轮（默认自己拥有一个） */
+    TCPSender(ByteStream &&input, Wrap32 isn, uint64_t initial_RTO_ms, const Options &options, WheelRef timers = {});
+    TCPSender(ByteStream &&input, Wrap32 isn, uint64_t initial_RTO_ms) : TCPSender(std::move(input), isn, initial_RTO_ms, Options{}) {}
+
+    /* 对方在 SYN 中声明的最大报文段长度，为空表示对方没有声明（按 RFC 9293 取 536）；
+       还没有发出数据时，按协商后的长度重新计算初始拥塞窗口和发送节奏的令牌桶 */
+    void set_peer_mss(std::optional<uint16_t> mss);
+
+    /* 之后发出的报文段中接收方一侧附带的 TCP 选项（SACK 块）的字节数。MSS 不含选项，
+       新报文段和重传的有效载荷都减去报文段实际携带的选项长度（RFC 6691） */
+    void set_option_length(uint64_t bytes) { option_length_ = bytes; }
 
     /* 生成一个空的TCPSenderMessage */
     TCPSenderMessage make_empty_message() const;
@@ -54,39 +210,169 @@ public:
     /* 接收并处理来自对等方接收器的TCPReceiverMessage */
     void receive(const TCPReceiverMessage &msg);
 
+    /* 首部预测：本端没有在途或待发送的数据，且 msg 的确认号和窗口与当前相同、不带 SACK 块，
+       此时 receive(msg) 和 push() 都不会有任何作用，调用者可以跳过它们 */
+    bool is_idle(const TCPReceiverMessage &msg) const;
+
+    /* 首部预测：msg 是只推进确认号的纯确认。确认号恰好落在在途报文段的边界上，不带 SACK 块，
+       没有处于快速恢复、超时退避、尾部丢失探测或路径 MTU 探测中，被确认的和其后的第一个报文段都没有重传、
+       SACK 或判定丢失的标记；此时重复确认、记分板和丢失检测都不会有任何作用。
+       确认号推进时窗口的变化不参与重复确认的判断，窗口不必与当前相同 */
+    bool predicted(const TCPReceiverMessage &msg) const;
+
+    /* 处理 predicted() 为 true 的确认：弹出被确认的报文段，取 RTT 样本，通知拥塞控制，重新启动 RTO 和 TLP 计时器，
+       结果与 receive(msg) 相同 */
+    void receive_predicted(const TCPReceiverMessage &msg);
+
     /* `transmit`函数的类型，push和tick方法可以使用它来发送消息 */
     using TransmitFunction = std::function<void(const TCPSenderMessage &)>;
 
     /* 从输出流中推送字节 */
     void push(const TransmitFunction &transmit);
 
-    /* 自上次调用tick()方法以来，时间已过去给定的毫秒数 */
+    /* 自上次调用tick()方法以来，时间已过去给定的毫秒数；启用发送节奏控制时也在这里发出积累了令牌的新数据。
+       使用共享的时间轮时由上层推进时间，只在本连接的定时器到期时调用，ms_since_last_tick 不起作用 */
     void tick(uint64_t ms_since_last_tick, const TransmitFunction &transmit);
 
+    /* 取消本连接在时间轮上的所有定时器。上层删除使用共享时间轮的连接之前调用，定时器不再留到到期 */
+    void cancel_timers();
+
     // 访问器
     uint64_t sequence_numbers_in_flight() const;  // 有多少序列号未完成
     uint64_t consecutive_retransmissions() const; // 已发生多少次连续的重传
+    const CongestionControl &congestion_control() const { return *cc_; }
+    std::optional<uint64_t> srtt_ms() const { return timer_.srtt_ms(); } // 平滑后的RTT，尚无样本时为空
+    uint64_t rto_ms() const { return timer_.rto_ms(); }                   // 当前的重传超时（包括退避）
+    uint64_t duplicate_acks() const { return dup_acks_; }                 // 连续收到的重复确认数
+    bool in_fast_recovery() const { return in_recovery_; }                // 是否处于快速恢复阶段
+    uint64_t sequence_numbers_sacked() const;                             // 在途数据中已被 SACK 的序列号数
+    uint64_t pacing_rate() const { return pacer_.rate(); }                // 发送速率（字节/毫秒），0 表示不限制
+    uint64_t mss() const { return mss_; }                                 // 当前新报文段的最大有效载荷
+    uint64_t max_mss() const { return max_mss_; }                         // 协商的 MSS，探测报文段也不超过它
+    bool syn_acked() const { return ack_absseq_ > 0; }                    // 对方是否已经确认了 SYN
+    bool input_sent() const { return writer().is_closed() && unsent_bytes() == 0; } // 输入流已关闭且全部发出（FIN 可能还没发）
     Writer &writer() { return input_.writer(); }
     const Writer &writer() const { return input_.writer(); }
 
-    // 访问输入流读取器，但仅限于const（不能从外部读取）
+    // 访问输入流读取器，但仅限于const（不能从外部读取）；已发送、尚未确认的字节也还在流中
     const Reader &reader() const { return input_.reader(); }
 
 private:
-    ByteStream input_;        // 输入字节流
-    Wrap32 isn_;              // 初始序列号
-    uint64_t initial_RTO_ms_; // 初始重传超时
+    // 已发送但尚未确认的报文段，有效载荷仍在输入流中
+    struct Outstanding
+    {
+        uint64_t absseq{};    // 起始绝对序列号
+        uint64_t sent_ms{};   // 首次发送的时间，用于采样RTT
+        uint64_t xmit_ms{};   // 最近一次发送的时间，RACK 按它判定丢失
+        uint32_t length{};    // 有效载荷的字节数
+        bool SYN{};           // 是否带有 SYN
+        bool FIN{};           // 是否带有 FIN
+        bool retransmitted{}; // 是否重传过；按 Karn 算法，重传过的报文段不产生RTT样本
+        bool sacked{};        // 接收方已通过 SACK 报告收到
+        bool lost{};          // 判定为丢失：其后至少有 DUP_ACK_THRESHOLD 个报文段被 SACK，或发生了超时
+        bool repaired{};      // 判定丢失后（本轮恢复或超时后）已经重传过
+
+        uint64_t sequence_length() const { return SYN + length + FIN; }
+        uint64_t stream_index() const { return absseq + SYN - 1; } // 有效载荷第一个字节的流索引
+    };
+
+    ByteStream input_; // 输入字节流
+    Wrap32 isn_;       // 初始序列号
 
-    RetransmissionTimer timer_;        // 重传计时器
+    RetransmissionTimer timer_;        // 重传超时
+    WheelRef timers_;                  // 本连接的定时器，也是当前时间
+    TimerWheel::TimerId rto_timer_{};  // 重传计时器
     bool SYN_flag_{};                  // SYN标志
     bool FIN_flag_{};                  // FIN标志
     uint64_t total_outstandings_{};    // 总未完成的段数
     uint64_t total_retransmissions_{}; // 总重传次数
 
-    uint16_t wdsize_{1};                   // 窗口大小
+    uint32_t wdsize_{1};                   // 窗口大小（已按窗口扩大选项还原）
     uint64_t next_absseq_{};               // 下一个绝对序列号
     uint64_t ack_absseq_{};                // 确认的绝对序列号
-    std::queue<TCPSenderMessage> qmesg_{}; // 消息队列，存储待发送的TCP段
+    std::deque<Outstanding> qmesg_{};      // 已发送未确认的TCP段的记录，同时作为 SACK 记分板，只记录序列号范围
+    uint64_t bytes_sent_{};                // 已发出的输入流字节数
+
+    // 已发送的字节留在输入流中直到被确认，(重)传时从流中切出有效载荷；输入流的容量因此也包括在途的数据
+    uint64_t unsent_bytes() const { return reader().bytes_buffered() - (bytes_sent_ - reader().bytes_popped()); }
+    // 已确认流索引 index 之前的数据，从输入流中弹出
+    void release(uint64_t index) { input_.reader().pop(index - reader().bytes_popped()); }
+
+    std::unique_ptr<CongestionControl> cc_; // 拥塞控制算法，push 时在途数量不超过它的拥塞窗口
+    Pacer pacer_;                           // 新数据的发送节奏
+    uint64_t pace_ms_{};                    // 上次积累令牌的时间
+    TimerWheel::TimerId pace_timer_{};      // 发送节奏推迟了新数据时，到期后积累的令牌足够发送
+
+    // 由拥塞窗口、接收窗口和 SRTT 估计发送速率：慢启动阶段为每个往返一个窗口的 2 倍，之后为 1.25 倍
+    void update_pacing_rate();
+
+    // 快速重传与 NewReno 快速恢复（RFC 5681 3.2、RFC 6582）
+    static constexpr uint64_t DUP_ACK_THRESHOLD = 3;
+    uint64_t dup_acks_{};       // 连续收到的重复确认数
+    bool in_recovery_{};        // 是否处于快速恢复阶段
+    uint64_t recover_absseq_{}; // 进入恢复时已发送的最高序列号，确认越过它才算恢复完成
+    uint64_t inflation_{};      // 恢复期间每个重复确认代表一个离开网络的报文段，允许额外发送的序列号数
+    bool retransmit_pending_{}; // 下一次 push 时立即重传队首的报文段
+
+    // SACK（RFC 2018）与基于记分板的丢失恢复（RFC 6675）
+    SynOptions syn_options_;    // SYN 中声明的选项
+
+    // 报文段长度：协商的 MSS，探测路径 MTU 时为已知能通过路径的长度
+    static constexpr uint64_t DEFAULT_PEER_MSS = 536; // 对方没有声明 MSS 时的默认值
+    uint64_t max_mss_;                                // 本端与对方声明的 MSS 中较小的一个
+    uint64_t mss_{};                                  // 新报文段的最大有效载荷
+    uint64_t option_length_{};                        // 报文段中接收方一侧的选项字节数
+    MtuProber prober_;                                // 路径 MTU 探测
+
+    // 更新报文段长度，同步给拥塞控制和发送节奏
+    void set_mss(uint64_t mss);
+    // 一个报文段的有效载荷上限：MSS 减去它携带的选项，SYN 还要减去 SYN 的选项
+    uint64_t max_payload(bool SYN) const;
+    bool sack_seen_{};          // 收到过有效的 SACK 块；此后恢复期间在途数据按记分板估计（pipe），不再用窗口膨胀
+
+    // RACK-TLP 丢失检测（RFC 8985）
+    static constexpr uint64_t WORST_CASE_DELAYED_ACK_MS = 200; // 只有一个报文段在途时，探测还要等过对方的延迟确认
+    bool rack_tlp_;                                 // 是否启用
+    RackState rack_{};                              // 最近送达的报文段
+    TimerWheel::TimerId reorder_timer_{};           // 重排序计时器：仍在重排序窗口内的报文段到期时再判定一次
+    TimerWheel::TimerId pto_timer_{};               // 尾部丢失探测（TLP）计时器
+    std::optional<uint64_t> tlp_end_absseq_{};      // 探测发出时的最高序列号，确认越过它之前不再探测
+
+    // 当前时间
+    uint64_t now_ms() const { return timers_.now_ms(); }
+    // 按当前 RTO 重新启动重传计时器
+    void restart_rto_timer();
+
+    // 快速恢复期间或超时后、确认越过恢复点之前，按记分板重传丢失的报文段并计算在途数据
+    bool scoreboard_active() const { return sack_seen_ && (in_recovery_ || ack_absseq_ < recover_absseq_); }
+
+    // 由输入流中的数据生成从 absseq 开始、有效载荷为 length 字节的报文段
+    TCPSenderMessage make_message(uint64_t absseq, bool SYN, uint64_t length, bool FIN) const;
+    // 重传一个在途的报文段
+    void retransmit(Outstanding &segment, const TransmitFunction &transmit);
+    // 重传队首的报文段
+    void retransmit_front(const TransmitFunction &transmit);
+    // 处理没有推进确认号的确认
+    void on_duplicate_ack();
+    // 进入快速恢复：拥塞控制减窗，下一次 push 时重传队首
+    void enter_recovery();
+    // 记分板上有判定丢失的报文段、且确认号已越过上次恢复点时进入快速恢复
+    void enter_recovery_if_lost(bool rack_lost);
+    // 按 RACK 判定丢失，返回是否有新判定丢失的报文段；还有报文段在重排序窗口内时设置重排序计时器
+    bool rack_detect_loss();
+    // 有数据在途时设置尾部丢失探测计时器：约 2 * SRTT，不晚于 RTO
+    void arm_loss_probe();
+    // 探测计时器到期：重传最后一个未被 SACK 的报文段，让对方的确认暴露尾部的丢失
+    void send_loss_probe(const TransmitFunction &transmit);
+    // 用 SACK 块标记已收到的报文段，并重新判定丢失
+    void update_scoreboard(const std::vector<SackBlock> &blocks);
+    // 估计仍在网络中的序列号数：未被 SACK 且未判定丢失的，加上已重传的
+    uint64_t pipe() const;
+    // 拥塞窗口还允许发送的序列号数
+    uint64_t congestion_room() const;
+    // 在拥塞窗口内重传判定丢失的报文段；any_unsacked 时也重传最高的被 SACK 的报文段之前其他未被 SACK 的报文段
+    // （RFC 6675 NextSeg 规则 3）
+    void retransmit_lost(const TransmitFunction &transmit, bool any_unsacked);
 };
 
 #endif
@@ -0,0 +1,168 @@
+#include <iostream>                   // 引入输入输出流库，用于标准输入输出
+#include <random>                     // 引入随机数库，用于生成随机的申请大小
+#include <thread>                     // 引入线程库，用于多线程测试
+#include <vector>                     // 引入向量库
+#include <stdexcept>                  // 引入标准异常类
+#include "buffer_pool.h"              // 引入 BufferPool 类的定义
+#include "byte_stream.h"              // 引入 ByteStream 类的定义
+#include "byte_stream_test_harness.h" // 引入 expect() 等测试工具
+#include "reassembler.h"              // 引入 Reassembler 类的定义
+using namespace std;
+
+// ByteStream 的存储从池中借出，析构时归还，再次构造时命中空闲块
+void byte_stream_test()
+{
+    const string name = "pool backs ByteStream";
+    BufferPool &pool = BufferPool::global();
+    const auto before = pool.stats();
+    {
+        ByteStream stream{64000};
+        expect(pool.stats().bytes_outstanding == before.bytes_outstanding + 65536, name, "64 KB chunk outstanding");
+        ByteStream small{15};
+        expect(pool.stats().bytes_outstanding == before.bytes_outstanding + 65536 + 256, name, "256 B chunk outstanding");
+    }
+    expect(pool.stats().bytes_outstanding == before.bytes_outstanding, name, "chunks returned on destruction");
+
+    const auto again = pool.stats();
+    {
+        ByteStream stream{64000};
+        expect(pool.stats().hits == again.hits + 1, name, "reused chunk counts as a hit");
+        expect(pool.stats().misses == again.misses, name, "reused chunk is not a miss");
+
+        ByteStream copy = stream;
+        copy.writer().push("abc");
+        expect(stream.reader().bytes_buffered() == 0, name, "copy owns separate storage");
+        expect(pool.stats().bytes_outstanding == before.bytes_outstanding + 2 * 65536, name, "copy draws its own chunk");
+    }
+    expect(pool.stats().bytes_outstanding == before.bytes_outstanding, name, "copies returned on destruction");
+}
+
+// Reassembler 的乱序区间从池中借出，按区间大小取最小的 2 的幂规格，组装完成后归还
+void reassembler_test()
+{
+    const string name = "pool backs Reassembler intervals";
+    BufferPool &pool = BufferPool::global();
+    Reassembler reassembler{ByteStream{4000}};
+    const auto before = pool.stats();
+
+    reassembler.insert(100, string(100, 'b'), false);
+    reassembler.insert(300, string(3000, 'd'), true);
+    expect(reassembler.bytes_pending() == 3100, name, "bytes pending");
+    expect(pool.stats().bytes_outstanding == before.bytes_outstanding + 256 + 4096, name, "intervals use the smallest fitting class");
+
+    reassembler.insert(0, string(100, 'a'), false);
+    expect(reassembler.reader().bytes_buffered() == 200 && reassembler.bytes_pending() == 3000, name, "assembled up to the gap");
+    reassembler.insert(200, string(100, 'c'), true);
+    expect(reassembler.reader().bytes_buffered() == 3300 && reassembler.bytes_pending() == 0, name, "assembled");
+    expect(reassembler.writer().is_closed(), name, "closed");
+    expect(pool.stats().bytes_outstanding == before.bytes_outstanding, name, "intervals returned after assembly");
+}
+
+// 超过最大规格的申请直接交给系统，计为未命中
+void oversize_test()
+{
+    const string name = "oversize allocation";
+    BufferPool &pool = BufferPool::global();
+    const auto before = pool.stats();
+    char *big = pool.allocate(100000);
+    expect(pool.stats().misses == before.misses + 1, name, "counted as a miss");
+    expect(pool.stats().bytes_outstanding == before.bytes_outstanding + 100000, name, "exact size outstanding");
+    pool.deallocate(big, 100000);
+    expect(pool.stats().bytes_outstanding == before.bytes_outstanding, name, "returned");
+    expect(pool.allocate(0) == nullptr, name, "zero-sized allocation");
+}
+
+// 一个线程借出又归还数百个块后，新映射的 slab 交还系统，每个规格至多留下一个
+void slab_release_test()
+{
+    const string name = "empty slabs released";
+    BufferPool &pool = BufferPool::global();
+    const auto before = pool.stats();
+    uint64_t peak = 0;
+
+    thread worker(
+        [&]
+        {
+            vector<char *> chunks;
+            for (size_t i = 0; i < 1000; ++i)
+            {
+                chunks.push_back(pool.allocate(300));
+            }
+            peak = pool.stats().bytes_reserved;
+            for (char *p : chunks)
+            {
+                pool.deallocate(p, 300);
+            }
+        });
+    worker.join(); // 线程退出时本地缓存也归还全局
+
+    expect(peak >= before.bytes_reserved + 7 * 65536, name, "1000 chunks of 512 B need at least 7 new slabs");
+    expect(pool.stats().bytes_reserved <= before.bytes_reserved + 65536, name, "at most one new slab kept after all chunks returned");
+    expect(pool.stats().bytes_outstanding == before.bytes_outstanding, name, "all bytes returned");
+}
+
+// 多个线程并发申请和释放（包括在一个线程申请、另一个线程释放），结束后借出字节数回到原值
+void multi_thread_test()
+{
+    const string name = "concurrent allocation";
+    BufferPool &pool = BufferPool::global();
+    const auto before = pool.stats();
+
+    vector<thread> threads;
+    vector<vector<pair<char *, size_t>>> leftovers(4);
+    for (size_t t = 0; t < 4; ++t)
+    {
+        threads.emplace_back([&, t]
+                             {
+                                 default_random_engine rd{t};
+                                 uniform_int_distribution<size_t> size_dist{1, 70000};
+                                 vector<pair<char *, size_t>> live;
+                                 for (size_t i = 0; i < 20000; ++i)
+                                 {
+                                     if (live.empty() || rd() % 2 == 0)
+                                     {
+                                         const size_t size = size_dist(rd) % 3 == 0 ? size_dist(rd) : size_dist(rd) % 2048 + 1;
+                                         char *p = pool.allocate(size);
+                                         p[0] = p[size - 1] = static_cast<char>(i); // 确认整个区间可写
+                                         live.emplace_back(p, size);
+                                     }
+                                     else
+                                     {
+                                         pool.deallocate(live.back().first, live.back().second);
+                                         live.pop_back();
+                                     }
+                                 }
+                                 leftovers[t] = move(live);
+                             });
+    }
+    for (auto &th : threads)
+    {
+        th.join();
+    }
+    for (auto &live : leftovers)
+    {
+        for (auto [p, size] : live)
+        {
+            pool.deallocate(p, size);
+        }
+    }
+    expect(pool.stats().bytes_outstanding == before.bytes_outstanding, name, "all bytes returned");
+}
+
+int main()
+{
+    try
+    {
+        byte_stream_test();
+        reassembler_test();
+        oversize_test();
+        slab_release_test();
+        multi_thread_test();
+    }
+    catch (const exception &e)
+    {
+        cerr << "Exception: " << e.what() << endl;
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}
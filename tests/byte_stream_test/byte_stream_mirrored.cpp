@@ -0,0 +1,80 @@
+#include <iostream>
+#include <exception>
+#include <random>
+#include "byte_stream.h"
+#include "byte_stream_test_harness.h"
+using namespace std;
+
+int main()
+{
+    try
+    {
+        const string a(3000, 'a');
+        const string b(3000, 'b');
+
+        {
+            ByteStreamTestHarness test{"mirrored: peek spans the wrap point", 4096, ByteStream::Storage::Mirrored};
+
+            test.execute(Push{a});
+            test.execute(Pop{2500});
+            test.execute(AvailableCapacity{3596});
+            test.execute(Push{b});
+
+            // 写入跨越了环的末尾，但 peek() 仍应一次返回所有缓冲的字节
+            test.execute(BytesBuffered{3500});
+            test.execute(PeekOnce{a.substr(2500) + b});
+
+            test.execute(Pop{500});
+            test.execute(PeekOnce{b});
+            test.execute(Close{});
+            test.execute(ReadAll{b});
+            test.execute(IsFinished{true});
+        }
+
+        {
+            ByteStreamTestHarness test{"mirrored: capacity is not page aligned", 5000, ByteStream::Storage::Mirrored};
+
+            test.execute(Push{a + b});
+            test.execute(BytesPushed{5000});
+            test.execute(AvailableCapacity{0});
+            test.execute(Pop{4000});
+            test.execute(Push{a});
+            test.execute(BytesBuffered{4000});
+            test.execute(PeekOnce{(a + b).substr(4000, 1000) + a});
+        }
+
+        {
+            // 随机读写，双重映射下 peek() 的长度应始终等于缓冲的字节数
+            default_random_engine rd{4096};
+            string data(100000, 0);
+            for (auto &c : data)
+            {
+                c = uniform_int_distribution<char>{}(rd);
+            }
+
+            ByteStreamTestHarness test{"mirrored: random push/pop", 4096, ByteStream::Storage::Mirrored};
+            size_t pushed = 0;
+            size_t popped = 0;
+            while (popped < data.size())
+            {
+                const size_t to_push = min(uniform_int_distribution<size_t>{0, 4096}(rd), data.size() - pushed);
+                const size_t accepted = min(to_push, 4096 - (pushed - popped));
+                test.execute(Push{data.substr(pushed, to_push)});
+                pushed += accepted;
+
+                test.execute(PeekOnce{data.substr(popped, pushed - popped)});
+
+                const size_t to_pop = uniform_int_distribution<size_t>{0, pushed - popped}(rd);
+                test.execute(Pop{to_pop});
+                popped += to_pop;
+                test.execute(BytesPopped{popped});
+            }
+        }
+    }
+    catch (const exception &e)
+    {
+        cerr << "Exception: " << e.what() << endl;
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,64 @@
+#include <iostream>
+#include <exception>
+#include "byte_stream.h"
+#include "byte_stream_test_harness.h"
+using namespace std;
+
+int main()
+{
+    try
+    {
+        {
+            ByteStreamTestHarness test{"peek_iov on empty and contiguous stream", 15};
+
+            test.execute(PeekIov{{}});
+            test.execute(Push{"cat"});
+            test.execute(PeekIov{{"cat"}});
+            test.execute(PeekIov{{"ca"}, 2});
+        }
+
+        {
+            ByteStreamTestHarness test{"peek_iov across the wrap point", 8};
+
+            test.execute(Push{"abcdef"});
+            test.execute(Pop{5});
+            test.execute(Push{"ghijklm"});
+            test.execute(BytesBuffered{8});
+
+            // peek() 只返回到环末尾的部分，peek_iov() 同时返回折回的部分
+            test.execute(PeekOnce{"fgh"});
+            test.execute(PeekIov{{"fgh", "ijklm"}});
+            test.execute(PeekIov{{"fgh", "i"}, 4});
+            test.execute(PeekIov{{"fg"}, 2});
+
+            // peek_range() 从读位置之后的任意偏移开始，同样分为到环末尾的部分和折回的部分
+            test.execute(PeekRange{1, 5, "gh", "ijk"});
+            test.execute(PeekRange{3, 2, "ij"});
+            test.execute(PeekRange{6, 100, "lm"});
+            test.execute(PeekRange{8, 1, ""});
+            test.execute(BytesBuffered{8});
+
+            test.execute(Pop{4});
+            test.execute(PeekIov{{"jklm"}});
+            test.execute(ReadAll{"jklm"});
+        }
+
+        {
+            ByteStreamTestHarness test{"peek_iov mirrored", 4096, ByteStream::Storage::Mirrored};
+            const string a(3000, 'a');
+            const string b(3000, 'b');
+
+            test.execute(Push{a});
+            test.execute(Pop{2500});
+            test.execute(Push{b});
+            test.execute(PeekIov{{a.substr(2500) + b}});
+            test.execute(PeekRange{400, 200, a.substr(2900) + b.substr(0, 100)});
+        }
+    }
+    catch (const exception &e)
+    {
+        cerr << "Exception: " << e.what() << endl;
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}
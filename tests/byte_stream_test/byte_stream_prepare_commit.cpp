@@ -0,0 +1,89 @@
+#include <iostream>
+#include <exception>
+#include "byte_stream.h"
+#include "byte_stream_test_harness.h"
+using namespace std;
+
+int main()
+{
+    try
+    {
+        {
+            ByteStreamTestHarness test{"prepare-commit", 15};
+
+            test.execute(Prepared{100, 15});
+            test.execute(PrepareCommit{"cat"});
+            test.execute(BytesPushed{3});
+            test.execute(AvailableCapacity{12});
+            test.execute(Peek{"cat"});
+
+            test.execute(PrepareCommit{"tac"});
+            test.execute(BytesBuffered{6});
+            test.execute(Peek{"cattac"});
+
+            test.execute(Pop{6});
+            test.execute(Close{});
+            test.execute(Prepared{100, 0});
+            test.execute(IsFinished{true});
+        }
+
+        {
+            ByteStreamTestHarness test{"prepare-commit wraps around", 8};
+
+            test.execute(Push{"abcdef"});
+            test.execute(Pop{5});
+            test.execute(Prepared{100, 7});
+            test.execute(PrepareCommit{"ghijklmn"});
+            test.execute(BytesPushed{13});
+            test.execute(AvailableCapacity{0});
+            test.execute(Peek{"fghijklm"});
+            test.execute(ReadAll{"fghijklm"});
+        }
+
+        {
+            ByteStreamTestHarness test{"partial commit", 10};
+
+            test.execute(PrepareCommit{"hello"}.with_commit(2));
+            test.execute(BytesPushed{2});
+            test.execute(BytesBuffered{2});
+            test.execute(AvailableCapacity{8});
+            test.execute(Peek{"he"});
+
+            test.execute(PrepareCommit{"world"}.with_commit(0));
+            test.execute(BytesPushed{2});
+            test.execute(Peek{"he"});
+
+            test.execute(PrepareCommit{"llo"});
+            test.execute(ReadAll{"hello"});
+        }
+
+        {
+            ByteStreamTestHarness test{"prepare-commit after close", 10};
+
+            test.execute(PrepareCommit{"abc"});
+            test.execute(Close{});
+            test.execute(PrepareCommit{"def"}.with_commit(3));
+            test.execute(BytesPushed{3});
+            test.execute(ReadAll{"abc"});
+            test.execute(IsFinished{true});
+        }
+
+        {
+            ByteStreamTestHarness test{"prepare-commit mirrored", 4096, ByteStream::Storage::Mirrored};
+            const string a(3000, 'a');
+            const string b(2000, 'b');
+
+            test.execute(PrepareCommit{a});
+            test.execute(Pop{2000});
+            test.execute(Prepared{4096, 3096});
+            test.execute(PrepareCommit{b});
+            test.execute(PeekOnce{a.substr(2000) + b});
+        }
+    }
+    catch (const exception &e)
+    {
+        cerr << "Exception: " << e.what() << endl;
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}
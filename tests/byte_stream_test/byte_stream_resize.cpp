@@ -0,0 +1,125 @@
+#include <iostream>
+#include <exception>
+#include <random>
+#include "byte_stream.h"
+#include "byte_stream_test_harness.h"
+using namespace std;
+
+int main()
+{
+    try
+    {
+        for (const auto storage : {ByteStream::Storage::Heap, ByteStream::Storage::Mirrored})
+        {
+            const string mode = storage == ByteStream::Storage::Mirrored ? "mirrored" : "heap";
+            const string a(3000, 'a');
+            const string b(3000, 'b');
+
+            {
+                ByteStreamTestHarness test{mode + ": grow with wrapped data", 4096, storage};
+
+                test.execute(Push{a});
+                test.execute(Pop{2500});
+                test.execute(Push{b});
+
+                // 缓冲的数据跨越了环的末尾，扩大容量后顺序不变
+                test.execute(SetCapacity{10000});
+                test.execute(BytesBuffered{3500});
+                test.execute(AvailableCapacity{6500});
+                test.execute(Peek{a.substr(2500) + b});
+
+                test.execute(Push{a + b});
+                test.execute(BytesBuffered{9500});
+                test.execute(AvailableCapacity{500});
+                test.execute(Close{});
+                test.execute(ReadAll{a.substr(2500) + b + a + b});
+                test.execute(BytesPushed{12000});
+                test.execute(IsFinished{true});
+            }
+
+            {
+                ByteStreamTestHarness test{mode + ": shrink", 10000, storage};
+
+                test.execute(Push{a + b});
+                test.execute(Pop{5000});
+
+                // 缩小时不会丢弃已缓冲的数据
+                test.execute(SetCapacity{500});
+                test.execute(BytesBuffered{1000});
+                test.execute(AvailableCapacity{0});
+                test.execute(Push{"x"});
+                test.execute(BytesPushed{6000});
+
+                test.execute(Pop{800});
+                test.execute(AvailableCapacity{800});
+                test.execute(Push{a.substr(0, 800)});
+                test.execute(ReadAll{b.substr(2800) + a.substr(0, 800)});
+
+                test.execute(SetCapacity{100});
+                test.execute(AvailableCapacity{100});
+                test.execute(Push{a});
+                test.execute(ReadAll{a.substr(0, 100)});
+                test.execute(BytesPopped{6900});
+            }
+
+            {
+                ByteStreamTestHarness test{mode + ": prepared bytes survive a resize", 8, storage};
+
+                // 尚未提交的可写区间中的内容在扩大后仍然位于写位置之后
+                test.execute(Push{"abcdef"});
+                test.execute(Pop{5});
+                test.execute(PrepareCommit{"ghi"}.with_commit(0));
+                test.execute(SetCapacity{64});
+                test.execute(Prepared{3, 3});
+                test.execute(PrepareCommit{""}.with_commit(3));
+                test.execute(BytesBuffered{4});
+                test.execute(ReadAll{"fghi"});
+            }
+
+            {
+                // 随机读写并随机调整容量，与 std::string 对照
+                default_random_engine rd{static_cast<unsigned>(storage == ByteStream::Storage::Heap ? 1 : 2)};
+                string data(200000, 0);
+                for (auto &c : data)
+                {
+                    c = uniform_int_distribution<char>{}(rd);
+                }
+
+                ByteStreamTestHarness test{mode + ": random push/pop/resize", 1000, storage};
+                uint64_t capacity = 1000;
+                size_t pushed = 0;
+                size_t popped = 0;
+                while (popped < data.size())
+                {
+                    const uint64_t buffered = pushed - popped;
+                    const size_t to_push = min<size_t>(uniform_int_distribution<size_t>{0, 3000}(rd), data.size() - pushed);
+                    const size_t accepted = min<size_t>(to_push, capacity - buffered);
+                    test.execute(Push{data.substr(pushed, to_push)});
+                    pushed += accepted;
+
+                    const size_t to_pop = uniform_int_distribution<size_t>{0, pushed - popped}(rd);
+                    test.execute(Peek{data.substr(popped, pushed - popped)});
+                    test.execute(Pop{to_pop});
+                    popped += to_pop;
+
+                    if (rd() % 4 == 0)
+                    {
+                        const uint64_t requested = uniform_int_distribution<uint64_t>{0, 9000}(rd) + 1;
+                        test.execute(SetCapacity{requested});
+                        capacity = max<uint64_t>(requested, pushed - popped);
+                    }
+                    test.execute(AvailableCapacity{capacity - (pushed - popped)});
+                }
+                test.execute(Close{});
+                test.execute(ReadAll{data.substr(popped)});
+            }
+        }
+    }
+    catch (const exception &e)
+    {
+        cerr << "Exception: " << e.what() << endl;
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
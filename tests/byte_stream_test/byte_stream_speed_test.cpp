@@ -1,4 +1,5 @@
 #include <iostream>      // 引入输入输出流库，用于标准输入输出
+#include <array>         // 引入数组库，用于保存扫描参数
 #include <queue>         // 引入队列库，用于存储分段数据
 #include <random>        // 引入随机数库，用于生成随机数据
 #include <chrono>        // 引入时间库，用于测量时间
@@ -15,7 +16,8 @@ void speed_test(const size_t input_len,   // 输入数据的长度
                 const size_t capacity,    // ByteStream的容量
                 const size_t random_seed, // 随机数种子
                 const size_t write_size,  // 每次写入的大小
-                const size_t read_size)   // 每次读取的大小
+                const size_t read_size,   // 每次读取的大小
+                const ByteStream::Storage storage = ByteStream::Storage::Heap) // 底层存储模式
 {
     // 生成要写入的数据
     const string data = [&random_seed, &input_len]
@@ -37,7 +39,7 @@ void speed_test(const size_t input_len,   // 输入数据的长度
         split_data.emplace(data.substr(i, write_size)); // 将分割的数据段添加到队列中
     }
 
-    ByteStream bs{capacity};          // 创建一个ByteStream对象，指定容量
+    ByteStream bs{capacity, storage}; // 创建一个ByteStream对象，指定容量和存储模式
     string output_data;               // 用于存储读取的数据
     output_data.reserve(data.size()); // 预留空间以提高性能
 
@@ -92,7 +94,8 @@ void speed_test(const size_t input_len,   // 输入数据的长度
     debug_output.open("/dev/tty"); // 打开终端设备
 
     // 输出测试结果
-    cout << "ByteStream with capacity=" << capacity << ", write_size=" << write_size
+    cout << "ByteStream with capacity=" << capacity << (storage == ByteStream::Storage::Mirrored ? " (mirrored)" : "")
+         << ", write_size=" << write_size
          << ", read_size=" << read_size << " reached " << fixed << setprecision(2)
          << gigabits_per_second << " Gbit/s.\n";
 
@@ -109,7 +112,17 @@ void speed_test(const size_t input_len,   // 输入数据的长度
 // program_body函数用于执行速度测试
 void program_body()
 {
-    speed_test(1e7, 32768, 789, 1500, 128); // 调用speed_test函数，传入参数
+    // 扫描不同的写入/读取粒度，覆盖小块、MTU 大小和大块三种典型负载
+    constexpr array<size_t, 3> write_sizes{128, 1500, 8192};
+    constexpr array<size_t, 3> read_sizes{128, 1500, 8192};
+    for (const size_t write_size : write_sizes)
+    {
+        for (const size_t read_size : read_sizes)
+        {
+            speed_test(1e7, 32768, 789, write_size, read_size); // 调用speed_test函数，传入参数
+            speed_test(1e7, 32768, 789, write_size, read_size, ByteStream::Storage::Mirrored);
+        }
+    }
 }
 
 int main()
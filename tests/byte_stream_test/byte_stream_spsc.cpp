@@ -0,0 +1,106 @@
+#include <iostream>                   // 引入输入输出流库，用于标准输入输出
+#include <random>                     // 引入随机数库，用于生成随机数据
+#include <thread>                     // 引入线程库，用于生产者线程
+#include <stdexcept>                  // 引入标准异常类
+#include "byte_stream_test_harness.h" // 引入 expect() 等测试工具
+#include "spsc_byte_stream.h"         // 引入 SPSCByteStream 类的定义
+using namespace std;
+
+// 单线程下的基本语义：容量、环绕、关闭，以及只在空/满转换时触发唤醒
+void basic_test()
+{
+    const string name = "spsc basics";
+    SPSCByteStream stream{8};
+
+    expect(stream.readable_event().drain() == 0, name, "no wakeup before any push");
+    expect(stream.push("hello") == 5, name, "push within capacity");
+    expect(stream.readable_event().drain() == 1, name, "push into empty stream wakes consumer");
+    expect(stream.push("world") == 3, name, "push truncated to capacity");
+    expect(stream.readable_event().drain() == 0, name, "push into non-empty stream does not wake consumer");
+    expect(stream.available_capacity() == 0 && stream.bytes_buffered() == 8, name, "stream full");
+
+    string out(6, '\0');
+    expect(stream.read(out) == 6 && out == "hellow", name, "read returns oldest bytes");
+    expect(stream.writable_event().drain() == 1, name, "pop from full stream wakes producer");
+
+    // 不折回时第二段为空
+    const auto contiguous = stream.peek_iov();
+    expect(contiguous[0] == "or" && contiguous[1].empty(), name, "peek_iov without wrapping");
+
+    // 写入位置此时环绕到缓冲区开头，peek_iov 应返回两段
+    expect(stream.push("!!!!") == 4, name, "push after pop");
+    const auto iov = stream.peek_iov();
+    expect(iov[0] == "or" && iov[1] == "!!!!", name, "peek_iov across the wrap point");
+    stream.pop(3);
+    expect(stream.writable_event().drain() == 0, name, "pop from non-full stream does not wake producer");
+
+    stream.close();
+    expect(stream.readable_event().drain() == 1, name, "close wakes consumer");
+    expect(stream.push("x") == 0, name, "push after close");
+    expect(!stream.is_finished(), name, "closed stream with buffered data is not finished");
+    stream.pop(3);
+    expect(stream.is_finished() && stream.bytes_popped() == 12 && stream.bytes_pushed() == 12, name, "finished after draining");
+}
+
+// 两个线程通过阻塞等待接口传输随机数据，检查内容和顺序
+void two_thread_test(const size_t input_len, const size_t capacity, const size_t random_seed)
+{
+    const string name = "spsc two threads input=" + to_string(input_len) + ", capacity=" + to_string(capacity);
+
+    default_random_engine rd{random_seed};
+    const string data = [&]
+    {
+        uniform_int_distribution<char> ud;
+        string ret;
+        for (size_t i = 0; i < input_len; ++i)
+        {
+            ret += ud(rd);
+        }
+        return ret;
+    }();
+
+    SPSCByteStream stream{capacity};
+
+    thread producer{[&, seed = random_seed + 1]
+                    {
+                        default_random_engine prd{seed};
+                        uniform_int_distribution<size_t> chunk{1, capacity * 2};
+                        for (size_t pushed = 0; pushed < data.size();)
+                        {
+                            stream.wait_writable();
+                            pushed += stream.push(string_view{data}.substr(pushed, chunk(prd)));
+                        }
+                        stream.close();
+                    }};
+
+    string received;
+    uniform_int_distribution<size_t> chunk{1, capacity * 2};
+    while (!stream.is_finished())
+    {
+        stream.wait_readable();
+        string buffer(chunk(rd), '\0');
+        buffer.resize(stream.read(buffer));
+        received += buffer;
+    }
+    producer.join();
+
+    expect(received == data, name, "mismatch between data written and read");
+    expect(stream.bytes_popped() == input_len, name, "bytes_popped");
+}
+
+int main()
+{
+    try
+    {
+        basic_test();
+        two_thread_test(1 << 14, 1, 137);
+        two_thread_test(1 << 20, 1000, 1370);
+        two_thread_test(1 << 22, 65536, 13700);
+    }
+    catch (const exception &e)
+    {
+        cerr << "Exception: " << e.what() << endl;
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}
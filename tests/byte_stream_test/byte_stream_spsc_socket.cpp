@@ -0,0 +1,137 @@
+#include <iostream>            // 引入输入输出流库，用于标准输入输出
+#include <random>              // 引入随机数库，用于生成随机数据
+#include <stdexcept>           // 引入标准异常类
+#include <string>              // 引入字符串库，用于保存传输的数据
+#include <sys/socket.h>        // 引入 socketpair
+#include <thread>              // 引入线程库，用于服务端
+#include "parser.h"            // 引入解析器，用于解析 IPv4 数据报
+#include "tcp_minnow_socket.h" // 引入 TCPMinnowSocket 的定义
+
+using namespace std; // 使用标准命名空间
+
+// 经由 Unix 域数据报套接字对交换 IPv4 数据报的适配器，两个 TCPMinnowSocket 在同一进程内直接相连
+class DatagramPairAdapter : public TCPOverIPv4Adapter
+{
+public:
+    explicit DatagramPairAdapter(FileDescriptor &&fd) : fd_(std::move(fd)) {}
+
+    // 读取一个数据报并解包其中的 TCP 消息
+    optional<TCPMessage> read()
+    {
+        string buffer;
+        fd_.read(buffer);
+        InternetDatagram dgram;
+        if (!parse(dgram, vector<string>{buffer}))
+        {
+            return {};
+        }
+        return unwrap_tcp_in_ip(dgram);
+    }
+
+    // 把 TCP 消息封装成一个数据报写出
+    void write(const TCPMessage &msg) { fd_.write(serialize(wrap_tcp_in_ip(msg))); }
+
+    // 获取底层文件描述符
+    FileDescriptor &fd() { return fd_; }
+
+private:
+    FileDescriptor fd_;
+};
+
+using PairSocket = TCPMinnowSocket<DatagramPairAdapter>;
+
+// 通过应用数据接口写出全部数据，然后关闭写方向
+void write_all(PairSocket &socket, string_view data)
+{
+    size_t written = 0;
+    while (written < data.size())
+    {
+        written += socket.app_write(data.substr(written));
+        if (written < data.size())
+        {
+            socket.app_wait_writable();
+        }
+    }
+    socket.app_shutdown(SHUT_WR);
+}
+
+// 通过应用数据接口读到 EOF
+string read_all(PairSocket &socket)
+{
+    string received;
+    while (true)
+    {
+        string buffer;
+        socket.app_read(buffer);
+        if (!buffer.empty())
+        {
+            received += buffer;
+        }
+        else if (socket.eof())
+        {
+            return received;
+        }
+        else
+        {
+            socket.app_wait_readable();
+        }
+    }
+}
+
+// SharedMemory 模式下两个套接字端到端传输 2 MB：客户端发给服务端，服务端原样发回
+int main()
+{
+    try
+    {
+        string data(2 * 1024 * 1024, 0);
+        default_random_engine rd{5};
+        for (auto &c : data)
+        {
+            c = static_cast<char>(rd());
+        }
+
+        array<int, 2> fds{};
+        CheckSystemCall("socketpair", ::socketpair(AF_UNIX, SOCK_DGRAM, 0, fds.data()));
+        PairSocket client{DatagramPairAdapter{FileDescriptor{fds[0]}}, TCPMinnowTransport::SharedMemory};
+        PairSocket server{DatagramPairAdapter{FileDescriptor{fds[1]}}, TCPMinnowTransport::SharedMemory};
+
+        TCPConfig cfg;
+        cfg.rt_timeout = 50; // 主动关闭的一方等待 10 个 RTO，缩短测试时间
+        FdAdapterConfig client_ad;
+        client_ad.source = Address{"10.0.0.2", 5000};
+        client_ad.destination = Address{"10.0.0.1", 80};
+        FdAdapterConfig server_ad;
+        server_ad.source = client_ad.destination;
+
+        string echoed_by_server;
+        thread server_thread(
+            [&]
+            {
+                server.listen_and_accept(cfg, server_ad);
+                echoed_by_server = read_all(server);
+                write_all(server, echoed_by_server);
+                server.wait_until_closed();
+            });
+
+        client.connect(cfg, client_ad);
+        write_all(client, data);
+        const string echoed = read_all(client);
+        client.wait_until_closed();
+        server_thread.join();
+
+        if (echoed_by_server != data)
+        {
+            throw runtime_error("server received " + to_string(echoed_by_server.size()) + " bytes that differ from the " + to_string(data.size()) + " sent");
+        }
+        if (echoed != data)
+        {
+            throw runtime_error("client received " + to_string(echoed.size()) + " bytes that differ from the echoed data");
+        }
+    }
+    catch (const exception &e)
+    {
+        cerr << "Exception: " << e.what() << endl;
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}
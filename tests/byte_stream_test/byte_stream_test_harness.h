@@ -4,6 +4,9 @@
 #include <utility>                    // 引入实用工具库，提供 std::move 等功能
 #include <concepts>                   // 引入概念库，用于类型约束
 #include <optional>                   // 引入可选库，提供 std::optional 类型
+#include <algorithm>                  // 引入算法库，提供 std::copy_n
+#include <stdexcept>                  // 引入标准异常类，expect() 失败时抛出
+#include <string>                     // 引入字符串库
 #include "common.h"                   // 引入通用头文件，包含一些常用的定义
 #include "byte_stream.h"              // 引入自定义的 ByteStream 类头文件
 
@@ -19,8 +22,10 @@ class ByteStreamTestHarness : public TestHarness<ByteStream>
 {
 public:
     // 构造函数，初始化测试工具
-    ByteStreamTestHarness(std::string test_name, uint64_t capacity)
-        : TestHarness(move(test_name), "capacity=" + std::to_string(capacity), ByteStream{capacity})
+    ByteStreamTestHarness(std::string test_name, uint64_t capacity, ByteStream::Storage storage = ByteStream::Storage::Heap)
+        : TestHarness(move(test_name),
+                      "capacity=" + std::to_string(capacity) + (storage == ByteStream::Storage::Mirrored ? ", mirrored" : ""),
+                      ByteStream{capacity, storage})
     {
     }
 
@@ -38,6 +43,61 @@ struct Push : public Action<ByteStream>
     void execute(ByteStream &bs) const override { bs.writer().push(data_); } // 执行推送操作
 };
 
+// PrepareCommit 操作，通过 prepare()/commit() 直接向流的存储写入数据
+struct PrepareCommit : public Action<ByteStream>
+{
+    std::string data_;                     // 要写入的数据
+    std::optional<uint64_t> commit_len_{}; // 实际提交的字节数，默认提交全部已写入的字节
+
+    explicit PrepareCommit(std::string data) : data_(move(data)) {} // 构造函数
+
+    // 设置只提交前 n 个字节
+    PrepareCommit &with_commit(uint64_t n)
+    {
+        commit_len_ = n;
+        return *this;
+    }
+
+    std::string description() const override
+    {
+        std::string desc = "prepare/commit \"" + Printer::prettify(data_) + "\"";
+        if (commit_len_.has_value())
+        {
+            desc += " (commit " + std::to_string(commit_len_.value()) + ")";
+        }
+        return desc;
+    }
+
+    void execute(ByteStream &bs) const override
+    {
+        uint64_t written = 0;
+        for (const auto span : bs.writer().prepare(data_.size()))
+        {
+            std::copy_n(data_.begin() + static_cast<std::ptrdiff_t>(written), span.size(), span.begin());
+            written += span.size();
+        }
+        if (written > data_.size())
+        {
+            throw ExpectationViolation{"Writer::prepare() returned more space than requested"};
+        }
+        bs.writer().commit(commit_len_.value_or(written)); // 提交写入的字节
+    }
+};
+
+// Prepared 期望，验证 prepare(n) 返回的可写空间总大小
+struct Prepared : public ExpectNumber<ByteStream, uint64_t>
+{
+    uint64_t request_; // 请求的字节数
+
+    Prepared(uint64_t request, uint64_t expected) : ExpectNumber(expected), request_(request) {} // 构造函数
+    std::string name() const override { return "prepare(" + std::to_string(request_) + ") size"; }
+    uint64_t value(ByteStream &bs) const override
+    {
+        const auto spans = bs.writer().prepare(request_);
+        return spans[0].size() + spans[1].size(); // 返回可写空间的总大小
+    }
+};
+
 // Close 操作，用于关闭 ByteStream 的写入器
 struct Close : public Action<ByteStream>
 {
@@ -45,6 +105,16 @@ struct Close : public Action<ByteStream>
     void execute(ByteStream &bs) const override { bs.writer().close(); } // 执行关闭操作
 };
 
+// SetCapacity 操作，在运行时调整 ByteStream 的容量
+struct SetCapacity : public Action<ByteStream>
+{
+    uint64_t capacity_; // 新的容量
+
+    explicit SetCapacity(uint64_t capacity) : capacity_(capacity) {} // 构造函数
+    std::string description() const override { return "set capacity to " + std::to_string(capacity_); }
+    void execute(ByteStream &bs) const override { bs.writer().set_capacity(capacity_); } // 执行调整容量操作
+};
+
 // SetError 操作，用于设置 ByteStream 的错误状态
 struct SetError : public Action<ByteStream>
 {
@@ -118,6 +188,71 @@ struct PeekOnce : public Peek
     }
 };
 
+// PeekIov 期望，验证 peek_iov() 返回的数据段；没有列出的段应为空
+struct PeekIov : public Expectation<ByteStream>
+{
+    std::vector<std::string> segments_; // 期望的非空数据段
+    uint64_t max_bytes_;                // 最大字节数
+
+    explicit PeekIov(std::vector<std::string> segments, uint64_t max_bytes = UINT64_MAX)
+        : segments_(move(segments)), max_bytes_(max_bytes)
+    {
+    }
+
+    std::string description() const override
+    {
+        std::string desc = "peek_iov(" + (max_bytes_ == UINT64_MAX ? std::string{"all"} : std::to_string(max_bytes_)) + ") gives {";
+        for (const auto &seg : segments_)
+        {
+            desc += " \"" + Printer::prettify(seg) + "\"";
+        }
+        return desc + " }";
+    }
+
+    void execute(ByteStream &bs) const override
+    {
+        const auto got = bs.reader().peek_iov(max_bytes_);
+        for (size_t i = 0; i < got.size(); ++i)
+        {
+            const std::string expected = i < segments_.size() ? segments_[i] : std::string{};
+            if (got[i] != expected)
+            {
+                throw ExpectationViolation{"Expected segment \"" + Printer::prettify(expected) + "\" from peek_iov(), but found \"" + Printer::prettify(got[i]) + "\""};
+            }
+        }
+    }
+};
+
+// PeekRange 期望，验证 peek_range() 不弹出数据、返回的两段数据
+struct PeekRange : public Expectation<ByteStream>
+{
+    uint64_t offset_;         // 读位置之后的偏移
+    uint64_t len_;            // 最大字节数
+    std::string first_;       // 期望的第一段
+    std::string second_;      // 期望的第二段（折回的部分）
+
+    PeekRange(uint64_t offset, uint64_t len, std::string first, std::string second = {})
+        : offset_(offset), len_(len), first_(move(first)), second_(move(second))
+    {
+    }
+
+    std::string description() const override
+    {
+        return "peek_range(" + std::to_string(offset_) + ", " + std::to_string(len_) + ") gives { \"" + Printer::prettify(first_) + "\" \""
+               + Printer::prettify(second_) + "\" }";
+    }
+
+    void execute(ByteStream &bs) const override
+    {
+        const auto got = bs.reader().peek_range(offset_, len_);
+        if (got[0] != first_ || got[1] != second_)
+        {
+            throw ExpectationViolation{"Expected { \"" + Printer::prettify(first_) + "\" \"" + Printer::prettify(second_) + "\" } from peek_range(), but found { \""
+                                       + Printer::prettify(got[0]) + "\" \"" + Printer::prettify(got[1]) + "\" }"};
+        }
+    }
+};
+
 // IsClosed 期望，验证 ByteStream 的写入器是否关闭
 struct IsClosed : public ConstExpectBool<ByteStream>
 {
@@ -211,4 +346,13 @@ struct ReadAll : public Expectation<ByteStream>
     }
 };
 
+// 不经过 TestHarness 的测试（多线程、缓冲池等）检查条件，失败时抛出带有测试名称的异常
+inline void expect(bool condition, const std::string &test_name, const std::string &what)
+{
+    if (!condition)
+    {
+        throw std::runtime_error(test_name + ": " + what);
+    }
+}
+
 #endif
@@ -0,0 +1,74 @@
+#include <iostream>
+#include <array>
+#include <exception>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <sys/socket.h>
+#include "file_descriptor.h"
+using namespace std;
+
+// 一次 write() 给出的所有缓冲区都在同一次 writev 中写出：在保留消息边界的套接字上，
+// 超过栈上 iovec 数量的缓冲区也属于同一个数据报，不被截断
+int main()
+{
+    try
+    {
+        int fds[2];
+        if (::socketpair(AF_UNIX, SOCK_SEQPACKET, 0, fds) != 0)
+        {
+            throw runtime_error("socketpair failed");
+        }
+        FileDescriptor sender{fds[0]};
+        FileDescriptor receiver{fds[1]};
+
+        vector<string> pieces;
+        string expected;
+        for (size_t i = 0; i < 40; ++i)
+        {
+            pieces.push_back(string(i + 1, static_cast<char>('a' + i % 26)));
+            expected += pieces.back();
+        }
+        pieces.insert(pieces.begin() + 20, string{}); // 空缓冲区被跳过
+
+        if (sender.write(pieces) != expected.size())
+        {
+            throw runtime_error("write(vector<string>) did not write every buffer");
+        }
+        const vector<string_view> views(pieces.begin(), pieces.end());
+        if (sender.write(views) != expected.size())
+        {
+            throw runtime_error("write(vector<string_view>) did not write every buffer");
+        }
+
+        // Reader::peek_iov() 返回的两段（第二段可能为空）直接写出，不经过 vector
+        const array<string_view, 2> halves{string_view{expected}.substr(0, 100), string_view{expected}.substr(100)};
+        if (sender.write(halves) != expected.size())
+        {
+            throw runtime_error("write(array<string_view, 2>) did not write both buffers");
+        }
+        const array<string_view, 2> one{string_view{expected}, string_view{}};
+        if (sender.write(one) != expected.size())
+        {
+            throw runtime_error("write(array<string_view, 2>) with an empty second buffer did not write the first");
+        }
+
+        for (int datagram = 0; datagram < 4; ++datagram)
+        {
+            string received;
+            receiver.read(received);
+            if (received != expected)
+            {
+                throw runtime_error("datagram " + to_string(datagram) + " was split or truncated: got " + to_string(received.size())
+                                    + " bytes, expected " + to_string(expected.size()));
+            }
+        }
+    }
+    catch (const exception &e)
+    {
+        cerr << "Exception: " << e.what() << endl;
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,158 @@
+#include <iostream>
+#include <exception>
+#include <random>
+#include "reassembler_test_harness.h"
+using namespace std;
+
+static constexpr auto BITMAP = Reassembler::Engine::Bitmap;
+
+// 随机插入重叠的片段，并随机读取输出，比较两种引擎的结果
+void differential_test(const size_t capacity, const size_t random_seed)
+{
+    default_random_engine rd{random_seed};
+    const size_t total = capacity * 20;
+    string data;
+    uniform_int_distribution<char> ud;
+    for (size_t i = 0; i < total; ++i)
+    {
+        data += ud(rd);
+    }
+
+    Reassembler intervals{ByteStream{capacity}};
+    Reassembler bitmap{ByteStream{capacity}, BITMAP};
+    string out_intervals;
+    string out_bitmap;
+
+    uniform_int_distribution<size_t> len_dist{0, capacity / 2 + 1};
+    while (!bitmap.reader().is_finished())
+    {
+        // 片段起点落在第一个未组装字节附近（包括已组装的部分和窗口之外）
+        const uint64_t base = bitmap.writer().bytes_pushed();
+        uniform_int_distribution<size_t> start_dist{base > 8 ? base - 8 : 0, base + capacity};
+        const size_t start = min(start_dist(rd), total - 1);
+        const size_t len = min(len_dist(rd), total - start);
+        const bool last = start + len == total;
+        intervals.insert(start, data.substr(start, len), last);
+        bitmap.insert(start, data.substr(start, len), last);
+
+        if (intervals.bytes_pending() != bitmap.bytes_pending() || intervals.writer().bytes_pushed() != bitmap.writer().bytes_pushed())
+        {
+            throw runtime_error("differential test (capacity=" + to_string(capacity) + "): engines disagree on pending or pushed bytes");
+        }
+
+        if (rd() % 3 == 0)
+        {
+            string chunk;
+            const size_t n = len_dist(rd);
+            read(intervals.reader(), n, chunk);
+            out_intervals += chunk;
+            read(bitmap.reader(), n, chunk);
+            out_bitmap += chunk;
+        }
+        if (start + len < total && rd() % 4 == 0)
+        {
+            // 偶尔按顺序插入，保证测试能够推进到结尾
+            const size_t next = bitmap.writer().bytes_pushed();
+            const size_t n = min(len_dist(rd) + 1, total - next);
+            intervals.insert(next, data.substr(next, n), next + n == total);
+            bitmap.insert(next, data.substr(next, n), next + n == total);
+        }
+        string rest;
+        if (bitmap.writer().available_capacity() == 0)
+        {
+            read(intervals.reader(), capacity, rest);
+            out_intervals += rest;
+            read(bitmap.reader(), capacity, rest);
+            out_bitmap += rest;
+        }
+    }
+    string rest;
+    read(intervals.reader(), capacity, rest);
+    out_intervals += rest;
+    read(bitmap.reader(), capacity, rest);
+    out_bitmap += rest;
+
+    if (out_bitmap != data || out_intervals != data || !intervals.reader().is_finished())
+    {
+        throw runtime_error("differential test (capacity=" + to_string(capacity) + "): output mismatch");
+    }
+}
+
+int main()
+{
+    try
+    {
+        {
+            ReassemblerTestHarness test{"bitmap holes", 65000, BITMAP};
+
+            test.execute(Insert{"b", 1});
+            test.execute(Insert{"d", 3});
+            test.execute(BytesPending(2));
+            test.execute(BytesPushed(0));
+
+            test.execute(Insert{"c", 2});
+            test.execute(BytesPending(3));
+
+            test.execute(Insert{"a", 0});
+            test.execute(BytesPending(0));
+            test.execute(BytesPushed(4));
+            test.execute(ReadAll("abcd"));
+            test.execute(IsFinished{false});
+        }
+        {
+            ReassemblerTestHarness test{"bitmap overlapping", 1000, BITMAP};
+
+            test.execute(Insert{"cdef", 2});
+            test.execute(Insert{"efgh", 4});
+            test.execute(BytesPending(6));
+            test.execute(Insert{"abcd", 0});
+            test.execute(BytesPending(0));
+            test.execute(Insert{"ghij", 6}.is_last());
+            test.execute(ReadAll("abcdefghij"));
+            test.execute(IsFinished{true});
+        }
+        {
+            // 容量为 8，索引经过多次环绕，位图和输出流存储都要正确折回
+            ReassemblerTestHarness test{"bitmap wraps around the window", 8, BITMAP};
+
+            test.execute(Insert{"abcde", 0});
+            test.execute(ReadAll("abcde"));
+            test.execute(Insert{"jklm", 9});
+            test.execute(BytesPending(4));
+            test.execute(Insert{"fghi", 5});
+            test.execute(BytesPending(0));
+            test.execute(BytesPushed(13));
+            test.execute(ReadAll("fghijklm"));
+
+            test.execute(Insert{"pqrstuvwxyz", 15});
+            test.execute(BytesPending(6));
+            test.execute(Insert{"no", 13});
+            test.execute(BytesPushed(21));
+            test.execute(ReadAll("nopqrstu"));
+            test.execute(Insert{"vwxyz", 21}.is_last());
+            test.execute(ReadAll("vwxyz"));
+            test.execute(IsFinished{true});
+        }
+        {
+            ReassemblerTestHarness test{"bitmap discards beyond capacity", 2, BITMAP};
+
+            test.execute(Insert{"ab", 0});
+            test.execute(Insert{"cd", 2});
+            test.execute(BytesPending(0));
+            test.execute(ReadAll("ab"));
+            test.execute(Insert{"cd", 2});
+            test.execute(ReadAll("cd"));
+        }
+
+        differential_test(1, 1);
+        differential_test(64, 2);
+        differential_test(100, 3);
+        differential_test(1500, 4);
+    }
+    catch (const exception &e)
+    {
+        cerr << "Exception: " << e.what() << endl;
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}
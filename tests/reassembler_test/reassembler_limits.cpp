@@ -0,0 +1,225 @@
+#include <iostream>
+#include <deque>
+#include <exception>
+#include "reassembler_test_harness.h"
+#include "tcp_peer.h"
+using namespace std;
+
+// 检查进程级统计
+void expect_global(const string &what, uint64_t charged, uint64_t evicted)
+{
+    if (Reassembler::global_bytes_charged() != charged || Reassembler::global_bytes_evicted() != evicted)
+    {
+        throw runtime_error(what + ": expected global charged=" + to_string(charged) + " evicted=" + to_string(evicted)
+                            + ", got charged=" + to_string(Reassembler::global_bytes_charged())
+                            + " evicted=" + to_string(Reassembler::global_bytes_evicted()));
+    }
+}
+
+// 接收端丢弃已被 SACK 的数据（违约）后，发送端超时重传，数据照常完整送达。
+// 第一个数据段丢失，第三个先于第二个到达并被 SACK；第二个到达后与第三个合并，超出上限，第三个的数据被丢弃。
+void renege_test()
+{
+    TCPConfig cfg;
+    cfg.sack = true;
+    cfg.rt_timeout = 100;
+    TCPConfig server_cfg = cfg;
+    server_cfg.reassembler_pending_limit = 1024; // 只放得下一个 1000 字节的区间
+    TCPPeer client{cfg};
+    TCPPeer server{server_cfg};
+
+    deque<TCPMessage> to_server;
+    deque<TCPMessage> to_client;
+    const auto client_transmit = [&](TCPMessage msg) { to_server.push_back(std::move(msg)); };
+    const auto server_transmit = [&](TCPMessage msg) { to_client.push_back(std::move(msg)); };
+    const auto deliver = [&]
+    {
+        while (!to_server.empty() || !to_client.empty())
+        {
+            for (; !to_server.empty(); to_server.pop_front())
+            {
+                server.receive(std::move(to_server.front()), server_transmit);
+            }
+            for (; !to_client.empty(); to_client.pop_front())
+            {
+                client.receive(std::move(to_client.front()), client_transmit);
+            }
+        }
+    };
+
+    client.push(client_transmit);
+    deliver();
+
+    const string data(3000, 'x');
+    client.outbound_writer().push(data);
+    client.outbound_writer().close();
+    client.push(client_transmit);
+    if (to_server.size() != 3)
+    {
+        throw runtime_error("renege: expected three data segments, got " + to_string(to_server.size()));
+    }
+    TCPMessage second = std::move(to_server[1]);
+    TCPMessage third = std::move(to_server[2]);
+    to_server.clear();
+
+    server.receive(std::move(third), server_transmit);
+    deliver();
+    if (client.sender().sequence_numbers_sacked() == 0)
+    {
+        throw runtime_error("renege: the third segment was not SACKed");
+    }
+    server.receive(std::move(second), server_transmit);
+    deliver();
+    if (server.receiver().reassembler().bytes_evicted() == 0)
+    {
+        throw runtime_error("renege: the receiver did not drop the SACKed data");
+    }
+
+    string received;
+    for (uint64_t now = 0; now < 5000 && !server.inbound_reader().is_finished(); ++now)
+    {
+        client.tick(1, client_transmit);
+        server.tick(1, server_transmit);
+        deliver();
+        received += server.inbound_reader().peek();
+        server.inbound_reader().pop(server.inbound_reader().bytes_buffered());
+    }
+    if (!server.inbound_reader().is_finished() || received != data)
+    {
+        throw runtime_error("renege: data dropped after being SACKed was never retransmitted");
+    }
+}
+
+int main()
+{
+    try
+    {
+        {
+            // 超出本重组器上限时丢弃最远的区间，包括刚到达的数据；短区间按最小的块（256 字节）计
+            ReassemblerTestHarness test{"per-reassembler limit drops farthest bytes", 100, Reassembler::Engine::IntervalMap, 512};
+
+            test.execute(Insert{"abcdefgh", 10});
+            test.execute(BytesPending{8});
+            test.execute(BytesCharged{256});
+            test.execute(BytesEvicted{0});
+
+            test.execute(Insert{"ijklmn", 30});
+            test.execute(BytesPending{14});
+            test.execute(BytesCharged{512});
+            test.execute(BytesEvicted{0});
+
+            test.execute(Insert{"xyz", 50});
+            test.execute(BytesPending{14});
+            test.execute(BytesCharged{512});
+            test.execute(BytesEvicted{3});
+
+            test.execute(Insert{"0123456789", 0});
+            test.execute(BytesPushed{18});
+            test.execute(BytesPending{6});
+            test.execute(BytesCharged{256});
+            test.execute(ReadAll{"0123456789abcdefgh"});
+        }
+
+        {
+            // 较近的数据到达时，先丢弃更远的区间
+            ReassemblerTestHarness test{"nearer data displaces farther data", 100, Reassembler::Engine::IntervalMap, 512};
+
+            test.execute(Insert{"abcdefgh", 10});
+            test.execute(Insert{"ij", 26});
+            test.execute(BytesPending{10});
+
+            test.execute(Insert{"AAAA", 20});
+            test.execute(BytesPending{12});
+            test.execute(BytesEvicted{2});
+
+            test.execute(Insert{"0123456789", 0});
+            test.execute(ReadAll{"0123456789abcdefgh"});
+            test.execute(Insert{"XY", 18});
+            test.execute(ReadAll{"XYAAAA"});
+            test.execute(BytesPending{0});
+            test.execute(BytesCharged{0});
+
+            // 被丢弃的字节重传后照常组装
+            test.execute(Insert{"ccij", 24}.is_last());
+            test.execute(ReadAll{"ccij"});
+            test.execute(IsFinished{true});
+        }
+
+        {
+            // 上限按占用的块计：3000 字节的区间占一个 4 KB 的块，超过 3000 字节的上限，
+            // 截到 2047 字节后换用 2 KB 的块
+            ReassemblerTestHarness test{"limit counts pool chunks, not bytes", 10000, Reassembler::Engine::IntervalMap, 3000};
+
+            test.execute(Insert{string(3000, 'x'), 100});
+            test.execute(BytesPending{2047});
+            test.execute(BytesCharged{2048});
+            test.execute(BytesEvicted{953});
+
+            test.execute(Insert{string(100, 'y'), 5000});
+            test.execute(BytesPending{2147});
+            test.execute(BytesCharged{2048 + 256});
+            test.execute(BytesEvicted{953});
+
+            test.execute(Insert{string(100, 'w'), 0});
+            test.execute(BytesPushed{2147});
+            test.execute(BytesPending{100});
+            test.execute(BytesCharged{256});
+        }
+
+        {
+            // Bitmap 引擎的乱序数据不额外占用内存，不受上限约束
+            ReassemblerTestHarness test{"bitmap engine ignores limit", 100, Reassembler::Engine::Bitmap, 2};
+
+            test.execute(Insert{"bcd", 1});
+            test.execute(BytesPending{3});
+            test.execute(BytesEvicted{0});
+            test.execute(Insert{"a", 0});
+            test.execute(ReadAll{"abcd"});
+        }
+
+        {
+            // 进程上限：插入数据的重组器丢弃自己最远的字节，统计随复制、移动和析构正确增减
+            const uint64_t evicted = 2 + 3 + 953;
+            expect_global("initial", 0, evicted);
+            Reassembler::set_global_pending_limit(512);
+
+            Reassembler second{ByteStream{100}};
+            {
+                Reassembler first{ByteStream{100}};
+                first.insert(5, "abcdefgh", false);
+                expect_global("first insert", 256, evicted);
+
+                second.insert(5, "ABCDEF", false);
+                second.insert(20, "XY", false);
+                if (second.bytes_pending() != 6 || second.bytes_evicted() != 2 || first.bytes_pending() != 8)
+                {
+                    throw runtime_error("global limit: the inserting reassembler should shed its own farthest bytes");
+                }
+                expect_global("second insert", 512, evicted + 2);
+            }
+            expect_global("first destroyed", 256, evicted + 2);
+
+            Reassembler moved{std::move(second)};
+            expect_global("after move", 256, evicted + 2);
+            const Reassembler copied{moved};
+            expect_global("after copy", 512, evicted + 2);
+
+            moved.insert(0, "01234", false);
+            if (moved.reader().peek() != "01234ABCDEF" || moved.bytes_pending() != 0)
+            {
+                throw runtime_error("global limit: kept bytes did not reassemble");
+            }
+            expect_global("after reassembly", 256, evicted + 2);
+
+            Reassembler::set_global_pending_limit(UINT64_MAX);
+        }
+
+        renege_test();
+    }
+    catch (const exception &e)
+    {
+        cerr << "Exception: " << e.what() << endl;
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}
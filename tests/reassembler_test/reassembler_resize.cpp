@@ -0,0 +1,120 @@
+#include <iostream>
+#include <exception>
+#include <random>
+#include "reassembler_test_harness.h"
+using namespace std;
+
+// 随机插入乱序片段并随机调整容量，两种引擎的输出都应与原始数据一致
+void random_test(Reassembler::Engine engine, size_t random_seed)
+{
+    default_random_engine rd{random_seed};
+    const size_t total = 200000;
+    string data(total, 0);
+    for (auto &c : data)
+    {
+        c = uniform_int_distribution<char>{}(rd);
+    }
+
+    Reassembler reassembler{ByteStream{1000}, engine};
+    string out;
+    while (!reassembler.reader().is_finished())
+    {
+        const uint64_t base = reassembler.writer().bytes_pushed();
+        const uint64_t capacity = reassembler.writer().capacity();
+        const size_t start = min<size_t>(uniform_int_distribution<uint64_t>{base, base + capacity}(rd), total - 1);
+        const size_t len = min<size_t>(uniform_int_distribution<size_t>{1, capacity / 4 + 1}(rd), total - start);
+        reassembler.insert(start, data.substr(start, len), start + len == total);
+        if (rd() % 3 == 0)
+        {
+            // 偶尔按顺序插入，保证测试能够推进到结尾
+            const size_t n = min<size_t>(capacity / 4 + 1, total - base);
+            reassembler.insert(base, data.substr(base, n), base + n == total);
+        }
+
+        if (rd() % 8 == 0)
+        {
+            reassembler.set_capacity(uniform_int_distribution<uint64_t>{1, 8000}(rd));
+        }
+        if (reassembler.writer().capacity() > 8000)
+        {
+            throw runtime_error("set_capacity() grew the stream beyond the largest requested capacity");
+        }
+
+        string chunk;
+        read(reassembler.reader(), uniform_int_distribution<size_t>{0, 2 * capacity}(rd), chunk);
+        out += chunk;
+    }
+
+    if (out != data)
+    {
+        throw runtime_error("random resize test: output mismatch");
+    }
+}
+
+int main()
+{
+    try
+    {
+        for (const auto engine : {Reassembler::Engine::IntervalMap, Reassembler::Engine::Bitmap})
+        {
+            const string name = engine == Reassembler::Engine::Bitmap ? "bitmap" : "intervals";
+
+            {
+                // 乱序数据落在环的开头（折回处），扩大容量后仍能与后续数据拼接
+                ReassemblerTestHarness test{name + ": grow with pending bytes", 8, engine};
+
+                test.execute(Insert{"abcdef", 0});
+                test.execute(Pop{5});
+                test.execute(Insert{"ij", 8});
+                test.execute(BytesPending(2));
+
+                test.execute(Resize{16});
+                test.execute(AvailableCapacity{15});
+                test.execute(BytesPending(2));
+                test.execute(Insert{"gh", 6});
+                test.execute(BytesPending(0));
+                test.execute(BytesPushed(10));
+
+                test.execute(Insert{"klmnopqrst", 10}.is_last());
+                test.execute(BytesPushed(20));
+                test.execute(ReadAll("fghijklmnopqrst"));
+                test.execute(IsFinished{true});
+            }
+
+            {
+                ReassemblerTestHarness test{name + ": shrink keeps pending bytes in the window", 100, engine};
+
+                test.execute(Insert{"a", 0});
+                test.execute(ReadAll("a"));
+                test.execute(Insert{"z", 50});
+
+                // 缩小到 10 字节会把索引 50 的字节移出窗口，实际只缩小到恰好容纳它
+                test.execute(Resize{10});
+                test.execute(AvailableCapacity{50});
+                test.execute(Insert{string(48, 'y'), 1});
+                test.execute(BytesPending(1));
+                test.execute(Insert{"y", 49});
+                test.execute(BytesPending(0));
+                test.execute(BytesPushed(51));
+
+                test.execute(Resize{10});
+                test.execute(AvailableCapacity{0});
+                test.execute(ReadAll(string(49, 'y') + "z"));
+                test.execute(AvailableCapacity{50});
+                test.execute(Resize{10});
+                test.execute(AvailableCapacity{10});
+                test.execute(Insert{string(20, 'w'), 51});
+                test.execute(BytesPushed(61));
+            }
+
+            random_test(engine, engine == Reassembler::Engine::Bitmap ? 7 : 8);
+        }
+    }
+    catch (const exception &e)
+    {
+        cerr << "Exception: " << e.what() << endl;
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
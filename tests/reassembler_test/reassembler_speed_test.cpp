@@ -7,15 +7,23 @@
 #include <queue>         // 引入队列库，提供队列数据结构
 #include <random>        // 引入随机数库，提供随机数生成
 #include <tuple>         // 引入元组库，提供 std::tuple 类型
+#include <vector>        // 引入向量库，用于存储插入顺序
 #include "reassembler.h" // 引入 Reassembler 类的定义
 
 using namespace std;         // 使用标准命名空间，简化代码书写
 using namespace std::chrono; // 使用 chrono 命名空间，简化时间相关代码
 
+// 返回重组引擎的名称
+const char *engine_name(Reassembler::Engine engine)
+{
+    return engine == Reassembler::Engine::Bitmap ? "Bitmap" : "IntervalMap";
+}
+
 // speed_test 函数用于测试 Reassembler 的性能
 void speed_test(const size_t num_chunks,  // NOLINT(bugprone-easily-swappable-parameters)
                 const size_t capacity,    // NOLINT(bugprone-easily-swappable-parameters)
-                const size_t random_seed) // NOLINT(bugprone-easily-swappable-parameters)
+                const size_t random_seed, // NOLINT(bugprone-easily-swappable-parameters)
+                const Reassembler::Engine engine)
 {
     // 生成要写入的数据
     const string data = [&]
@@ -41,7 +49,7 @@ void speed_test(const size_t num_chunks,  // NOLINT(bugprone-easily-swappable-pa
     }
 
     // 创建 Reassembler 实例，初始化 ByteStream
-    Reassembler reassembler{ByteStream{capacity}};
+    Reassembler reassembler{ByteStream{capacity}, engine};
 
     string output_data;               // 用于存储重组后的数据
     output_data.reserve(data.size()); // 预留空间以提高性能
@@ -85,11 +93,11 @@ void speed_test(const size_t num_chunks,  // NOLINT(bugprone-easily-swappable-pa
     debug_output.open("/dev/tty"); // 打开终端设备
 
     // 输出测试结果
-    cout << "Reassembler to ByteStream with capacity=" << capacity << " reached " << fixed << setprecision(2)
-         << gigabits_per_second << " Gbit/s.\n";
+    cout << engine_name(engine) << " Reassembler to ByteStream with capacity=" << capacity << " reached " << fixed
+         << setprecision(2) << gigabits_per_second << " Gbit/s.\n";
 
-    debug_output << "             Reassembler throughput: " << fixed << setprecision(2) << gigabits_per_second
-                 << " Gbit/s\n";
+    debug_output << "  " << setw(12) << engine_name(engine) << " Reassembler throughput: " << fixed << setprecision(2)
+                 << gigabits_per_second << " Gbit/s\n";
 
     // 检查是否达到最低速度要求
     if (gigabits_per_second < 0.1)
@@ -98,10 +106,157 @@ void speed_test(const size_t num_chunks,  // NOLINT(bugprone-easily-swappable-pa
     }
 }
 
+// in_order_speed_test 函数测试按序到达（无丢包、无乱序）时的性能，这是 TCP 接收端最常见的情况
+void in_order_speed_test(const size_t num_chunks, // NOLINT(bugprone-easily-swappable-parameters)
+                         const size_t chunk_size, // NOLINT(bugprone-easily-swappable-parameters)
+                         const size_t random_seed,
+                         const Reassembler::Engine engine)
+{
+    // 预先切好所有片段，计时部分只包含插入和读取
+    default_random_engine rd{random_seed};
+    uniform_int_distribution<char> ud;
+    vector<string> chunks(num_chunks);
+    string data;
+    for (auto &chunk : chunks)
+    {
+        for (size_t i = 0; i < chunk_size; ++i)
+        {
+            chunk += ud(rd);
+        }
+        data += chunk;
+    }
+
+    Reassembler reassembler{ByteStream{64000}, engine}; // 与 TCPConfig 默认容量一致
+    string output_data;
+    output_data.reserve(data.size());
+
+    const auto start_time = steady_clock::now(); // 记录开始时间
+    uint64_t index = 0;
+    for (size_t i = 0; i < num_chunks; ++i)
+    {
+        const size_t len = chunks[i].size();
+        reassembler.insert(index, move(chunks[i]), i + 1 == num_chunks);
+        index += len;
+
+        while (reassembler.reader().bytes_buffered())
+        {
+            const auto view = reassembler.reader().peek();
+            output_data += view;
+            reassembler.reader().pop(view.size());
+        }
+    }
+    const auto stop_time = steady_clock::now(); // 记录结束时间
+
+    if (not reassembler.reader().is_finished() or output_data != data)
+    {
+        throw runtime_error("in-order Reassembler produced wrong output");
+    }
+
+    const auto test_duration = duration_cast<duration<double>>(stop_time - start_time);
+    const auto gigabits_per_second = 8 * static_cast<double>(data.size()) / test_duration.count() / 1e9;
+
+    fstream debug_output;          // 创建文件流对象
+    debug_output.open("/dev/tty"); // 打开终端设备
+
+    cout << engine_name(engine) << " Reassembler with in-order " << chunk_size << "-byte segments reached " << fixed
+         << setprecision(2) << gigabits_per_second << " Gbit/s.\n";
+
+    debug_output << "  " << setw(12) << engine_name(engine) << " Reassembler in-order throughput: " << fixed
+                 << setprecision(2) << gigabits_per_second << " Gbit/s\n";
+
+    if (gigabits_per_second < 0.1)
+    {
+        throw runtime_error("in-order Reassembler did not meet minimum speed of 0.1 Gbit/s.");
+    }
+}
+
+// holes_speed_test 函数测试 Reassembler 在大量空洞（乱序区间）下的性能：
+// 先以随机顺序插入所有偶数编号的块，留下 num_holes 个空洞，再以随机顺序填补奇数编号的块
+void holes_speed_test(const size_t num_holes,  // NOLINT(bugprone-easily-swappable-parameters)
+                      const size_t chunk_size, // NOLINT(bugprone-easily-swappable-parameters)
+                      const size_t random_seed,
+                      const Reassembler::Engine engine)
+{
+    default_random_engine rd{random_seed}; // 创建随机数生成器，使用给定的种子
+    const size_t num_chunks = num_holes * 2;
+
+    // 生成要写入的数据
+    const string data = [&]
+    {
+        uniform_int_distribution<char> ud;
+        string ret;
+        for (size_t i = 0; i < num_chunks * chunk_size; ++i)
+        {
+            ret += ud(rd);
+        }
+        return ret;
+    }();
+
+    // 偶数编号的块在前、奇数编号的块在后，各自内部随机打乱
+    vector<size_t> order;
+    for (size_t parity : {0, 1})
+    {
+        vector<size_t> part;
+        for (size_t i = parity; i < num_chunks; i += 2)
+        {
+            part.push_back(i);
+        }
+        shuffle(part.begin(), part.end(), rd);
+        order.insert(order.end(), part.begin(), part.end());
+    }
+
+    // 窗口容纳全部数据，所有乱序块都会被缓存
+    Reassembler reassembler{ByteStream{data.size()}, engine};
+    uint64_t max_pending = 0;
+
+    const auto start_time = steady_clock::now(); // 记录开始时间
+    for (const size_t chunk : order)
+    {
+        reassembler.insert(chunk * chunk_size, data.substr(chunk * chunk_size, chunk_size), chunk == num_chunks - 1);
+        max_pending = max(max_pending, reassembler.bytes_pending());
+    }
+    const auto stop_time = steady_clock::now(); // 记录结束时间
+
+    string output_data;
+    read(reassembler.reader(), data.size(), output_data);
+    if (not reassembler.reader().is_finished() or output_data != data)
+    {
+        throw runtime_error("Reassembler with holes produced wrong output");
+    }
+    if (max_pending < (num_holes - 1) * chunk_size)
+    {
+        throw runtime_error("holes benchmark did not keep the expected number of holes open");
+    }
+
+    const auto test_duration = duration_cast<duration<double>>(stop_time - start_time);
+    const auto inserts_per_second = static_cast<double>(num_chunks) / test_duration.count();
+
+    fstream debug_output;          // 创建文件流对象
+    debug_output.open("/dev/tty"); // 打开终端设备
+
+    cout << engine_name(engine) << " Reassembler with " << num_holes << " holes of " << chunk_size << " bytes reached " << fixed
+         << setprecision(2) << inserts_per_second / 1e6 << " M inserts/s.\n";
+
+    debug_output << "  " << setw(12) << engine_name(engine) << " Reassembler (" << num_holes << " holes) inserts: " << fixed << setprecision(2)
+                 << inserts_per_second / 1e6 << " M/s\n";
+
+    // 每次插入的代价应当与空洞数量基本无关
+    if (inserts_per_second < 1e5)
+    {
+        throw runtime_error("Reassembler with holes did not meet minimum speed of 0.1 M inserts/s.");
+    }
+}
+
 // 执行速度测试
 void program_body()
 {
-    speed_test(10000, 1500, 1370); // 调用 speed_test，生成 10000 个数据块，每个块容量为 1500 字节，随机种子为 1370
+    for (const auto engine : {Reassembler::Engine::IntervalMap, Reassembler::Engine::Bitmap})
+    {
+        speed_test(10000, 1500, 1370, engine);           // 调用 speed_test，生成 10000 个数据块，每个块容量为 1500 字节，随机种子为 1370
+        in_order_speed_test(100000, 1000, 1373, engine); // 10 万个按序到达的 1000 字节片段
+        holes_speed_test(1000, 100, 1371, engine);       // 1000 个空洞
+        holes_speed_test(20000, 100, 1372, engine);      // 20000 个空洞，每次插入的代价不应随之线性增长
+    }
 }
 
 int main()
@@ -38,11 +38,15 @@ struct ReassemblerTestStep : public TestStep<Reassembler>
 class ReassemblerTestHarness : public TestHarness<Reassembler>
 {
 public:
-    // 构造函数，接受测试名称和容量，初始化基类
-    ReassemblerTestHarness(std::string test_name, uint64_t capacity)
+    // 构造函数，接受测试名称、容量、重组引擎和乱序字节上限，初始化基类
+    ReassemblerTestHarness(std::string test_name,
+                           uint64_t capacity,
+                           Reassembler::Engine engine = Reassembler::Engine::IntervalMap,
+                           uint64_t pending_limit = UINT64_MAX)
         : TestHarness(move(test_name),
-                      "capacity=" + std::to_string(capacity),
-                      {Reassembler{ByteStream{capacity}}}) // 初始化 Reassembler 和 ByteStream
+                      "capacity=" + std::to_string(capacity) + (engine == Reassembler::Engine::Bitmap ? ", engine=bitmap" : "")
+                          + (pending_limit != UINT64_MAX ? ", pending_limit=" + std::to_string(pending_limit) : ""),
+                      {Reassembler{ByteStream{capacity}, engine, pending_limit}}) // 初始化 Reassembler 和 ByteStream
     {
     }
 
@@ -69,6 +73,44 @@ struct BytesPending : public ConstExpectNumber<Reassembler, uint64_t>
     uint64_t value(const Reassembler &r) const override { return r.bytes_pending(); }
 };
 
+// BytesEvicted 结构体，用于检查 Reassembler 因超出乱序数据上限而丢弃的字节数
+struct BytesEvicted : public ConstExpectNumber<Reassembler, uint64_t>
+{
+    using ConstExpectNumber::ConstExpectNumber; // 继承构造函数
+
+    // 返回检查的名称
+    std::string name() const override { return "bytes_evicted"; }
+
+    // 返回 Reassembler 丢弃的字节数
+    uint64_t value(const Reassembler &r) const override { return r.bytes_evicted(); }
+};
+
+// BytesCharged 结构体，用于检查 Reassembler 的乱序区间占用的池内存
+struct BytesCharged : public ConstExpectNumber<Reassembler, uint64_t>
+{
+    using ConstExpectNumber::ConstExpectNumber; // 继承构造函数
+
+    // 返回检查的名称
+    std::string name() const override { return "bytes_charged"; }
+
+    // 返回乱序区间占用的池内存
+    uint64_t value(const Reassembler &r) const override { return r.bytes_charged(); }
+};
+
+// Resize 结构体，表示调整重组器输出流的容量
+struct Resize : public Action<Reassembler>
+{
+    uint64_t capacity_; // 新的容量
+
+    explicit Resize(uint64_t capacity) : capacity_(capacity) {}
+
+    // 返回调整操作的描述
+    std::string description() const override { return "resize output to " + std::to_string(capacity_); }
+
+    // 执行调整操作
+    void execute(Reassembler &r) const override { r.set_capacity(capacity_); }
+};
+
 // Insert 结构体，表示插入操作
 struct Insert : public Action<Reassembler>
 {
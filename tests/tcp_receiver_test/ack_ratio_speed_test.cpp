@@ -0,0 +1,146 @@
+#include <iostream>     // 引入输入输出流库，用于输出信息
+#include <algorithm>    // 引入算法库，用于查找丢弃的报文
+#include <deque>        // 引入双端队列库，用于模拟传播中的报文
+#include <fstream>      // 引入文件流库，用于文件操作
+#include <iomanip>      // 引入格式化库，用于设置输出格式
+#include <string>       // 引入字符串库，用于保存传输的数据
+#include <vector>       // 引入向量库，用于保存丢弃的报文序号
+#include "tcp_peer.h"   // 引入 TCPPeer
+
+using namespace std; // 使用标准命名空间
+
+// 一次传输中发送端发出的数据报文段与接收端发出的纯确认
+struct AckStats
+{
+    bool finished{};          // 接收端是否收到了完整且正确的数据
+    uint64_t duration_ms{};   // 从开始到接收端读完全部数据的时间
+    uint64_t data_segments{}; // 发送端发出的带数据的报文段
+    uint64_t pure_acks{};     // 接收端发出的不占用序列号的报文段
+
+    double ratio() const { return data_segments ? static_cast<double>(pure_acks) / static_cast<double>(data_segments) : 0; }
+};
+
+// 两个 TCPPeer 通过单向时延 10 毫秒的链路相连，客户端把 data 发给服务端；drops 是客户端发出的第几个报文（从 0 开始）被丢弃
+AckStats transfer(bool delayed_ack, const string &data, const vector<uint64_t> &drops = {})
+{
+    constexpr uint64_t ONE_WAY_DELAY_MS = 10;
+
+    TCPConfig cfg;
+    cfg.congestion_control = CongestionControl::Algorithm::NewReno;
+    cfg.sack = true;
+    cfg.rack = true;
+    cfg.delayed_ack = delayed_ack;
+    TCPPeer client{cfg};
+    TCPPeer server{cfg};
+
+    AckStats stats;
+    uint64_t now = 0;
+    uint64_t client_packets = 0;
+    deque<pair<uint64_t, TCPMessage>> to_server; // 传播中：到达时间、报文
+    deque<pair<uint64_t, TCPMessage>> to_client;
+
+    const auto client_transmit = [&](TCPMessage msg)
+    {
+        stats.data_segments += !msg.sender.payload.empty();
+        if (find(drops.begin(), drops.end(), client_packets++) == drops.end())
+        {
+            to_server.emplace_back(now + ONE_WAY_DELAY_MS, std::move(msg));
+        }
+    };
+    const auto server_transmit = [&](TCPMessage msg)
+    {
+        stats.pure_acks += msg.sender.sequence_length() == 0;
+        to_client.emplace_back(now + ONE_WAY_DELAY_MS, std::move(msg));
+    };
+
+    size_t written = 0;
+    string received;
+    client.push(client_transmit);
+    for (; now < 60'000 && !server.inbound_reader().is_finished(); ++now)
+    {
+        while (!to_server.empty() && to_server.front().first <= now)
+        {
+            server.receive(std::move(to_server.front().second), server_transmit);
+            to_server.pop_front();
+        }
+        while (!to_client.empty() && to_client.front().first <= now)
+        {
+            client.receive(std::move(to_client.front().second), client_transmit);
+            to_client.pop_front();
+        }
+
+        // 应用向客户端写入数据，服务端的应用读走收到的数据
+        Writer &writer = client.outbound_writer();
+        const size_t n = min<size_t>(data.size() - written, writer.available_capacity());
+        writer.push(string_view{data}.substr(written, n));
+        written += n;
+        if (written == data.size() && !writer.is_closed())
+        {
+            writer.close();
+        }
+        client.push(client_transmit);
+        while (server.inbound_reader().bytes_buffered())
+        {
+            const auto view = server.inbound_reader().peek();
+            received += view;
+            server.inbound_reader().pop(view.size());
+        }
+
+        client.tick(1, client_transmit);
+        server.tick(1, server_transmit);
+    }
+
+    stats.duration_ms = now;
+    stats.finished = server.inbound_reader().is_finished() && received == data;
+    return stats;
+}
+
+void program_body()
+{
+    const string data(1'000'000, 'x');
+
+    fstream debug_output;          // 创建文件流对象
+    debug_output.open("/dev/tty"); // 打开终端设备
+
+    AckStats results[2];
+    for (const bool delayed_ack : {false, true})
+    {
+        for (const auto &drops : {vector<uint64_t>{}, vector<uint64_t>{30, 31}})
+        {
+            const AckStats stats = transfer(delayed_ack, data, drops);
+            if (!stats.finished)
+            {
+                throw runtime_error(string{"transfer did not complete with delayed ACK "} + (delayed_ack ? "on" : "off"));
+            }
+            cout << "delayed ACK " << (delayed_ack ? "on " : "off") << (drops.empty() ? ", no loss" : ", 2 losses")
+                 << ": " << stats.pure_acks << " pure ACKs for " << stats.data_segments << " data segments (" << fixed
+                 << setprecision(2) << stats.ratio() << " per segment), " << stats.duration_ms << " ms.\n";
+            if (drops.empty())
+            {
+                results[delayed_ack] = stats;
+                debug_output << "  ACKs per data segment, delayed ACK " << (delayed_ack ? "on: " : "off:") << " " << fixed
+                             << setprecision(2) << stats.ratio() << "\n";
+            }
+        }
+    }
+
+    // 每两个满长报文段确认一次，纯确认应减少到大约一半
+    if (results[true].ratio() > 0.6 || results[false].ratio() < 0.9)
+    {
+        throw runtime_error("delayed ACK did not halve the number of pure ACKs");
+    }
+}
+
+int main()
+{
+    try
+    {
+        program_body();
+    }
+    catch (const exception &e)
+    {
+        cerr << "Exception: " << e.what() << "\n";
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,105 @@
+#include <iostream>           // 引入输入输出流库，用于输出信息
+#include <chrono>             // 引入时间库，用于测量时间
+#include <fstream>            // 引入文件流库，用于文件操作
+#include <iomanip>            // 引入格式化库，用于设置输出格式
+#include <map>                // 引入有序映射库，作为对照的连接表
+#include <random>             // 引入随机数库，用于生成连接和查找顺序
+#include <tuple>              // 引入元组库，作为 std::map 的键
+#include <vector>             // 引入向量库，用于保存连接的四元组
+#include "connection_table.h" // 引入以四元组为键的开放寻址散列表
+
+using namespace std;         // 使用标准命名空间
+using namespace std::chrono; // 使用chrono命名空间，方便使用时间相关的功能
+
+constexpr uint64_t LOOKUPS = 2'000'000; // 每种规模下查找的次数
+
+// 一个服务端地址和端口上的 n 条连接，客户端地址和端口随机
+vector<FourTuple> make_connections(size_t n)
+{
+    default_random_engine rd{static_cast<unsigned>(n)};
+    vector<FourTuple> tuples;
+    ConnectionTable<bool> seen;
+    while (tuples.size() < n)
+    {
+        const FourTuple tuple{.local_ip = 0x0a000001,
+                              .remote_ip = 0x0a000000 | static_cast<uint32_t>(rd() & 0xffff),
+                              .local_port = 80,
+                              .remote_port = static_cast<uint16_t>(1024 + rd() % 60000)};
+        if (seen.emplace(tuple, true).second)
+        {
+            tuples.push_back(tuple);
+        }
+    }
+    return tuples;
+}
+
+// 按随机顺序查找 LOOKUPS 次，返回每次查找的纳秒数；found 累加找到的值，防止查找被优化掉
+template <class Lookup>
+double time_lookups(const vector<FourTuple> &tuples, Lookup &&lookup, uint64_t &found)
+{
+    default_random_engine rd{1};
+    vector<uint32_t> order(LOOKUPS);
+    for (auto &i : order)
+    {
+        i = static_cast<uint32_t>(rd() % tuples.size());
+    }
+
+    const auto start = steady_clock::now();
+    for (const uint32_t i : order)
+    {
+        found += lookup(tuples[i]);
+    }
+    return static_cast<double>(duration_cast<nanoseconds>(steady_clock::now() - start).count()) / LOOKUPS;
+}
+
+void program_body()
+{
+    fstream debug_output;          // 创建文件流对象
+    debug_output.open("/dev/tty"); // 打开终端设备
+
+    for (const size_t n : {100UL, 10'000UL, 250'000UL})
+    {
+        const vector<FourTuple> tuples = make_connections(n);
+
+        ConnectionTable<uint64_t> table;
+        map<tuple<uint32_t, uint32_t, uint16_t, uint16_t>, uint64_t> ordered;
+        for (uint64_t i = 0; i < tuples.size(); ++i)
+        {
+            const FourTuple &t = tuples[i];
+            table.emplace(t, i);
+            ordered.emplace(make_tuple(t.local_ip, t.remote_ip, t.local_port, t.remote_port), i);
+        }
+
+        uint64_t table_found = 0;
+        uint64_t map_found = 0;
+        const double table_ns = time_lookups(
+            tuples, [&](const FourTuple &t) { return *table.find(t); }, table_found);
+        const double map_ns = time_lookups(
+            tuples,
+            [&](const FourTuple &t) { return ordered.find(make_tuple(t.local_ip, t.remote_ip, t.local_port, t.remote_port))->second; },
+            map_found);
+        if (table_found != map_found)
+        {
+            throw runtime_error("ConnectionTable and std::map found different connections");
+        }
+
+        cout << setw(9) << n << " connections: " << fixed << setprecision(1) << table_ns << " ns per lookup in ConnectionTable, "
+             << map_ns << " ns in std::map.\n";
+        debug_output << "  Demux lookup with " << n << " connections: " << fixed << setprecision(1) << table_ns << " ns (std::map "
+                     << map_ns << " ns)\n";
+    }
+}
+
+int main()
+{
+    try
+    {
+        program_body();
+    }
+    catch (const exception &e)
+    {
+        cerr << "Exception: " << e.what() << "\n";
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}
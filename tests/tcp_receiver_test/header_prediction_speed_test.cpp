@@ -0,0 +1,128 @@
+#include <iostream>     // 引入输入输出流库，用于输出信息
+#include <chrono>       // 引入时间库，用于测量时间
+#include <deque>        // 引入双端队列库，用于保存传播中的报文
+#include <fstream>      // 引入文件流库，用于文件操作
+#include <iomanip>      // 引入格式化库，用于设置输出格式
+#include <string>       // 引入字符串库，用于保存传输的数据
+#include "tcp_peer.h"   // 引入 TCPPeer
+
+using namespace std;         // 使用标准命名空间
+using namespace std::chrono; // 使用chrono命名空间，方便使用时间相关的功能
+
+// 一次传输中两个 TCPPeer 处理的报文段和耗时
+struct PeerStats
+{
+    bool finished{};        // 接收端是否收到了完整且正确的数据
+    uint64_t segments{};    // 两端 receive() 处理的报文段总数
+    double seconds{};       // 传输的耗时
+
+    double segments_per_second() const { return static_cast<double>(segments) / seconds; }
+};
+
+// 两个 TCPPeer 直接相连，客户端把 data 发给服务端，报文立即送达；稳定状态下服务端只收到按序的数据，
+// 客户端只收到推进确认号的纯确认，正是首部预测要处理的两种报文段
+PeerStats transfer(bool header_prediction, bool delayed_ack, const string &data)
+{
+    TCPConfig cfg;
+    cfg.header_prediction = header_prediction;
+    cfg.delayed_ack = delayed_ack;
+    cfg.rack = true;
+    TCPPeer client{cfg};
+    TCPPeer server{cfg};
+
+    PeerStats stats;
+    deque<TCPMessage> to_server;
+    deque<TCPMessage> to_client;
+    const auto client_transmit = [&](TCPMessage msg) { to_server.push_back(std::move(msg)); };
+    const auto server_transmit = [&](TCPMessage msg) { to_client.push_back(std::move(msg)); };
+
+    const auto start = steady_clock::now();
+    size_t written = 0;
+    uint64_t received = 0;
+    bool intact = true;
+    client.push(client_transmit);
+    for (uint64_t round = 0; round < 10'000'000 && !server.inbound_reader().is_finished(); ++round)
+    {
+        Writer &writer = client.outbound_writer();
+        const size_t n = min<size_t>(data.size() - written, writer.available_capacity());
+        writer.push(string_view{data}.substr(written, n));
+        written += n;
+        if (written == data.size() && !writer.is_closed())
+        {
+            writer.close();
+        }
+        client.push(client_transmit);
+
+        for (; !to_server.empty(); to_server.pop_front(), ++stats.segments)
+        {
+            server.receive(std::move(to_server.front()), server_transmit);
+        }
+        while (server.inbound_reader().bytes_buffered())
+        {
+            const auto view = server.inbound_reader().peek();
+            intact &= view == string_view{data}.substr(received, view.size());
+            received += view.size();
+            server.inbound_reader().pop(view.size());
+        }
+        for (; !to_client.empty(); to_client.pop_front(), ++stats.segments)
+        {
+            client.receive(std::move(to_client.front()), client_transmit);
+        }
+
+        client.tick(1, client_transmit);
+        server.tick(1, server_transmit);
+    }
+
+    stats.seconds = duration_cast<duration<double>>(steady_clock::now() - start).count();
+    stats.finished = server.inbound_reader().is_finished() && intact && received == data.size();
+    return stats;
+}
+
+void program_body()
+{
+    const string data(200'000'000, 'x');
+
+    fstream debug_output;          // 创建文件流对象
+    debug_output.open("/dev/tty"); // 打开终端设备
+
+    for (const bool delayed_ack : {false, true})
+    {
+        PeerStats results[2];
+        for (const bool header_prediction : {false, true})
+        {
+            const PeerStats stats = transfer(header_prediction, delayed_ack, data);
+            if (!stats.finished)
+            {
+                throw runtime_error(string{"transfer did not complete with header prediction "} + (header_prediction ? "on" : "off"));
+            }
+            results[header_prediction] = stats;
+            cout << "delayed ACK " << (delayed_ack ? "on " : "off") << ", header prediction "
+                 << (header_prediction ? "on: " : "off:") << " " << stats.segments << " segments in " << fixed
+                 << setprecision(2) << stats.seconds << " s, " << setprecision(0) << stats.segments_per_second() / 1000
+                 << "k segments/s.\n";
+        }
+        debug_output << "  Peer segments/s, delayed ACK " << (delayed_ack ? "on: " : "off:") << " " << fixed
+                     << setprecision(0) << results[false].segments_per_second() / 1000 << "k without, "
+                     << results[true].segments_per_second() / 1000 << "k with header prediction\n";
+
+        // 两种方式处理的是同样的报文段
+        if (results[false].segments != results[true].segments)
+        {
+            throw runtime_error("header prediction changed the segments exchanged");
+        }
+    }
+}
+
+int main()
+{
+    try
+    {
+        program_body();
+    }
+    catch (const exception &e)
+    {
+        cerr << "Exception: " << e.what() << "\n";
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}
@@ -1,10 +1,15 @@
 #ifndef RECEIVER_TEST_HARNESS_H
 #define RECEIVER_TEST_HARNESS_H
 
+#include <cstdint>                    // 引入固定宽度整数类型
+#include <numeric>                    // 引入数值算法库，提供 std::accumulate
 #include <optional>                   // 引入可选类型库，提供 std::optional
 #include <sstream>                    // 引入字符串流库，用于字符串操作
 #include <utility>                    // 引入实用工具库，提供 std::move 等功能
+#include <vector>                     // 引入向量库，用于存储期望的 SACK 块
+#include <string>                     // 引入字符串库
 #include "common.h"                   // 引入公共定义和工具
+#include "ipv4_datagram.h"            // 引入 IPv4 数据报的定义
 #include "reassembler_test_harness.h" // 引入重组器测试工具的定义
 #include "tcp_receiver.h"             // 引入 TCP 接收器的定义
 #include "tcp_receiver_message.h"     // 引入 TCP 接收器消息的定义
@@ -53,11 +58,15 @@ struct DirectByteStreamTest : public TestStep<TCPReceiver>
 class TCPReceiverTestHarness : public TestHarness<TCPReceiver>
 {
 public:
-    // 构造函数，接受测试名称和容量
-    TCPReceiverTestHarness(std::string test_name, uint64_t capacity)
+    // 构造函数，接受测试名称、容量、重组器的存储方式、本端声明的窗口扩大移位数和自动调整的容量上限
+    TCPReceiverTestHarness(std::string test_name,
+                           uint64_t capacity,
+                           Reassembler::Engine engine = Reassembler::Engine::IntervalMap,
+                           std::optional<uint8_t> window_scale = {},
+                           uint64_t max_capacity = 0)
         : TestHarness(move(test_name),
-                      "capacity=" + std::to_string(capacity),
-                      {TCPReceiver{Reassembler{ByteStream{capacity}}}})
+                      "capacity=" + std::to_string(capacity) + (max_capacity ? ", max_capacity=" + std::to_string(max_capacity) : ""),
+                      {TCPReceiver{Reassembler{ByteStream{capacity}, engine}, window_scale, max_capacity}})
     {
     }
 
@@ -80,11 +89,11 @@ public:
 };
 
 // 期望窗口大小
-struct ExpectWindow : public ExpectNumber<TCPReceiver, uint16_t>
+struct ExpectWindow : public ExpectNumber<TCPReceiver, uint32_t>
 {
     using ExpectNumber::ExpectNumber;                                                // 继承构造函数
     std::string name() const override { return "window_size"; }                      // 返回名称
-    uint16_t value(TCPReceiver &rs) const override { return rs.send().window_size; } // 返回窗口大小
+    uint32_t value(TCPReceiver &rs) const override { return rs.send().window_size; } // 返回窗口大小
 };
 
 // 期望确认号
@@ -104,6 +113,45 @@ struct ExpectReset : public ExpectBool<TCPReceiver>
     bool value(TCPReceiver &rs) const override { return rs.send().RST; } // 返回重置标志
 };
 
+// 期望 SACK 块，按顺序比较每个块的 [begin, end)
+struct ExpectSackBlocks : public Expectation<TCPReceiver>
+{
+    std::vector<std::pair<Wrap32, Wrap32>> blocks_; // 期望的块
+
+    explicit ExpectSackBlocks(std::vector<std::pair<Wrap32, Wrap32>> blocks) : blocks_(std::move(blocks)) {}
+
+    // 把块列表格式化为字符串
+    template <typename Blocks>
+    static std::string format(const Blocks &blocks)
+    {
+        std::ostringstream ss;
+        ss << "{";
+        for (const auto &[begin, end] : blocks)
+        {
+            ss << " [" << begin << ", " << end << ")";
+        }
+        ss << " }";
+        return ss.str();
+    }
+
+    // 返回描述
+    std::string description() const override { return "sack_blocks = " + format(blocks_); }
+
+    // 执行检查
+    void execute(TCPReceiver &rs) const override
+    {
+        std::vector<std::pair<Wrap32, Wrap32>> actual;
+        for (const auto &block : rs.send().sack_blocks)
+        {
+            actual.emplace_back(block.begin, block.end);
+        }
+        if (actual != blocks_)
+        {
+            throw ExpectationViolation("TCPReceiver reported SACK blocks " + format(actual) + ", but expected " + format(blocks_));
+        }
+    }
+};
+
 // 期望确认号在某个范围内
 struct ExpectAcknoBetween : public Expectation<TCPReceiver>
 {
@@ -147,6 +195,32 @@ struct HasAckno : public ExpectBool<TCPReceiver>
     bool value(TCPReceiver &rs) const override { return rs.send().ackno.has_value(); } // 返回确认号是否存在
 };
 
+// 自动调整接收缓冲区的动作
+struct Autotune : public Action<TCPReceiver>
+{
+    uint64_t now_ms_;                // 当前时间
+    std::optional<uint64_t> rtt_ms_; // RTT 估计
+
+    Autotune(uint64_t now_ms, std::optional<uint64_t> rtt_ms) : now_ms_(now_ms), rtt_ms_(rtt_ms) {}
+
+    // 返回描述
+    std::string description() const override
+    {
+        return "autotune at " + std::to_string(now_ms_) + " ms, rtt="
+               + (rtt_ms_.has_value() ? std::to_string(*rtt_ms_) + " ms" : std::string{"unknown"});
+    }
+
+    // 执行自动调整
+    void execute(TCPReceiver &rs) const override { rs.autotune(now_ms_, rtt_ms_); }
+};
+
+// 接收器的消息发出的动作，记录通告的窗口右边缘
+struct AckSent : public Action<TCPReceiver>
+{
+    std::string description() const override { return "ack sent"; } // 返回描述
+    void execute(TCPReceiver &rs) const override { rs.sent(); }     // 记录通告的窗口
+};
+
 // 数据段到达的动作
 struct SegmentArrives : public Action<TCPReceiver>
 {
@@ -167,6 +241,20 @@ struct SegmentArrives : public Action<TCPReceiver>
         return *this;
     }
 
+    // 在 SYN 上声明支持 SACK
+    SegmentArrives &with_sack_permitted()
+    {
+        msg_.sack_permitted = true;
+        return *this;
+    }
+
+    // 设置 SYN 中的窗口扩大选项
+    SegmentArrives &with_window_scale(uint8_t shift)
+    {
+        msg_.window_scale = shift;
+        return *this;
+    }
+
     // 设置 RST 标志
     SegmentArrives &with_rst()
     {
@@ -215,6 +303,10 @@ struct SegmentArrives : public Action<TCPReceiver>
         {
             ss << " +SYN"; // 如果有 SYN 标志
         }
+        if (msg_.sack_permitted)
+        {
+            ss << " +SACK_PERMITTED"; // 如果声明支持 SACK
+        }
         if (!msg_.payload.empty())
         {
             ss << " payload=\"" << Printer::prettify(msg_.payload) << "\""; // 如果有负载
@@ -237,4 +329,11 @@ struct SegmentArrives : public Action<TCPReceiver>
     }
 };
 
+// 从 IPv4 数据报中取出 TCP 首部的 16 位窗口字段，即线路上缩放后的窗口
+inline uint16_t raw_window(const InternetDatagram &dgram)
+{
+    const std::string tcp = std::accumulate(dgram.payload.begin(), dgram.payload.end(), std::string{});
+    return static_cast<uint16_t>(static_cast<uint8_t>(tcp.at(14)) << 8 | static_cast<uint8_t>(tcp.at(15)));
+}
+
 #endif
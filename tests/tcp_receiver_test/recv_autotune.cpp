@@ -0,0 +1,160 @@
+#include <iostream>
+#include <cstdint>
+#include <cstdlib>
+#include <deque>
+#include <stdexcept>
+#include <string>
+#include "receiver_test_harness.h"
+#include "tcp_peer.h"
+using namespace std;
+
+// 应用每个 RTT 读走的数据翻倍时，缓冲区随之翻倍，直到上限
+void fast_reader_test()
+{
+    TCPReceiverTestHarness test{"autotune follows a fast reader", 1000, Reassembler::Engine::IntervalMap, {}, 8000};
+    test.execute(SegmentArrives{}.with_syn().with_seqno(0));
+    test.execute(Autotune{0, 100});
+
+    uint64_t seqno = 1;
+    uint64_t now = 0;
+    uint64_t capacity = 1000;
+    for (const uint64_t expected : {2000, 4000, 8000, 8000})
+    {
+        const string data(capacity, 'x');
+        test.execute(SegmentArrives{}.with_seqno(static_cast<uint32_t>(seqno)).with_data(data));
+        test.execute(ExpectWindow{0});
+        test.execute(ReadAll(data));
+        seqno += data.size();
+
+        // 不到一个 RTT 时不调整
+        test.execute(Autotune{now + 50, 100});
+        test.execute(ExpectWindow{static_cast<uint32_t>(data.size())});
+        now += 100;
+        test.execute(Autotune{now, 100});
+        test.execute(ExpectWindow{static_cast<uint32_t>(expected)});
+        capacity = expected;
+    }
+}
+
+// 应用读得慢、或者还没有 RTT 估计时不扩大缓冲区
+void slow_reader_test()
+{
+    TCPReceiverTestHarness test{"autotune ignores a slow reader", 1000, Reassembler::Engine::IntervalMap, {}, 8000};
+    test.execute(Autotune{0, 100});
+    test.execute(SegmentArrives{}.with_syn().with_seqno(0));
+    test.execute(Autotune{0, {}});
+    test.execute(Autotune{100, 100});
+
+    test.execute(SegmentArrives{}.with_seqno(1).with_data(string(1000, 'x')));
+    test.execute(Pop{300});
+    test.execute(Autotune{1000, {}});
+    test.execute(ExpectWindow{300});
+    test.execute(Autotune{200, 100});
+    test.execute(ExpectWindow{300});
+
+    // 一个 RTT 内读走的字节数超过缓冲区的一半才扩大
+    test.execute(Pop{700});
+    test.execute(Autotune{300, 100});
+    test.execute(ExpectWindow{1400});
+}
+
+// 两个 TCPPeer 通过单向时延 25 毫秒的链路传输 data，返回服务端读完全部数据的时间和最终的接收缓冲区大小
+pair<uint64_t, uint64_t> transfer(const string &data, size_t recv_capacity_max)
+{
+    constexpr uint64_t ONE_WAY_DELAY_MS = 25;
+
+    TCPConfig cfg;
+    cfg.congestion_control = CongestionControl::Algorithm::NewReno;
+    cfg.sack = true;
+    cfg.window_scaling = true;
+    cfg.delayed_ack = true;
+    cfg.send_capacity = 1'000'000;
+    cfg.recv_capacity_max = recv_capacity_max;
+    TCPPeer client{cfg};
+    TCPPeer server{cfg};
+
+    uint64_t now = 0;
+    deque<pair<uint64_t, TCPMessage>> to_server; // 传播中：到达时间、报文
+    deque<pair<uint64_t, TCPMessage>> to_client;
+    const auto client_transmit = [&](TCPMessage msg) { to_server.emplace_back(now + ONE_WAY_DELAY_MS, std::move(msg)); };
+    const auto server_transmit = [&](TCPMessage msg) { to_client.emplace_back(now + ONE_WAY_DELAY_MS, std::move(msg)); };
+
+    size_t written = 0;
+    string received;
+    client.push(client_transmit);
+    for (; now < 60'000 && !server.inbound_reader().is_finished(); ++now)
+    {
+        while (!to_server.empty() && to_server.front().first <= now)
+        {
+            server.receive(std::move(to_server.front().second), server_transmit);
+            to_server.pop_front();
+        }
+        while (!to_client.empty() && to_client.front().first <= now)
+        {
+            client.receive(std::move(to_client.front().second), client_transmit);
+            to_client.pop_front();
+        }
+
+        Writer &writer = client.outbound_writer();
+        const size_t n = min<size_t>(data.size() - written, writer.available_capacity());
+        writer.push(string_view{data}.substr(written, n));
+        written += n;
+        if (written == data.size() && !writer.is_closed())
+        {
+            writer.close();
+        }
+        client.push(client_transmit);
+        while (server.inbound_reader().bytes_buffered())
+        {
+            const auto view = server.inbound_reader().peek();
+            received += view;
+            server.inbound_reader().pop(view.size());
+        }
+
+        client.tick(1, client_transmit);
+        server.tick(1, server_transmit);
+    }
+
+    if (!server.inbound_reader().is_finished() || received != data)
+    {
+        throw runtime_error("transfer did not complete");
+    }
+    return {now, server.receiver().writer().capacity()};
+}
+
+// 接收缓冲区限制了窗口时，自动调整使传输快得多，且缓冲区不超过上限
+void transfer_test()
+{
+    const string data(4'000'000, 'x');
+    const auto [fixed_ms, fixed_capacity] = transfer(data, 0);
+    const auto [tuned_ms, tuned_capacity] = transfer(data, 1'000'000);
+
+    cout << "4 MB over a 50 ms RTT: fixed " << fixed_capacity << "-byte buffer " << fixed_ms << " ms, autotuned to "
+         << tuned_capacity << " bytes " << tuned_ms << " ms.\n";
+
+    if (fixed_capacity != TCPConfig::DEFAULT_CAPACITY || tuned_capacity > 1'000'000 || tuned_capacity <= fixed_capacity)
+    {
+        throw runtime_error("receive buffer was not tuned within [recv_capacity, recv_capacity_max]");
+    }
+    if (tuned_ms * 2 > fixed_ms)
+    {
+        throw runtime_error("autotuning did not speed up a window-limited transfer");
+    }
+}
+
+int main()
+{
+    try
+    {
+        fast_reader_test();
+        slow_reader_test();
+        transfer_test();
+    }
+    catch (const exception &e)
+    {
+        cerr << e.what() << endl;
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,375 @@
+#include <iostream>
+#include <cstdint>
+#include <cstdlib>
+#include <deque>
+#include <map>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <tuple>
+#include <vector>
+#include "receiver_test_harness.h"
+#include "tcp_demux.h"
+using namespace std;
+
+// 随机插入、删除、查找，与 std::map 对照；键只在很小的范围内变化，探测序列和删除时的前移都会频繁发生
+void table_test()
+{
+    default_random_engine rd{2024};
+    uniform_int_distribution<uint32_t> pick{0, 600};
+    const auto make_key = [](uint32_t n) { return FourTuple{.local_ip = 0x0a000001, .remote_ip = 0x0a000100 + n % 7, .local_port = 80, .remote_port = static_cast<uint16_t>(n)}; };
+    const auto as_tuple = [](const FourTuple &k) { return make_tuple(k.local_ip, k.remote_ip, k.local_port, k.remote_port); };
+
+    ConnectionTable<uint64_t> table;
+    map<tuple<uint32_t, uint32_t, uint16_t, uint16_t>, uint64_t> reference;
+    for (uint64_t step = 0; step < 200'000; ++step)
+    {
+        const FourTuple key = make_key(pick(rd));
+        switch (rd() % 3)
+        {
+            case 0:
+            {
+                const bool inserted = table.emplace(key, step).second;
+                if (inserted != reference.emplace(as_tuple(key), step).second)
+                {
+                    throw runtime_error("emplace() disagrees with std::map on whether the key exists");
+                }
+                break;
+            }
+            case 1:
+                if (table.erase(key) != (reference.erase(as_tuple(key)) == 1))
+                {
+                    throw runtime_error("erase() disagrees with std::map on whether the key exists");
+                }
+                break;
+            default:
+            {
+                const uint64_t *value = table.find(key);
+                const auto it = reference.find(as_tuple(key));
+                if ((value == nullptr) != (it == reference.end()) || (value != nullptr && *value != it->second))
+                {
+                    throw runtime_error("find() disagrees with std::map");
+                }
+                break;
+            }
+        }
+        if (table.size() != reference.size())
+        {
+            throw runtime_error("size() disagrees with std::map");
+        }
+    }
+
+    // 所有留下的元素都能找到，erase_if() 删除恰好满足条件的元素
+    for (const auto &[key, value] : reference)
+    {
+        const FourTuple k{.local_ip = get<0>(key), .remote_ip = get<1>(key), .local_port = get<2>(key), .remote_port = get<3>(key)};
+        if (table.find(k) == nullptr || *table.find(k) != value)
+        {
+            throw runtime_error("element lost after random operations");
+        }
+    }
+    const size_t odd = table.erase_if([](const FourTuple &, uint64_t value) { return value % 2 == 1; });
+    size_t remaining = 0;
+    table.for_each(
+        [&](const FourTuple &, uint64_t value)
+        {
+            remaining++;
+            if (value % 2 == 1)
+            {
+                throw runtime_error("erase_if() left a matching element");
+            }
+        });
+    if (remaining + odd != reference.size() || remaining != table.size())
+    {
+        throw runtime_error("erase_if() removed the wrong number of elements");
+    }
+}
+
+// 一个服务端适配器同时承载两个客户端主机的数百条连接：A 的连接协商了窗口扩大，B 的没有，
+// 两台主机使用相同的端口，只靠地址区分
+void demux_test()
+{
+    const Address server_addr{"10.0.0.1", 80};
+    const Address host_a{"10.0.0.2"};
+    const Address host_b{"10.0.0.3"};
+    constexpr size_t A_FLOWS = 300;
+    constexpr size_t B_FLOWS = 4;
+
+    TCPConfig server_cfg;
+    server_cfg.rt_timeout = 100;
+    server_cfg.window_scaling = true;
+    server_cfg.recv_capacity_max = 1'000'000; // 移位数为 4
+    TCPConfig a_cfg;
+    a_cfg.rt_timeout = 100;
+    a_cfg.window_scaling = true;
+    TCPConfig b_cfg;
+    b_cfg.rt_timeout = 100;
+
+    TCPOverIPv4Demux server{server_cfg};
+    TCPOverIPv4Demux client_a{a_cfg};
+    TCPOverIPv4Demux client_b{b_cfg};
+    server.listen(server_addr.port());
+
+    deque<InternetDatagram> to_server;
+    deque<InternetDatagram> to_clients;
+    const auto client_transmit = [&](InternetDatagram dgram) { to_server.push_back(std::move(dgram)); };
+    const auto server_transmit = [&](InternetDatagram dgram)
+    {
+        // 每条连接按自己协商的移位数缩放窗口
+        const auto seg = TCPOverIPv4Adapter::parse_segment(dgram);
+        const FourTuple tuple{.local_ip = dgram.header.src, .remote_ip = dgram.header.dst, .local_port = seg->udinfo.src_port, .remote_port = seg->udinfo.dst_port};
+        const TCPPeer *peer = server.find(tuple);
+        if (peer != nullptr && !seg->message.sender.SYN)
+        {
+            const unsigned shift = dgram.header.dst == host_a.ipv4_numeric() ? 4 : 0;
+            if (raw_window(dgram) != peer->receiver().send().window_size >> shift)
+            {
+                throw runtime_error("window field not scaled by this connection's own shift");
+            }
+        }
+        to_clients.push_back(std::move(dgram));
+    };
+
+    struct Flow
+    {
+        TCPOverIPv4Demux *client;
+        FourTuple tuple; // 客户端一侧的四元组
+        string data;
+        size_t written{};
+        string received{};
+    };
+    vector<Flow> flows;
+    for (size_t i = 0; i < A_FLOWS + B_FLOWS; ++i)
+    {
+        const bool on_a = i < A_FLOWS;
+        const uint16_t port = static_cast<uint16_t>(10000 + (on_a ? i : i - A_FLOWS));
+        TCPOverIPv4Demux &client = on_a ? client_a : client_b;
+        const Address local{on_a ? host_a.ip() : host_b.ip(), port};
+        const size_t size = on_a ? 3000 + i : 200'000;
+        string data(size, 0);
+        for (size_t j = 0; j < size; ++j)
+        {
+            data[j] = static_cast<char>('a' + (i + j) % 26);
+        }
+        flows.push_back({&client, client.connect(local, server_addr, client_transmit), std::move(data)});
+    }
+    if (client_a.size() != A_FLOWS || client_b.size() != B_FLOWS)
+    {
+        throw runtime_error("connect() did not create one connection per four-tuple");
+    }
+
+    size_t peak = 0;
+    size_t done = 0;
+    for (uint64_t now = 0; now < 20'000 && (done < flows.size() || server.size() + client_a.size() + client_b.size() > 0); ++now)
+    {
+        // 客户端写入数据，写完后关闭
+        for (auto &flow : flows)
+        {
+            TCPPeer *peer = flow.client->find(flow.tuple);
+            if (peer == nullptr || peer->outbound_writer().is_closed())
+            {
+                continue;
+            }
+            Writer &writer = peer->outbound_writer();
+            const size_t n = min<size_t>(flow.data.size() - flow.written, writer.available_capacity());
+            writer.push(string_view{flow.data}.substr(flow.written, n));
+            flow.written += n;
+            if (flow.written == flow.data.size())
+            {
+                writer.close();
+            }
+            flow.client->push(flow.tuple, client_transmit);
+        }
+
+        for (; !to_server.empty(); to_server.pop_front())
+        {
+            server.receive(to_server.front(), server_transmit);
+        }
+        peak = max(peak, server.size());
+
+        // 服务端读走每条连接的数据，读完后关闭自己的方向
+        done = 0;
+        for (auto &flow : flows)
+        {
+            const FourTuple reverse{.local_ip = flow.tuple.remote_ip, .remote_ip = flow.tuple.local_ip, .local_port = flow.tuple.remote_port, .remote_port = flow.tuple.local_port};
+            TCPPeer *peer = server.find(reverse);
+            if (peer != nullptr)
+            {
+                Reader &reader = peer->inbound_reader();
+                while (reader.bytes_buffered())
+                {
+                    flow.received += reader.peek();
+                    reader.pop(reader.peek().size());
+                }
+                if (reader.is_finished() && !peer->outbound_writer().is_closed())
+                {
+                    peer->outbound_writer().close();
+                    server.push(reverse, server_transmit);
+                }
+            }
+            done += flow.received.size() == flow.data.size();
+        }
+
+        for (; !to_clients.empty(); to_clients.pop_front())
+        {
+            TCPOverIPv4Demux &client = to_clients.front().header.dst == host_a.ipv4_numeric() ? client_a : client_b;
+            client.receive(to_clients.front(), client_transmit);
+        }
+
+        server.tick(1, server_transmit);
+        client_a.tick(1, client_transmit);
+        client_b.tick(1, client_transmit);
+        server.reap();
+        client_a.reap();
+        client_b.reap();
+    }
+
+    for (const auto &flow : flows)
+    {
+        if (flow.received != flow.data)
+        {
+            throw runtime_error("connection from port " + to_string(flow.tuple.local_port) + " delivered the wrong data");
+        }
+    }
+    if (peak != flows.size())
+    {
+        throw runtime_error("expected " + to_string(flows.size()) + " server connections, saw " + to_string(peak));
+    }
+    if (server.size() + client_a.size() + client_b.size() != 0)
+    {
+        throw runtime_error("finished connections were not reaped");
+    }
+}
+
+// 不属于任何连接的报文段被丢弃；只有发往监听端口的 SYN 建立连接
+void stray_segment_test()
+{
+    TCPOverIPv4Demux server{TCPConfig{}};
+    server.listen(80);
+    const auto ignore = [](InternetDatagram) {};
+
+    TCPMessage msg;
+    msg.sender.seqno = Wrap32{1000};
+    msg.receiver.ackno = Wrap32{2000};
+    const FourTuple from_client{.local_ip = 0x0a000002, .remote_ip = 0x0a000001, .local_port = 5000, .remote_port = 80};
+    if (server.receive(TCPOverIPv4Adapter::make_datagram(from_client, msg), ignore).has_value() || server.size() != 0)
+    {
+        throw runtime_error("an ACK for an unknown connection created one");
+    }
+
+    msg.sender.SYN = true;
+    msg.receiver.ackno.reset();
+    const FourTuple other_port{.local_ip = 0x0a000002, .remote_ip = 0x0a000001, .local_port = 5000, .remote_port = 81};
+    if (server.receive(TCPOverIPv4Adapter::make_datagram(other_port, msg), ignore).has_value() || server.size() != 0)
+    {
+        throw runtime_error("a SYN to a port nobody listens on created a connection");
+    }
+
+    const auto accepted = server.receive(TCPOverIPv4Adapter::make_datagram(from_client, msg), ignore);
+    const FourTuple expected{.local_ip = 0x0a000001, .remote_ip = 0x0a000002, .local_port = 80, .remote_port = 5000};
+    if (!accepted.has_value() || !(*accepted == expected) || server.size() != 1 || server.find(expected) == nullptr)
+    {
+        throw runtime_error("a SYN to the listening port did not create a connection");
+    }
+}
+
+// connect() 对已存在的四元组不做任何事：不建立新连接，也不再发出 SYN
+void connect_test()
+{
+    TCPOverIPv4Demux client{TCPConfig{}};
+    size_t sent = 0;
+    const auto count = [&](InternetDatagram) { ++sent; };
+    const Address local{"10.0.0.2", 5000};
+    const Address remote{"10.0.0.1", 80};
+
+    const FourTuple first = client.connect(local, remote, count);
+    const TCPPeer *peer = client.find(first);
+    const FourTuple second = client.connect(local, remote, count);
+    if (!(first == second) || client.size() != 1 || client.find(second) != peer || sent != 1)
+    {
+        throw runtime_error("connect() to an existing four-tuple changed the connection or sent another SYN");
+    }
+}
+
+// 被动建立的连接受 DemuxLimits 限制：半开连接或连接总数达到上限时 SYN 被丢弃，对方确认 SYN 后不再算作半开连接；
+// 对方一直不确认 SYN 的连接在半开期限到达时被删除，远早于重传次数用完
+void limits_test()
+{
+    TCPConfig cfg;
+    TCPOverIPv4Demux server{cfg, DemuxLimits{.max_connections = 3, .max_half_open = 2, .half_open_timeout_ms = 500}};
+    server.listen(80);
+
+    vector<TCPMessage> replies;
+    const auto capture = [&](InternetDatagram dgram) { replies.push_back(TCPOverIPv4Adapter::parse_segment(dgram)->message); };
+    const auto from_port = [](uint16_t port) { return FourTuple{.local_ip = 0x0a000002, .remote_ip = 0x0a000001, .local_port = port, .remote_port = 80}; };
+    const auto syn = [&](uint16_t port)
+    {
+        TCPMessage msg;
+        msg.sender.seqno = Wrap32{1000};
+        msg.sender.SYN = true;
+        msg.receiver.window_size = 1000;
+        return server.receive(TCPOverIPv4Adapter::make_datagram(from_port(port), msg), capture).has_value();
+    };
+    // 确认服务端发给 port 的 SYN
+    const auto ack = [&](uint16_t port, const TCPMessage &syn_ack)
+    {
+        TCPMessage msg;
+        msg.sender.seqno = Wrap32{1001};
+        msg.receiver.ackno = syn_ack.sender.seqno + 1;
+        msg.receiver.window_size = 1000;
+        server.receive(TCPOverIPv4Adapter::make_datagram(from_port(port), msg), capture);
+    };
+
+    if (!syn(5000) || !syn(5001) || syn(5002) || server.size() != 2 || server.half_open() != 2)
+    {
+        throw runtime_error("a SYN beyond the half-open limit was accepted");
+    }
+    const TCPMessage syn_ack_5000 = replies.at(0);
+    const TCPMessage syn_ack_5001 = replies.at(1);
+    ack(5000, syn_ack_5000);
+    if (server.half_open() != 1 || !syn(5002) || server.size() != 3)
+    {
+        throw runtime_error("a completed handshake still counted against the half-open limit");
+    }
+    ack(5001, syn_ack_5001);
+    if (server.half_open() != 1 || syn(5003) || server.size() != 3)
+    {
+        throw runtime_error("a SYN beyond the connection limit was accepted");
+    }
+
+    // 5002 的 SYN 一直没有被确认：期限之前仍占用名额，RTO 为 1 秒，重传次数远没有用完
+    server.tick(499, capture);
+    const FourTuple half_open{.local_ip = 0x0a000001, .remote_ip = 0x0a000002, .local_port = 80, .remote_port = 5002};
+    if (server.half_open() != 1 || server.find(half_open) == nullptr)
+    {
+        throw runtime_error("a half-open connection was dropped before its deadline");
+    }
+    server.tick(1, capture);
+    if (server.half_open() != 0 || server.size() != 2 || server.find(half_open) != nullptr)
+    {
+        throw runtime_error("a connection whose SYN was never acknowledged was not dropped at the half-open deadline");
+    }
+    if (!syn(5003))
+    {
+        throw runtime_error("a SYN was rejected after a dropped connection freed its slot");
+    }
+}
+
+int main()
+{
+    try
+    {
+        table_test();
+        stray_segment_test();
+        connect_test();
+        limits_test();
+        demux_test();
+    }
+    catch (const exception &e)
+    {
+        cerr << e.what() << endl;
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
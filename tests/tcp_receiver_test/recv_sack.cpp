@@ -0,0 +1,143 @@
+#include <iostream>
+#include <cstdint>
+#include <cstdlib>
+#include <stdexcept>
+#include <string>
+#include "parser.h"
+#include "random.h"
+#include "receiver_test_harness.h"
+#include "tcp_segment.h"
+using namespace std;
+
+// 选项经过序列化和解析后保持不变，超出选项区的 SACK 块被截断
+void sack_option_roundtrip_test(uint32_t isn)
+{
+    TCPSegment seg;
+    seg.message.sender.seqno = Wrap32{isn};
+    seg.message.sender.SYN = true;
+    seg.message.sender.sack_permitted = true;
+    seg.message.sender.payload = "payload";
+    seg.message.receiver.ackno = Wrap32{isn + 1000};
+    seg.message.receiver.window_size = 4321;
+    for (uint32_t i = 0; i < 5; ++i)
+    {
+        seg.message.receiver.sack_blocks.push_back({Wrap32{isn + 2000 + 100 * i}, Wrap32{isn + 2050 + 100 * i}});
+    }
+    seg.compute_checksum(0);
+
+    TCPSegment parsed;
+    if (!parse(parsed, serialize(seg), 0))
+    {
+        throw runtime_error("segment with SACK options failed to parse");
+    }
+    const auto &sender = parsed.message.sender;
+    const auto &receiver = parsed.message.receiver;
+    if (!sender.SYN || !sender.sack_permitted || sender.payload != "payload" || receiver.window_size != 4321)
+    {
+        throw runtime_error("SACK options corrupted the rest of the segment");
+    }
+    if (receiver.sack_blocks.size() != TCPReceiverMessage::MAX_SACK_BLOCKS)
+    {
+        throw runtime_error("expected " + to_string(TCPReceiverMessage::MAX_SACK_BLOCKS) + " SACK blocks on the wire, got "
+                            + to_string(receiver.sack_blocks.size()));
+    }
+    for (size_t i = 0; i < receiver.sack_blocks.size(); ++i)
+    {
+        if (!(receiver.sack_blocks[i].begin == seg.message.receiver.sack_blocks[i].begin)
+            || !(receiver.sack_blocks[i].end == seg.message.receiver.sack_blocks[i].end))
+        {
+            throw runtime_error("SACK block " + to_string(i) + " changed on the wire");
+        }
+    }
+
+    // 没有选项时首部仍是 20 字节
+    TCPSegment plain;
+    plain.message.receiver.ackno = Wrap32{isn};
+    if (serialize(plain).front().size() != 20)
+    {
+        throw runtime_error("segment without options should have a 20-byte header");
+    }
+}
+
+int main()
+{
+    try
+    {
+        auto rd = get_random_engine();
+
+        {
+            const uint32_t isn = uniform_int_distribution<uint32_t>{0, UINT32_MAX}(rd);
+            TCPReceiverTestHarness test{"no SACK blocks unless the sender permitted them", 4000};
+            test.execute(SegmentArrives{}.with_syn().with_seqno(isn));
+            test.execute(SegmentArrives{}.with_seqno(isn + 5).with_data("efg"));
+            test.execute(BytesPending{3});
+            test.execute(ExpectSackBlocks{{}});
+        }
+
+        for (const auto engine : {Reassembler::Engine::IntervalMap, Reassembler::Engine::Bitmap})
+        {
+            const uint32_t isn = uniform_int_distribution<uint32_t>{0, UINT32_MAX}(rd);
+            TCPReceiverTestHarness test{"SACK blocks describe out-of-order data, most recent first", 4000, engine};
+            test.execute(SegmentArrives{}.with_syn().with_sack_permitted().with_seqno(isn));
+            test.execute(ExpectSackBlocks{{}});
+            test.execute(SegmentArrives{}.with_seqno(isn + 5).with_data("efg"));
+            test.execute(ExpectSackBlocks{{{Wrap32{isn + 5}, Wrap32{isn + 8}}}});
+            test.execute(SegmentArrives{}.with_seqno(isn + 12).with_data("lm"));
+            test.execute(SegmentArrives{}.with_seqno(isn + 9).with_data("i"));
+            test.execute(ExpectSackBlocks{{{Wrap32{isn + 9}, Wrap32{isn + 10}},
+                                           {Wrap32{isn + 5}, Wrap32{isn + 8}},
+                                           {Wrap32{isn + 12}, Wrap32{isn + 14}}}});
+
+            // 相邻的区间合并为一个块
+            test.execute(SegmentArrives{}.with_seqno(isn + 8).with_data("h"));
+            test.execute(ExpectSackBlocks{{{Wrap32{isn + 5}, Wrap32{isn + 10}}, {Wrap32{isn + 12}, Wrap32{isn + 14}}}});
+
+            // 空洞补上后，已确认的部分不再出现在块里
+            test.execute(SegmentArrives{}.with_seqno(isn + 1).with_data("abcd"));
+            test.execute(ExpectAckno{Wrap32{isn + 10}});
+            test.execute(ExpectSackBlocks{{{Wrap32{isn + 12}, Wrap32{isn + 14}}}});
+            test.execute(SegmentArrives{}.with_seqno(isn + 10).with_data("jk"));
+            test.execute(ExpectAckno{Wrap32{isn + 14}});
+            test.execute(ExpectSackBlocks{{}});
+            test.execute(ReadAll{"abcdefghijklm"});
+        }
+
+        for (const auto engine : {Reassembler::Engine::IntervalMap, Reassembler::Engine::Bitmap})
+        {
+            const uint32_t isn = uniform_int_distribution<uint32_t>{0, UINT32_MAX}(rd);
+            TCPReceiverTestHarness test{"at most four SACK blocks", 4000, engine};
+            test.execute(SegmentArrives{}.with_syn().with_sack_permitted().with_seqno(isn));
+            for (const uint32_t offset : {11, 21, 31, 51, 41})
+            {
+                test.execute(SegmentArrives{}.with_seqno(isn + offset).with_data("xx"));
+            }
+            test.execute(ExpectSackBlocks{{{Wrap32{isn + 41}, Wrap32{isn + 43}},
+                                           {Wrap32{isn + 11}, Wrap32{isn + 13}},
+                                           {Wrap32{isn + 21}, Wrap32{isn + 23}},
+                                           {Wrap32{isn + 31}, Wrap32{isn + 33}}}});
+        }
+
+        for (const auto engine : {Reassembler::Engine::IntervalMap, Reassembler::Engine::Bitmap})
+        {
+            const uint32_t isn = uniform_int_distribution<uint32_t>{0, UINT32_MAX}(rd);
+            TCPReceiverTestHarness test{"a block reaching the end of the stream covers the FIN", 4000, engine};
+            test.execute(SegmentArrives{}.with_syn().with_sack_permitted().with_seqno(isn));
+            test.execute(SegmentArrives{}.with_seqno(isn + 5).with_data("efg").with_fin());
+            test.execute(ExpectSackBlocks{{{Wrap32{isn + 5}, Wrap32{isn + 9}}}});
+            test.execute(SegmentArrives{}.with_seqno(isn + 3).with_data("c"));
+            test.execute(ExpectSackBlocks{{{Wrap32{isn + 3}, Wrap32{isn + 4}}, {Wrap32{isn + 5}, Wrap32{isn + 9}}}});
+            test.execute(SegmentArrives{}.with_seqno(isn + 1).with_data("abcd"));
+            test.execute(ExpectAckno{Wrap32{isn + 9}});
+            test.execute(ExpectSackBlocks{{}});
+        }
+
+        sack_option_roundtrip_test(uniform_int_distribution<uint32_t>{0, UINT32_MAX}(rd));
+    }
+    catch (const exception &e)
+    {
+        cerr << e.what() << endl;
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,215 @@
+#include <iostream>
+#include <cstdint>
+#include <cstdlib>
+#include <numeric>
+#include <stdexcept>
+#include <string>
+#include "parser.h"
+#include "random.h"
+#include "receiver_test_harness.h"
+#include "tcp_over_ip.h"
+#include "tcp_segment.h"
+using namespace std;
+
+// 选项经过序列化和解析后保持不变，超过 14 的移位数按 14 处理
+void window_scale_option_test(uint32_t isn)
+{
+    for (const uint8_t shift : {0, 7, 14, 20})
+    {
+        TCPSegment seg;
+        seg.message.sender.seqno = Wrap32{isn};
+        seg.message.sender.SYN = true;
+        seg.message.sender.window_scale = shift;
+        seg.message.receiver.window_size = 4321;
+        seg.compute_checksum(0);
+        if (seg.header_length() != 24)
+        {
+            throw runtime_error("window scale option should take 4 bytes of header, got " + to_string(seg.header_length() - 20));
+        }
+
+        TCPSegment parsed;
+        if (!parse(parsed, serialize(seg), 0))
+        {
+            throw runtime_error("segment with window scale option failed to parse");
+        }
+        if (parsed.message.sender.window_scale != min<uint8_t>(shift, 14) || parsed.message.receiver.window_size != 4321)
+        {
+            throw runtime_error("window scale option " + to_string(shift) + " changed on the wire");
+        }
+    }
+
+    // 只有 SYN 携带窗口扩大选项
+    TCPSegment ack;
+    ack.message.sender.seqno = Wrap32{isn};
+    ack.message.sender.window_scale = 7;
+    ack.message.receiver.ackno = Wrap32{isn};
+    if (ack.header_length() != 20)
+    {
+        throw runtime_error("window scale option should only appear on SYN segments");
+    }
+}
+
+// 两个适配器交换 SYN 后，窗口在线路上按各自声明的移位数缩放，解包后还原
+void adapter_scaling_test(uint32_t isn)
+{
+    TCPOverIPv4Adapter a, b;
+    a.config_mut().source = Address{"10.0.0.1", 1000};
+    a.config_mut().destination = Address{"10.0.0.2", 2000};
+    b.config_mut().source = a.config().destination;
+    b.config_mut().destination = a.config().source;
+
+    // 一次往返：A 发出 msg，B 收到；返回 B 解包后的消息
+    const auto a_to_b = [&](const TCPMessage &msg, optional<uint16_t> expected_raw)
+    {
+        const InternetDatagram dgram = a.wrap_tcp_in_ip(msg);
+        const size_t tcp_len = accumulate(dgram.payload.begin(), dgram.payload.end(), size_t{}, [](size_t n, const string &s) { return n + s.size(); });
+        if (dgram.header.len != dgram.header.hlen * 4 + tcp_len)
+        {
+            throw runtime_error("IPv4 length " + to_string(dgram.header.len) + " does not cover the TCP options");
+        }
+        if (expected_raw.has_value() && raw_window(dgram) != *expected_raw)
+        {
+            throw runtime_error("expected window field " + to_string(*expected_raw) + " on the wire, got " + to_string(raw_window(dgram)));
+        }
+        const auto received = b.unwrap_tcp_in_ip(dgram);
+        if (!received.has_value())
+        {
+            throw runtime_error("adapter rejected a valid datagram");
+        }
+        return *received;
+    };
+
+    // SYN 中的窗口不缩放
+    TCPMessage syn;
+    syn.sender.seqno = Wrap32{isn};
+    syn.sender.SYN = true;
+    syn.sender.window_scale = 4;
+    syn.receiver.window_size = 60000;
+    if (a_to_b(syn, 60000).sender.window_scale != 4)
+    {
+        throw runtime_error("window scale option lost in the adapter");
+    }
+
+    // 对方还没有声明，窗口按原样发送
+    TCPMessage ack;
+    ack.sender.seqno = Wrap32{isn + 1};
+    ack.receiver.ackno = Wrap32{isn};
+    ack.receiver.window_size = 50000;
+    if (a_to_b(ack, 50000).receiver.window_size != 50000)
+    {
+        throw runtime_error("window was scaled before both sides declared the option");
+    }
+
+    // B 在 SYN/ACK 中声明移位数 2，此后 A 的窗口右移 4 位发送，B 左移 4 位还原
+    TCPMessage synack;
+    synack.sender.seqno = Wrap32{isn + 7};
+    synack.sender.SYN = true;
+    synack.sender.window_scale = 2;
+    synack.receiver.ackno = Wrap32{isn + 1};
+    synack.receiver.window_size = 60000;
+    if (!a.unwrap_tcp_in_ip(b.wrap_tcp_in_ip(synack)).has_value())
+    {
+        throw runtime_error("adapter rejected the SYN/ACK");
+    }
+    ack.receiver.window_size = 1'000'000;
+    const auto scaled = a_to_b(ack, 62500);
+    if (scaled.receiver.window_size != 1'000'000)
+    {
+        throw runtime_error("expected a window of 1000000 after scaling, got " + to_string(scaled.receiver.window_size));
+    }
+
+    // B 发往 A 的窗口按 B 声明的移位数缩放
+    TCPMessage reply;
+    reply.sender.seqno = Wrap32{isn + 8};
+    reply.receiver.ackno = Wrap32{isn + 1};
+    reply.receiver.window_size = 200'000;
+    const InternetDatagram dgram = b.wrap_tcp_in_ip(reply);
+    const auto unwrapped = a.unwrap_tcp_in_ip(dgram);
+    if (raw_window(dgram) != 50000 || !unwrapped.has_value() || unwrapped->receiver.window_size != 200'000)
+    {
+        throw runtime_error("window from the SYN/ACK side was not scaled by its own shift");
+    }
+}
+
+int main()
+{
+    try
+    {
+        auto rd = get_random_engine();
+
+        {
+            const uint32_t isn = uniform_int_distribution<uint32_t>{0, UINT32_MAX}(rd);
+            TCPReceiverTestHarness test{"window stays below 65536 unless both sides scale", 1'000'000, Reassembler::Engine::IntervalMap, 4};
+            test.execute(ExpectWindow{65535});
+            test.execute(SegmentArrives{}.with_syn().with_seqno(isn));
+            test.execute(ExpectWindow{65535});
+        }
+
+        for (const auto engine : {Reassembler::Engine::IntervalMap, Reassembler::Engine::Bitmap})
+        {
+            const uint32_t isn = uniform_int_distribution<uint32_t>{0, UINT32_MAX}(rd);
+            TCPReceiverTestHarness test{"scaled window covers the whole buffer", 1'000'007, engine, 4};
+            test.execute(SegmentArrives{}.with_syn().with_window_scale(2).with_seqno(isn));
+
+            // 窗口向下取整到 16 的倍数，移位后不丢失精度
+            test.execute(ExpectWindow{1'000'000});
+            test.execute(AckSent{});
+            test.execute(SegmentArrives{}.with_seqno(isn + 1).with_data(string(100'000, 'x')));
+            test.execute(ExpectWindow{900'000});
+            test.execute(AckSent{});
+
+            // 可用容量 899'997，向下取整为 899'984 会使右边缘从 1'000'000 左移到 999'994，
+            // 窗口不能收缩，改为向上取整
+            test.execute(SegmentArrives{}.with_seqno(isn + 100'001).with_data("abcdefghij"));
+            test.execute(ExpectWindow{900'000});
+            test.execute(AckSent{});
+            test.execute(BytesPushed{100'010});
+
+            // 应用读走数据后右边缘右移，窗口照常向下取整
+            test.execute(ReadAll{string(100'000, 'x') + "abcdefghij"});
+            test.execute(ExpectWindow{1'000'000});
+        }
+
+        for (const auto engine : {Reassembler::Engine::IntervalMap, Reassembler::Engine::Bitmap})
+        {
+            // 每个报文段之后都发出确认、应用不读取数据：向上取整只针对记录的右边缘，
+            // 不会每次把右边缘再推前一点，缓冲区满时通告零窗口
+            const uint32_t isn = uniform_int_distribution<uint32_t>{0, UINT32_MAX}(rd);
+            TCPReceiverTestHarness test{"scaled window closes when the buffer fills", 1'000'000, engine, 4};
+            test.execute(SegmentArrives{}.with_syn().with_window_scale(2).with_seqno(isn));
+            test.execute(ExpectWindow{1'000'000});
+            test.execute(AckSent{});
+            for (uint64_t pushed = 0; pushed < 1'000'000; pushed += 1000)
+            {
+                test.execute(SegmentArrives{}.with_seqno(isn + 1 + static_cast<uint32_t>(pushed)).with_data(string(1000, 'x')));
+                test.execute(AckSent{});
+            }
+            test.execute(BytesPushed{1'000'000});
+            test.execute(ExpectWindow{0});
+        }
+
+        {
+            const uint32_t isn = uniform_int_distribution<uint32_t>{0, UINT32_MAX}(rd);
+            TCPReceiverTestHarness test{"no scaling unless we declared it", 1'000'000};
+            test.execute(SegmentArrives{}.with_syn().with_window_scale(4).with_seqno(isn));
+            test.execute(ExpectWindow{65535});
+        }
+
+        {
+            const uint32_t isn = uniform_int_distribution<uint32_t>{0, UINT32_MAX}(rd);
+            TCPReceiverTestHarness test{"scaled window is limited by the 16-bit field", 1'000'000, Reassembler::Engine::IntervalMap, 1};
+            test.execute(SegmentArrives{}.with_syn().with_window_scale(0).with_seqno(isn));
+            test.execute(ExpectWindow{131070});
+        }
+
+        window_scale_option_test(uniform_int_distribution<uint32_t>{0, UINT32_MAX}(rd));
+        adapter_scaling_test(uniform_int_distribution<uint32_t>{0, UINT32_MAX}(rd));
+    }
+    catch (const exception &e)
+    {
+        cerr << e.what() << endl;
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
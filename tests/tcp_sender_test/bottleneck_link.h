@@ -0,0 +1,139 @@
+#ifndef BOTTLENECK_LINK_H
+#define BOTTLENECK_LINK_H
+
+#include <algorithm>
+#include <cstdint>
+#include <deque>
+#include <string>
+#include <utility>
+#include <vector>
+#include "tcp_config.h"
+#include "tcp_receiver.h"
+#include "tcp_sender.h"
+
+// 瓶颈链路的参数：发送端 → 尾部丢弃的瓶颈队列（固定速率出队）→ 传播时延 → 接收端，
+// 确认沿不受限的反向路径以相同的传播时延返回。时间以 1 毫秒为步长推进。
+struct BottleneckConfig
+{
+    uint64_t rate_bytes_per_ms = 1000;    // 瓶颈速率（8 Mbit/s）
+    uint64_t one_way_delay_ms = 20;       // 单向传播时延
+    size_t queue_packets = 10;            // 瓶颈队列最多容纳的报文数
+    uint64_t header_bytes = 40;           // 每个报文计入速率的首部开销
+    std::vector<uint64_t> drop_packets{}; // 额外丢弃的报文：发送端发出的第几个报文（从 0 开始计数）
+    uint64_t mtu_bytes = UINT64_MAX;      // 路径 MTU：有效载荷加首部超过它的报文被丢弃
+};
+
+// 一次传输的统计结果
+struct TransferResult
+{
+    bool finished{};              // 接收端是否收到了完整且正确的数据
+    uint64_t duration_ms{};       // 从开始到接收端读完全部数据的时间
+    uint64_t bytes_delivered{};   // 交付给接收端应用的字节数
+    uint64_t packets_sent{};      // 发送端发出的报文数（含重传）
+    uint64_t packets_dropped{};   // 瓶颈队列丢弃的报文数
+    uint64_t total_queue_delay{}; // 所有出队报文在瓶颈队列中等待时间之和
+    uint64_t max_queue_delay{};   // 单个报文在瓶颈队列中的最长等待时间
+    uint64_t max_stall_ms{};      // 接收端应用两次读到新数据之间的最长间隔，即丢包后的恢复时间
+    uint64_t max_burst_packets{}; // 发送端在同一毫秒内连续发出的最多报文数
+
+    double goodput_mbps() const { return duration_ms ? 8.0 * static_cast<double>(bytes_delivered) / static_cast<double>(duration_ms) / 1000.0 : 0; }
+    double mean_queue_delay_ms() const
+    {
+        const uint64_t dequeued = packets_sent - packets_dropped;
+        return dequeued ? static_cast<double>(total_queue_delay) / static_cast<double>(dequeued) : 0;
+    }
+};
+
+// 通过瓶颈链路把 data 从 TCPSender 传给 TCPReceiver，time_limit_ms 后仍未完成则放弃
+inline TransferResult run_bottleneck_transfer(const TCPConfig &cfg, const BottleneckConfig &link, const std::string &data, uint64_t time_limit_ms)
+{
+    TCPSender sender{ByteStream{cfg.send_capacity}, cfg.isn, cfg.rt_timeout, TCPSender::Options::from_config(cfg)};
+    TCPReceiver receiver{Reassembler{ByteStream{cfg.recv_capacity}}, cfg.window_scale()};
+
+    TransferResult result;
+    std::deque<std::pair<uint64_t, TCPSenderMessage>> queue;      // 瓶颈队列：入队时间、报文
+    std::deque<std::pair<uint64_t, TCPSenderMessage>> forward;    // 去程传播中：到达时间、报文
+    std::deque<std::pair<uint64_t, TCPReceiverMessage>> backward; // 回程传播中：到达时间、确认
+    uint64_t now = 0;
+    uint64_t credit = 0; // 瓶颈本毫秒内还能发出的字节数
+    size_t written = 0;
+    std::string received;
+
+    uint64_t last_delivery = 0;
+    uint64_t burst = 0; // 发送端本毫秒内发出的报文数
+    const auto transmit = [&](const TCPSenderMessage &msg)
+    {
+        result.max_burst_packets = std::max(result.max_burst_packets, ++burst);
+        const bool forced_drop = std::find(link.drop_packets.begin(), link.drop_packets.end(), result.packets_sent) != link.drop_packets.end();
+        ++result.packets_sent;
+        const bool too_big = msg.payload.size() + link.header_bytes > link.mtu_bytes;
+        if (forced_drop || too_big || queue.size() >= link.queue_packets)
+        {
+            ++result.packets_dropped;
+            return;
+        }
+        queue.emplace_back(now, msg);
+    };
+    const auto wire_size = [&](const TCPSenderMessage &msg) { return msg.payload.size() + link.header_bytes; };
+
+    for (; now < time_limit_ms && !receiver.reader().is_finished(); ++now)
+    {
+        // 应用向发送端写入数据
+        const size_t n = std::min<size_t>(data.size() - written, sender.writer().available_capacity());
+        sender.writer().push(std::string_view{data}.substr(written, n));
+        written += n;
+        if (written == data.size() && !sender.writer().is_closed())
+        {
+            sender.writer().close();
+        }
+
+        // 确认到达发送端
+        burst = 0;
+        while (!backward.empty() && backward.front().first <= now)
+        {
+            sender.receive(backward.front().second);
+            backward.pop_front();
+        }
+        sender.push(transmit);
+        sender.tick(1, transmit);
+
+        // 瓶颈按固定速率出队；队列空闲时不积累发送额度
+        credit = queue.empty() ? 0 : credit + link.rate_bytes_per_ms;
+        while (!queue.empty() && credit >= wire_size(queue.front().second))
+        {
+            credit -= wire_size(queue.front().second);
+            const uint64_t delay = now - queue.front().first;
+            result.total_queue_delay += delay;
+            result.max_queue_delay = std::max(result.max_queue_delay, delay);
+            forward.emplace_back(now + link.one_way_delay_ms, std::move(queue.front().second));
+            queue.pop_front();
+        }
+
+        // 报文到达接收端，每个报文回复一个确认
+        while (!forward.empty() && forward.front().first <= now)
+        {
+            receiver.receive(std::move(forward.front().second));
+            forward.pop_front();
+            backward.emplace_back(now + link.one_way_delay_ms, receiver.send());
+            receiver.sent();
+        }
+        if (receiver.reader().bytes_buffered())
+        {
+            result.max_stall_ms = received.empty() ? 0 : std::max(result.max_stall_ms, now - last_delivery);
+            last_delivery = now;
+        }
+        while (receiver.reader().bytes_buffered())
+        {
+            const auto view = receiver.reader().peek();
+            received += view;
+            receiver.reader().pop(view.size());
+        }
+    }
+
+    result.duration_ms = now;
+    result.bytes_delivered = received.size();
+    result.finished = receiver.reader().is_finished() && received == data;
+    return result;
+}
+
+#endif
@@ -0,0 +1,140 @@
+#include <iostream>          // 引入输入输出流库，用于输出信息
+#include <fstream>           // 引入文件流库，用于文件操作
+#include <iomanip>           // 引入格式化库，用于设置输出格式
+#include <random>            // 引入随机数库，提供随机数生成
+#include "bottleneck_link.h" // 引入瓶颈链路模拟
+
+using namespace std; // 使用标准命名空间，简化代码书写
+
+// 返回拥塞控制算法的名称
+const char *algorithm_name(CongestionControl::Algorithm algorithm)
+{
+    switch (algorithm)
+    {
+    case CongestionControl::Algorithm::NewReno:
+        return "NewReno";
+    case CongestionControl::Algorithm::Cubic:
+        return "CUBIC";
+    case CongestionControl::Algorithm::None:
+        break;
+    }
+    return "none";
+}
+
+// 通过同一条瓶颈链路传输 data，报告有效吞吐量、排队时延和发送端的最大突发
+TransferResult bottleneck_test(CongestionControl::Algorithm algorithm, const BottleneckConfig &link, const string &data, bool pacing = false)
+{
+    TCPConfig cfg;
+    cfg.congestion_control = algorithm;
+    cfg.pacing = pacing;
+    const string name = string{algorithm_name(algorithm)} + (pacing ? "+pacing" : "");
+    const auto result = run_bottleneck_transfer(cfg, link, data, 600'000);
+    // 没有拥塞控制时每个窗口都会丢多个报文，每个空洞都要等一次超时，允许它在时限内传不完
+    if (!result.finished && algorithm != CongestionControl::Algorithm::None)
+    {
+        throw runtime_error(name + ": transfer through the bottleneck did not complete");
+    }
+
+    fstream debug_output;          // 创建文件流对象
+    debug_output.open("/dev/tty"); // 打开终端设备
+
+    cout << setw(14) << name << ": goodput " << fixed << setprecision(2) << result.goodput_mbps()
+         << " Mbit/s, queueing delay mean " << result.mean_queue_delay_ms() << " ms / max " << result.max_queue_delay
+         << " ms, " << result.packets_dropped << " of " << result.packets_sent << " packets dropped, max burst "
+         << result.max_burst_packets << " packets"
+         << (result.finished ? "" : " (incomplete after " + to_string(result.duration_ms / 1000) + " s)") << "\n";
+
+    debug_output << "  " << setw(14) << name << " bottleneck goodput: " << fixed << setprecision(2)
+                 << result.goodput_mbps() << " Mbit/s, mean queueing delay: " << result.mean_queue_delay_ms() << " ms\n";
+    return result;
+}
+
+// 短连接（10 个报文段）丢失最后 drops 个报文时，从开始到接收端读完全部数据的时间
+uint64_t tail_loss_test(uint64_t drops, bool rack)
+{
+    BottleneckConfig link;
+    for (uint64_t i = 0; i < drops; ++i)
+    {
+        link.drop_packets.push_back(10 - i); // 第 0 个报文是 SYN
+    }
+    TCPConfig cfg;
+    cfg.adaptive_rto = true;
+    cfg.sack = true;
+    cfg.rack = rack;
+    const auto result = run_bottleneck_transfer(cfg, link, string(10'000, 'x'), 60'000);
+    if (!result.finished)
+    {
+        throw runtime_error("short flow with tail loss did not complete");
+    }
+    return result.duration_ms;
+}
+
+// 执行拥塞控制基准测试
+void program_body()
+{
+    const string data = []
+    {
+        default_random_engine rd{1380};
+        uniform_int_distribution<char> ud;
+        string ret;
+        for (size_t i = 0; i < 4'000'000; ++i)
+        {
+            ret += ud(rd);
+        }
+        return ret;
+    }();
+
+    // 8 Mbit/s、往返 40 ms（约 38 个报文的带宽时延积）、10 个报文的队列：
+    // 64000 字节的接收窗口超过了链路加队列能容纳的数据量
+    const BottleneckConfig link;
+    cout << "Bottleneck " << 8 * link.rate_bytes_per_ms / 1000 << " Mbit/s, RTT " << 2 * link.one_way_delay_ms
+         << " ms, queue " << link.queue_packets << " packets, " << data.size() << " bytes\n";
+
+    const auto none = bottleneck_test(CongestionControl::Algorithm::None, link, data);
+    const auto reno = bottleneck_test(CongestionControl::Algorithm::NewReno, link, data);
+    const auto cubic = bottleneck_test(CongestionControl::Algorithm::Cubic, link, data);
+    const auto none_paced = bottleneck_test(CongestionControl::Algorithm::None, link, data, true);
+    bottleneck_test(CongestionControl::Algorithm::NewReno, link, data, true);
+    bottleneck_test(CongestionControl::Algorithm::Cubic, link, data, true);
+
+    cout << "Short flow of 10 segments, completion time with the last N packets lost:\n";
+    uint64_t total[2] = {};
+    for (uint64_t drops = 0; drops <= 5; ++drops)
+    {
+        const uint64_t plain = tail_loss_test(drops, false);
+        const uint64_t rack = tail_loss_test(drops, true);
+        total[false] += plain;
+        total[true] += rack;
+        cout << "  N=" << drops << ": " << setw(5) << plain << " ms, with RACK-TLP " << setw(5) << rack << " ms\n";
+    }
+
+    // 拥塞控制应当避免不加控制时的持续丢包和超时
+    if (reno.goodput_mbps() <= none.goodput_mbps() || cubic.goodput_mbps() <= none.goodput_mbps())
+    {
+        throw runtime_error("congestion control did not improve goodput through the bottleneck");
+    }
+    // 尾部丢失由探测发现，而不是等待 RTO
+    if (total[true] >= total[false])
+    {
+        throw runtime_error("RACK-TLP did not shorten short flows with tail loss");
+    }
+    // 节奏控制把每个往返的突发分散开
+    if (none_paced.max_burst_packets >= none.max_burst_packets)
+    {
+        throw runtime_error("pacing did not reduce the sender's bursts");
+    }
+}
+
+int main()
+{
+    try
+    {
+        program_body();
+    }
+    catch (const exception &e)
+    {
+        cerr << "Exception: " << e.what() << "\n";
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,168 @@
+#include <iostream>
+#include <cstdint>
+#include <cstdlib>
+#include <exception>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include "random.h"
+#include "sender_test_harness.h"
+using namespace std;
+
+// 期望连续发出 n 个满载的报文段
+void expect_full_segments(TCPSenderTestHarness &test, size_t n)
+{
+    for (size_t i = 0; i < n; ++i)
+    {
+        test.execute(ExpectMessage{}.with_no_flags().with_payload_size(TCPConfig::MAX_PAYLOAD_SIZE));
+    }
+    test.execute(ExpectNoSegment{});
+}
+
+// 按三次函数增长的窗口：丢包后先快速、后缓慢地回到丢包前的窗口，之后加速探测
+void cubic_curve_test()
+{
+    constexpr uint64_t MSS = 1000;
+    constexpr uint64_t RTT_MS = 100;
+    const auto cc = CongestionControl::make(CongestionControl::Algorithm::Cubic, MSS);
+
+    // 慢启动到 100 个报文段后发生丢包
+    while (cc->cwnd() < 100 * MSS)
+    {
+        cc->on_ack(MSS, 0, 0);
+    }
+    cc->on_loss(cc->cwnd(), 0);
+    if (cc->cwnd() != 70 * MSS || cc->ssthresh() != 70 * MSS)
+    {
+        throw runtime_error("CUBIC should reduce the window to 0.7 of its size on loss");
+    }
+
+    // 每个往返确认一整个窗口；K = cbrt(30 / 0.4) 约为 4.2 秒
+    const auto window_at = [&](uint64_t until_ms)
+    {
+        for (uint64_t now = 0; now < until_ms; now += RTT_MS)
+        {
+            cc->on_ack(cc->cwnd(), 0, now);
+        }
+        return cc->cwnd() / MSS;
+    };
+    const uint64_t halfway = window_at(2100);
+    const uint64_t plateau = window_at(4300);
+    const uint64_t probing = window_at(8500);
+    if (halfway < 90 || halfway >= 100)
+    {
+        throw runtime_error("CUBIC should be most of the way back to W_max halfway to K, got " + to_string(halfway));
+    }
+    if (plateau < 97 || plateau > 103)
+    {
+        throw runtime_error("CUBIC should plateau near W_max at K, got " + to_string(plateau));
+    }
+    if (probing < 120)
+    {
+        throw runtime_error("CUBIC should probe beyond W_max after K, got " + to_string(probing));
+    }
+}
+
+int main()
+{
+    try
+    {
+        auto rd = get_random_engine();
+
+        {
+            TCPConfig cfg;
+            const Wrap32 isn(rd());
+            cfg.isn = isn;
+
+            TCPSenderTestHarness test{"No congestion control: only the receiver window limits sending", cfg};
+            connect(test, isn);
+            test.execute(Push{string(10000, 'a')});
+            expect_full_segments(test, 10);
+            test.execute(ExpectSeqnosInFlight{10000});
+        }
+
+        {
+            TCPConfig cfg;
+            const Wrap32 isn(rd());
+            cfg.isn = isn;
+            cfg.congestion_control = CongestionControl::Algorithm::NewReno;
+
+            TCPSenderTestHarness test{"NewReno slow start, timeout and congestion avoidance", cfg};
+            connect(test, isn);
+            test.execute(ExpectCongestionWindow{4000});
+
+            // 初始窗口为 4 个报文段，每确认一个报文段增加一个 MSS
+            test.execute(Push{string(10000, 'a')});
+            expect_full_segments(test, 4);
+            test.execute(AckReceived{Wrap32{isn + 4001}}.with_win(60000));
+            test.execute(ExpectCongestionWindow{5000});
+            expect_full_segments(test, 5);
+
+            // 超时：ssthresh 为在途数据的一半，窗口回到一个报文段
+            test.execute(Tick{1000});
+            test.execute(ExpectMessage{}.with_payload_size(1000).with_seqno(isn + 4001));
+            test.execute(ExpectCongestionWindow{1000});
+            test.execute(ExpectSlowStartThreshold{2500});
+            test.execute(ExpectNoSegment{});
+
+            test.execute(AckReceived{Wrap32{isn + 9001}}.with_win(60000));
+            test.execute(ExpectCongestionWindow{2000});
+            expect_full_segments(test, 1);
+            test.execute(Push{string(10000, 'b')});
+            expect_full_segments(test, 1);
+
+            // 越过 ssthresh 后进入拥塞避免，每确认一整个窗口才增加一个 MSS
+            test.execute(AckReceived{Wrap32{isn + 11001}}.with_win(60000));
+            test.execute(ExpectCongestionWindow{3000});
+            expect_full_segments(test, 3);
+            test.execute(AckReceived{Wrap32{isn + 14001}}.with_win(60000));
+            test.execute(ExpectCongestionWindow{4000});
+            expect_full_segments(test, 4);
+            test.execute(AckReceived{Wrap32{isn + 16001}}.with_win(60000));
+            test.execute(ExpectCongestionWindow{4000});
+            expect_full_segments(test, 2);
+        }
+
+        {
+            TCPConfig cfg;
+            const Wrap32 isn(rd());
+            cfg.isn = isn;
+            cfg.congestion_control = CongestionControl::Algorithm::Cubic;
+
+            TCPSenderTestHarness test{"CUBIC reduces by beta on timeout", cfg};
+            connect(test, isn);
+            test.execute(Push{string(10000, 'a')});
+            expect_full_segments(test, 4);
+            test.execute(Tick{1000});
+            test.execute(ExpectMessage{}.with_payload_size(1000).with_seqno(isn + 1));
+            test.execute(ExpectCongestionWindow{1000});
+            test.execute(ExpectSlowStartThreshold{2800});
+            test.execute(ExpectNoSegment{});
+        }
+
+        {
+            TCPConfig cfg;
+            const Wrap32 isn(rd());
+            cfg.isn = isn;
+            cfg.congestion_control = CongestionControl::Algorithm::NewReno;
+
+            TCPSenderTestHarness test{"Zero-window probing is not a congestion signal", cfg};
+            connect(test, isn);
+            test.execute(AckReceived{Wrap32{isn + 1}}.with_win(0));
+            test.execute(Push{"abc"});
+            test.execute(ExpectMessage{}.with_data("a"));
+            test.execute(Tick{1000});
+            test.execute(ExpectMessage{}.with_data("a"));
+            test.execute(ExpectCongestionWindow{4000});
+        }
+
+        cubic_curve_test();
+    }
+    catch (const exception &e)
+    {
+        cerr << e.what() << endl;
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
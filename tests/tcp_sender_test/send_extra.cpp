@@ -466,13 +466,16 @@ int main()
             test.execute(AckReceived{Wrap32{isn + 8}}.with_win(1000));
             test.execute(AckReceived{Wrap32{isn + 8}}.with_win(1000));
             test.execute(AckReceived{Wrap32{isn + 8}}.with_win(1000));
+            // 有数据在途时的第三个重复确认触发快速重传
+            test.execute(
+                ExpectMessage{}.with_payload_size(4).with_data("ijkl").with_seqno(isn + 8).with_fin(true));
             test.execute(AckReceived{Wrap32{isn + 12}}.with_win(1000));
             test.execute(AckReceived{Wrap32{isn + 12}}.with_win(1000));
             test.execute(AckReceived{Wrap32{isn + 12}}.with_win(1000));
             test.execute(AckReceived{Wrap32{isn + 1}}.with_win(1000));
+            // 数据已被确认，超时后只重传尚未确认的 FIN
             test.execute(Tick{5 * rto});
-            test.execute(
-                ExpectMessage{}.with_payload_size(4).with_data("ijkl").with_seqno(isn + 8).with_fin(true));
+            test.execute(ExpectMessage{}.with_payload_size(0).with_seqno(isn + 12).with_fin(true));
             test.execute(ExpectNoSegment{});
             test.execute(AckReceived(Wrap32{isn + 13}).with_win(1000));
             test.execute(AckReceived(Wrap32{isn + 1}).with_win(1000));
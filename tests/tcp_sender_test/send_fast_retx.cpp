@@ -0,0 +1,171 @@
+#include <iostream>
+#include <cstdint>
+#include <cstdlib>
+#include <exception>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include "bottleneck_link.h"
+#include "random.h"
+#include "sender_test_harness.h"
+using namespace std;
+
+// 在瓶颈链路上丢掉一个报文，测量接收端等待空洞被补上的时间
+void time_to_recover_test()
+{
+    const string data(500'000, 'x');
+    TCPConfig cfg;
+    cfg.congestion_control = CongestionControl::Algorithm::NewReno;
+    BottleneckConfig link;
+    link.queue_packets = 100; // 队列足够大，只有人为丢弃的那个报文丢失
+    link.drop_packets = {100};
+
+    const auto result = run_bottleneck_transfer(cfg, link, data, 60'000);
+    if (!result.finished || result.packets_dropped != 1)
+    {
+        throw runtime_error("time-to-recover: transfer with one lost segment did not complete");
+    }
+    // 快速重传在约一个往返后补上空洞，不必等待 1 秒的超时
+    const uint64_t rtt = 2 * link.one_way_delay_ms;
+    if (result.max_stall_ms > 3 * rtt)
+    {
+        throw runtime_error("time-to-recover: receiver stalled " + to_string(result.max_stall_ms) + " ms for a single loss (RTT "
+                            + to_string(rtt) + " ms, RTO " + to_string(cfg.rt_timeout) + " ms)");
+    }
+}
+
+int main()
+{
+    try
+    {
+        auto rd = get_random_engine();
+
+        {
+            TCPConfig cfg;
+            const Wrap32 isn(rd());
+            cfg.isn = isn;
+            cfg.rt_timeout = 1000;
+
+            TCPSenderTestHarness test{"Third duplicate ACK retransmits the first segment immediately", cfg};
+            connect(test, isn);
+            test.execute(Push{string(5000, 'a')});
+            for (uint32_t i = 0; i < 5; ++i)
+            {
+                expect_segment(test, isn + 1 + 1000 * i);
+            }
+            test.execute(ExpectNoSegment{});
+
+            // 第二个报文段丢失，后面三个报文段各触发一个重复确认
+            test.execute(AckReceived{Wrap32{isn + 1001}}.with_win(60000));
+            test.execute(AckReceived{Wrap32{isn + 1001}}.with_win(60000));
+            test.execute(AckReceived{Wrap32{isn + 1001}}.with_win(60000));
+            test.execute(ExpectNoSegment{});
+            test.execute(AckReceived{Wrap32{isn + 1001}}.with_win(60000));
+            expect_segment(test, isn + 1001);
+            test.execute(ExpectNoSegment{});
+            test.execute(ExpectInFastRecovery{true});
+
+            // 更多的重复确认不会再次重传
+            test.execute(AckReceived{Wrap32{isn + 1001}}.with_win(60000));
+            test.execute(ExpectNoSegment{});
+
+            test.execute(AckReceived{Wrap32{isn + 5001}}.with_win(60000));
+            test.execute(ExpectInFastRecovery{false});
+            test.execute(ExpectSeqnosInFlight{0});
+            test.execute(Tick{1000});
+            test.execute(ExpectNoSegment{});
+        }
+
+        {
+            TCPConfig cfg;
+            const Wrap32 isn(rd());
+            cfg.isn = isn;
+
+            TCPSenderTestHarness test{"Window updates are not duplicate ACKs", cfg};
+            connect(test, isn);
+            test.execute(Push{string(3000, 'a')});
+            for (uint32_t i = 0; i < 3; ++i)
+            {
+                expect_segment(test, isn + 1 + 1000 * i);
+            }
+            test.execute(AckReceived{Wrap32{isn + 1}}.with_win(50000));
+            test.execute(AckReceived{Wrap32{isn + 1}}.with_win(40000));
+            test.execute(AckReceived{Wrap32{isn + 1}}.with_win(30000));
+            test.execute(ExpectNoSegment{});
+            test.execute(ExpectInFastRecovery{false});
+        }
+
+        {
+            TCPConfig cfg;
+            const Wrap32 isn(rd());
+            cfg.isn = isn;
+            cfg.congestion_control = CongestionControl::Algorithm::NewReno;
+
+            TCPSenderTestHarness test{"NewReno recovery keeps the pipe full", cfg};
+            connect(test, isn);
+            test.execute(Push{string(10000, 'a')});
+            for (uint32_t i = 0; i < 4; ++i)
+            {
+                expect_segment(test, isn + 1 + 1000 * i);
+            }
+            test.execute(ExpectNoSegment{});
+
+            // 第一个报文段丢失：ssthresh = 4000 / 2，窗口膨胀 3 个报文段后可以再发一个新报文段
+            test.execute(AckReceived{Wrap32{isn + 1}}.with_win(60000));
+            test.execute(AckReceived{Wrap32{isn + 1}}.with_win(60000));
+            test.execute(AckReceived{Wrap32{isn + 1}}.with_win(60000));
+            expect_segment(test, isn + 1);
+            expect_segment(test, isn + 4001);
+            test.execute(ExpectNoSegment{});
+            test.execute(ExpectSlowStartThreshold{2000});
+
+            // 每个额外的重复确认再放出一个报文段
+            test.execute(AckReceived{Wrap32{isn + 1}}.with_win(60000));
+            expect_segment(test, isn + 5001);
+            test.execute(ExpectNoSegment{});
+
+            // 确认越过进入恢复时的最高序列号：恢复结束，窗口收缩到 ssthresh
+            test.execute(AckReceived{Wrap32{isn + 5001}}.with_win(60000));
+            test.execute(ExpectInFastRecovery{false});
+            test.execute(ExpectCongestionWindow{2000});
+            expect_segment(test, isn + 6001);
+            test.execute(ExpectNoSegment{});
+        }
+
+        {
+            TCPConfig cfg;
+            const Wrap32 isn(rd());
+            cfg.isn = isn;
+
+            TCPSenderTestHarness test{"Partial ACK retransmits the next hole without waiting", cfg};
+            connect(test, isn);
+            test.execute(Push{string(8000, 'a')});
+            for (uint32_t i = 0; i < 8; ++i)
+            {
+                expect_segment(test, isn + 1 + 1000 * i);
+            }
+
+            // 第二个和第五个报文段丢失：第一个确认推进了窗口，之后三个是重复确认
+            for (int i = 0; i < 4; ++i)
+            {
+                test.execute(AckReceived{Wrap32{isn + 1001}}.with_win(60000));
+            }
+            expect_segment(test, isn + 1001);
+            test.execute(AckReceived{Wrap32{isn + 4001}}.with_win(60000));
+            expect_segment(test, isn + 4001);
+            test.execute(ExpectInFastRecovery{true});
+            test.execute(AckReceived{Wrap32{isn + 8001}}.with_win(60000));
+            test.execute(ExpectInFastRecovery{false});
+            test.execute(ExpectNoSegment{});
+        }
+
+        time_to_recover_test();
+    }
+    catch (const exception &e)
+    {
+        cerr << e.what() << endl;
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,248 @@
+#include <iostream>
+#include <cstdint>
+#include <cstdlib>
+#include <exception>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include "bottleneck_link.h"
+#include "parser.h"
+#include "random.h"
+#include "sender_test_harness.h"
+#include "tcp_segment.h"
+using namespace std;
+
+// MSS 选项经过序列化和解析后保持不变
+void mss_option_test(uint32_t isn)
+{
+    TCPSegment seg;
+    seg.message.sender.seqno = Wrap32{isn};
+    seg.message.sender.SYN = true;
+    seg.message.sender.mss = 1460;
+    seg.message.sender.sack_permitted = true;
+    seg.message.sender.window_scale = 7;
+    seg.compute_checksum(0);
+
+    TCPSegment parsed;
+    if (!parse(parsed, serialize(seg), 0))
+    {
+        throw runtime_error("segment with MSS option failed to parse");
+    }
+    const auto &sender = parsed.message.sender;
+    if (sender.mss != 1460 || !sender.sack_permitted || sender.window_scale != 7 || parsed.header_length() != 32)
+    {
+        throw runtime_error("MSS option changed on the wire");
+    }
+}
+
+// 协商更大的 MSS 后，同样的数据用更少的报文发送；路径 MTU 更小时，探测找到能通过的长度
+void packets_per_byte_test()
+{
+    const string data(1'000'000, 'x');
+    const auto transfer = [&](uint16_t mss, bool probing, uint64_t mtu)
+    {
+        BottleneckConfig link;
+        link.mtu_bytes = mtu;
+        TCPConfig cfg;
+        cfg.congestion_control = CongestionControl::Algorithm::NewReno;
+        cfg.mss = mss;
+        cfg.mtu_probing = probing;
+        return run_bottleneck_transfer(cfg, link, data, 60'000);
+    };
+
+    const auto small = transfer(TCPConfig::MAX_PAYLOAD_SIZE, false, 1500);
+    const auto large = transfer(1460, true, 1500);
+    if (!small.finished || !large.finished || 10 * large.packets_sent > 7 * small.packets_sent)
+    {
+        throw runtime_error("MSS 1460 sent " + to_string(large.packets_sent) + " packets, MSS 1000 sent " + to_string(small.packets_sent));
+    }
+
+    // 有效载荷最多 1200 字节的路径：不探测时 1460 字节的报文段全部丢失，探测时收敛到略小于 1200 的长度
+    const auto blackhole = transfer(1460, false, 1240);
+    const auto probed = transfer(1460, true, 1240);
+    if (blackhole.finished || !probed.finished || probed.packets_sent >= small.packets_sent)
+    {
+        throw runtime_error("probing a 1240-byte path MTU: " + to_string(probed.packets_sent) + " packets sent, finished="
+                            + to_string(probed.finished));
+    }
+}
+
+int main()
+{
+    try
+    {
+        auto rd = get_random_engine();
+
+        {
+            TCPConfig cfg;
+            const Wrap32 isn(rd());
+            cfg.isn = isn;
+            cfg.mss = 1460;
+
+            TCPSenderTestHarness test{"SYN carries the MSS option", cfg};
+            test.execute(Push{});
+            test.execute(ExpectMessage{}.with_syn(true).with_mss(1460).with_seqno(isn));
+        }
+
+        {
+            TCPConfig cfg;
+            const Wrap32 isn(rd());
+            cfg.isn = isn;
+            cfg.mss = 1460;
+
+            TCPSenderTestHarness test{"segments use the smaller of both MSS values", cfg};
+            test.execute(ExpectMSS{1460});
+            test.execute(PeerMSS{1200});
+            test.execute(ExpectMSS{1200});
+            connect(test, isn, 0, 60000);
+            test.execute(Push{string(3000, 'a')});
+            expect_segment(test, isn + 1, 1200);
+            expect_segment(test, isn + 1201, 1200);
+            expect_segment(test, isn + 2401, 600);
+            test.execute(ExpectNoSegment{});
+        }
+
+        {
+            TCPConfig cfg;
+            const Wrap32 isn(rd());
+            cfg.isn = isn;
+            cfg.mss = 1460;
+
+            TCPSenderTestHarness test{"peer without MSS option gets 536-byte segments", cfg};
+            test.execute(PeerMSS{nullopt});
+            test.execute(ExpectMSS{536});
+        }
+
+        {
+            TCPConfig cfg;
+            const Wrap32 isn(rd());
+            cfg.isn = isn;
+            cfg.mss = 1460;
+            cfg.mtu_probing = true;
+
+            TCPSenderTestHarness test{"a successful probe raises the segment size", cfg};
+            test.execute(PeerMSS{1460});
+            test.execute(ExpectMSS{1000});
+            connect(test, isn, 0, 60000);
+            test.execute(Push{string(5000, 'a')});
+            expect_segment(test, isn + 1, 1460);
+            expect_segment(test, isn + 1461, 1000);
+            expect_segment(test, isn + 2461, 1000);
+            expect_segment(test, isn + 3461, 1000);
+            expect_segment(test, isn + 4461, 540);
+            test.execute(ExpectNoSegment{});
+            test.execute(AckReceived{Wrap32{isn + 1461}}.with_win(60000));
+            test.execute(ExpectMSS{1460});
+            test.execute(Push{string(3000, 'b')});
+            expect_segment(test, isn + 5001, 1460);
+            expect_segment(test, isn + 6461, 1460);
+            expect_segment(test, isn + 7921, 80);
+            test.execute(ExpectNoSegment{});
+        }
+
+        {
+            TCPConfig cfg;
+            const Wrap32 isn(rd());
+            cfg.isn = isn;
+            cfg.mss = 1460;
+            cfg.mtu_probing = true;
+            cfg.congestion_control = CongestionControl::Algorithm::NewReno;
+
+            TCPSenderTestHarness test{"a lost probe is resent in smaller segments without reducing cwnd", cfg};
+            test.execute(PeerMSS{1460});
+            connect(test, isn, 0, 4000);
+            test.execute(Push{string(5000, 'a')});
+            expect_segment(test, isn + 1, 1460);
+            expect_segment(test, isn + 1461, 1000);
+            expect_segment(test, isn + 2461, 1000);
+            expect_segment(test, isn + 3461, 540);
+            test.execute(ExpectNoSegment{});
+
+            for (int i = 0; i < 3; ++i)
+            {
+                test.execute(AckReceived{Wrap32{isn + 1}}.with_win(4000));
+            }
+            expect_segment(test, isn + 1, 1000);
+            expect_segment(test, isn + 1001, 460);
+            test.execute(ExpectNoSegment{});
+            test.execute(ExpectCongestionWindow{4000});
+            test.execute(ExpectMSS{1000});
+        }
+
+        {
+            TCPConfig cfg;
+            const Wrap32 isn(rd());
+            cfg.isn = isn;
+            cfg.mss = 1460;
+            cfg.congestion_control = CongestionControl::Algorithm::NewReno;
+
+            TCPSenderTestHarness test{"initial window follows the negotiated MSS", cfg};
+            test.execute(ExpectCongestionWindow{4380});
+            test.execute(PeerMSS{nullopt});
+            test.execute(ExpectCongestionWindow{2144}); // 4 * 536
+            test.execute(PeerMSS{1460});
+            test.execute(ExpectCongestionWindow{4380}); // min(4 * 1460, max(2 * 1460, 4380))
+            connect(test, isn, 0, 60000);
+            test.execute(Push{string(5000, 'a')});
+            expect_segment(test, isn + 1, 1460);
+            expect_segment(test, isn + 1461, 1460);
+            expect_segment(test, isn + 2921, 1460);
+            test.execute(ExpectNoSegment{});
+
+            // 已经发出数据后，对方重传的 SYN 不再改变窗口
+            test.execute(PeerMSS{536});
+            test.execute(ExpectCongestionWindow{4380});
+        }
+
+        {
+            TCPConfig cfg;
+            const Wrap32 isn(rd());
+            cfg.isn = isn;
+            cfg.mss = 1460;
+            cfg.pacing = true;
+            cfg.pacing_rate = 1;
+
+            // 令牌桶深度为两个报文段：按协商的 536 字节计算时只能突发两个报文段，按 1000 字节计算会突发四个
+            TCPSenderTestHarness test{"pacing burst follows the negotiated MSS", cfg};
+            test.execute(PeerMSS{nullopt});
+            connect(test, isn, 0, 60000);
+            test.execute(Push{string(5000, 'a')});
+            expect_segment(test, isn + 1, 536);
+            expect_segment(test, isn + 537, 536);
+            test.execute(ExpectNoSegment{});
+        }
+
+        {
+            TCPConfig cfg;
+            const Wrap32 isn(rd());
+            cfg.isn = isn;
+
+            TCPSenderTestHarness test{"payload leaves room for the options a segment carries", cfg};
+            connect(test, isn, 0, 60000);
+            test.execute(OptionLength{12}); // 一个 SACK 块
+            test.execute(Push{string(3000, 'a')});
+            expect_segment(test, isn + 1, 988);
+            expect_segment(test, isn + 989, 988);
+            expect_segment(test, isn + 1977, 988);
+            expect_segment(test, isn + 2965, 36);
+            test.execute(ExpectNoSegment{});
+
+            // 超时重传时选项变长，报文段拆成两个
+            test.execute(OptionLength{20});
+            test.execute(Tick{1000});
+            expect_segment(test, isn + 1, 980);
+            expect_segment(test, isn + 981, 8);
+            test.execute(ExpectNoSegment{});
+        }
+
+        mss_option_test(uniform_int_distribution<uint32_t>{0, UINT32_MAX}(rd));
+        packets_per_byte_test();
+    }
+    catch (const exception &e)
+    {
+        cerr << e.what() << endl;
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
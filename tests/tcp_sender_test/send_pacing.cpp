@@ -0,0 +1,150 @@
+#include <iostream>
+#include <cstdint>
+#include <cstdlib>
+#include <exception>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include "bottleneck_link.h"
+#include "random.h"
+#include "sender_test_harness.h"
+using namespace std;
+
+// 接收窗口小于带宽时延积时，不加节奏控制的发送端每个往返把整个窗口一次发出，浅队列丢弃突发的尾部；
+// 按节奏发送时报文均匀地进入瓶颈队列
+void shallow_queue_test()
+{
+    const string data(1'000'000, 'x');
+    BottleneckConfig link;
+    link.queue_packets = 10;
+
+    TransferResult results[2];
+    for (const bool pacing : {false, true})
+    {
+        TCPConfig cfg;
+        cfg.recv_capacity = 30'000; // 带宽时延积为 40000 字节
+        cfg.adaptive_rto = true;
+        cfg.pacing = pacing;
+        results[pacing] = run_bottleneck_transfer(cfg, link, data, 60'000);
+        if (!results[pacing].finished)
+        {
+            throw runtime_error(string{"shallow queue: transfer did not complete with pacing "} + (pacing ? "on" : "off"));
+        }
+    }
+
+    const auto &bursty = results[false];
+    const auto &paced = results[true];
+    if (paced.max_burst_packets > 3 || paced.packets_dropped > 0 || bursty.max_burst_packets < 20)
+    {
+        throw runtime_error("shallow queue: bursts of " + to_string(bursty.max_burst_packets) + " packets (" + to_string(bursty.packets_dropped)
+                            + " dropped) without pacing, " + to_string(paced.max_burst_packets) + " packets (" + to_string(paced.packets_dropped)
+                            + " dropped) with pacing");
+    }
+    if (paced.goodput_mbps() < 4 * bursty.goodput_mbps())
+    {
+        throw runtime_error("shallow queue: " + to_string(paced.goodput_mbps()) + " Mbit/s with pacing, " + to_string(bursty.goodput_mbps())
+                            + " Mbit/s without");
+    }
+}
+
+int main()
+{
+    try
+    {
+        auto rd = get_random_engine();
+
+        {
+            TCPConfig cfg;
+            const Wrap32 isn(rd());
+            cfg.isn = isn;
+            cfg.pacing = true;
+            cfg.pacing_rate = 1000;
+
+            TCPSenderTestHarness test{"token bucket releases one segment per millisecond at 1000 bytes/ms", cfg};
+            test.execute(ExpectPacingRate{1000});
+            test.execute(Push{});
+            test.execute(ExpectMessage{}.with_syn(true).with_seqno(isn));
+            test.execute(AckReceived{Wrap32{isn + 1}}.with_win(10000));
+            test.execute(Push{string(10000, 'a')});
+
+            // 桶中最初有两个报文段的令牌
+            expect_segment(test, isn + 1);
+            expect_segment(test, isn + 1001);
+            test.execute(ExpectNoSegment{});
+
+            // 之后每毫秒积累的令牌够发一个报文段
+            for (uint32_t i = 2; i < 5; ++i)
+            {
+                test.execute(Tick{1});
+                expect_segment(test, isn + 1 + 1000 * i);
+                test.execute(ExpectNoSegment{});
+            }
+
+            // 空闲期间积累的令牌不超过桶深
+            test.execute(Tick{10});
+            expect_segment(test, isn + 5001);
+            expect_segment(test, isn + 6001);
+            test.execute(ExpectNoSegment{});
+            test.execute(ExpectSeqnosInFlight{7000});
+        }
+
+        {
+            TCPConfig cfg;
+            const Wrap32 isn(rd());
+            cfg.isn = isn;
+            cfg.pacing = true;
+            cfg.congestion_control = CongestionControl::Algorithm::NewReno;
+
+            TCPSenderTestHarness test{"pacing rate follows cwnd / SRTT", cfg};
+            test.execute(ExpectPacingRate{0});
+            test.execute(Push{});
+            test.execute(ExpectMessage{}.with_syn(true).with_seqno(isn));
+            test.execute(Tick{100});
+            test.execute(AckReceived{Wrap32{isn + 1}}.with_win(60000));
+
+            // 慢启动：2 * cwnd / SRTT = 2 * 4000 / 100
+            test.execute(ExpectPacingRate{80});
+            test.execute(Push{string(4000, 'a')});
+            expect_segment(test, isn + 1);
+            expect_segment(test, isn + 1001);
+            test.execute(ExpectNoSegment{});
+
+            // 令牌为正就发出下一个报文段，透支的 1000 字节要积累 13 毫秒才能还清
+            test.execute(Tick{1});
+            expect_segment(test, isn + 2001);
+            test.execute(Tick{11});
+            test.execute(ExpectNoSegment{});
+            test.execute(Tick{1});
+            expect_segment(test, isn + 3001);
+            test.execute(ExpectNoSegment{});
+        }
+
+        {
+            TCPConfig cfg;
+            const Wrap32 isn(rd());
+            cfg.isn = isn;
+            cfg.pacing = true;
+            cfg.pacing_rate = 1000;
+
+            TCPSenderTestHarness test{"retransmissions are not held back by the token bucket", cfg};
+            test.execute(Push{});
+            test.execute(ExpectMessage{}.with_syn(true).with_seqno(isn));
+            test.execute(AckReceived{Wrap32{isn + 1}}.with_win(10000));
+            test.execute(Push{string(2000, 'a')});
+            expect_segment(test, isn + 1);
+            expect_segment(test, isn + 1001);
+            test.execute(Tick{TCPConfig::TIMEOUT_DFLT});
+            expect_segment(test, isn + 1);
+            test.execute(ExpectNoSegment{});
+        }
+
+        shallow_queue_test();
+    }
+    catch (const exception &e)
+    {
+        cerr << e.what() << endl;
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
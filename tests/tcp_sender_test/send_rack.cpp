@@ -0,0 +1,192 @@
+#include <iostream>
+#include <cstdint>
+#include <cstdlib>
+#include <exception>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include "bottleneck_link.h"
+#include "random.h"
+#include "sender_test_harness.h"
+using namespace std;
+
+// SYN 的确认在 100 毫秒后到达，得到 100 毫秒的 RTT 样本
+constexpr uint64_t SYN_RTT_MS = 100;
+
+// 短连接的最后几个报文丢失：没有 RACK-TLP 时只能等 RTO，之后每个往返补一个空洞；
+// 探测约两个 SRTT 后发出，它的 SACK 让其余空洞在一个往返内补上。
+// 只丢最后一个报文时在途只有一个报文段，探测要等过对方的延迟确认，不早于 RTO
+void tail_loss_test()
+{
+    const string data(10'000, 'x');
+    const uint64_t rtt = 2 * BottleneckConfig{}.one_way_delay_ms;
+
+    // 第 0 个报文是 SYN，第 10 个是带 FIN 的最后一个数据报文
+    for (const vector<uint64_t> &drops :
+         {vector<uint64_t>{10}, vector<uint64_t>{9, 10}, vector<uint64_t>{8, 9, 10}, vector<uint64_t>{6, 7, 8, 9, 10}})
+    {
+        BottleneckConfig link;
+        link.drop_packets = drops;
+
+        TransferResult results[2];
+        for (const bool rack : {false, true})
+        {
+            TCPConfig cfg;
+            cfg.adaptive_rto = true;
+            cfg.sack = true;
+            cfg.rack = rack;
+            results[rack] = run_bottleneck_transfer(cfg, link, data, 60'000);
+            if (!results[rack].finished)
+            {
+                throw runtime_error(string{"tail loss: transfer did not complete with RACK-TLP "} + (rack ? "on" : "off"));
+            }
+        }
+
+        const uint64_t gain = drops.size() > 1 ? rtt : 0;
+        if (results[true].duration_ms + gain > results[false].duration_ms)
+        {
+            throw runtime_error("tail loss of " + to_string(drops.size()) + " packets: " + to_string(results[true].duration_ms)
+                                + " ms with RACK-TLP, " + to_string(results[false].duration_ms) + " ms without");
+        }
+    }
+}
+
+int main()
+{
+    try
+    {
+        auto rd = get_random_engine();
+
+        {
+            TCPConfig cfg;
+            const Wrap32 isn(rd());
+            cfg.isn = isn;
+            cfg.rack = true;
+
+            TCPSenderTestHarness test{"a hole is lost one RTT plus the reordering window after a later segment arrives", cfg};
+            connect(test, isn, SYN_RTT_MS);
+            test.execute(Push{string(2000, 'a')});
+            expect_segment(test, isn + 1);
+            expect_segment(test, isn + 1001);
+
+            // 第二个报文段先到达，一个重复确认不足以快速重传
+            test.execute(Tick{100});
+            test.execute(AckReceived{Wrap32{isn + 1}}.with_win(60000).with_sack(isn + 1001, isn + 2001));
+            test.execute(ExpectNoSegment{});
+
+            // 重排序窗口为最小 RTT 的四分之一：第一个报文段发出 125 毫秒后仍未送达才判定丢失
+            test.execute(Tick{24});
+            test.execute(ExpectNoSegment{});
+            test.execute(Tick{1});
+            test.execute(ExpectInFastRecovery{true});
+            expect_segment(test, isn + 1);
+            test.execute(ExpectNoSegment{});
+
+            test.execute(AckReceived{Wrap32{isn + 2001}}.with_win(60000));
+            test.execute(ExpectInFastRecovery{false});
+            test.execute(ExpectSeqnosInFlight{0});
+        }
+
+        {
+            TCPConfig cfg;
+            const Wrap32 isn(rd());
+            cfg.isn = isn;
+            cfg.rack = true;
+
+            TCPSenderTestHarness test{"tail loss probe resends the last segment after 2 * SRTT", cfg};
+            connect(test, isn, SYN_RTT_MS);
+            test.execute(Push{string(3000, 'a')});
+            expect_segment(test, isn + 1);
+            expect_segment(test, isn + 1001);
+            expect_segment(test, isn + 2001);
+            test.execute(Tick{100});
+            test.execute(AckReceived{Wrap32{isn + 1001}}.with_win(60000));
+            test.execute(ExpectNoSegment{});
+
+            test.execute(Tick{199});
+            test.execute(ExpectNoSegment{});
+            test.execute(Tick{1});
+            expect_segment(test, isn + 2001);
+            test.execute(ExpectNoSegment{});
+            test.execute(ExpectConsecutiveRetransmissions{0});
+
+            test.execute(AckReceived{Wrap32{isn + 3001}}.with_win(60000));
+            test.execute(ExpectSeqnosInFlight{0});
+            test.execute(Tick{TCPConfig::TIMEOUT_DFLT});
+            test.execute(ExpectNoSegment{});
+        }
+
+        {
+            TCPConfig cfg;
+            const Wrap32 isn(rd());
+            cfg.isn = isn;
+            cfg.rack = true;
+
+            TCPSenderTestHarness test{"a single segment in flight waits out a delayed ACK before probing", cfg};
+            connect(test, isn, SYN_RTT_MS);
+            test.execute(Push{string(1000, 'a')});
+            expect_segment(test, isn + 1);
+            test.execute(Tick{399});
+            test.execute(ExpectNoSegment{});
+            test.execute(Tick{1});
+            expect_segment(test, isn + 1);
+        }
+
+        {
+            TCPConfig cfg;
+            const Wrap32 isn(rd());
+            cfg.isn = isn;
+            cfg.rack = true;
+            cfg.congestion_control = CongestionControl::Algorithm::NewReno;
+
+            TCPSenderTestHarness test{"the probe's SACK exposes an earlier tail loss", cfg};
+            connect(test, isn, SYN_RTT_MS);
+            test.execute(Push{string(3000, 'a')});
+            expect_segment(test, isn + 1);
+            expect_segment(test, isn + 1001);
+            expect_segment(test, isn + 2001);
+            test.execute(Tick{100});
+            test.execute(AckReceived{Wrap32{isn + 1001}}.with_win(60000));
+            test.execute(Tick{200});
+            expect_segment(test, isn + 2001);
+
+            // 第二、三个报文段都丢失了，探测报文段到达后第二个报文段立即重传
+            test.execute(Tick{100});
+            test.execute(AckReceived{Wrap32{isn + 1001}}.with_win(60000).with_sack(isn + 2001, isn + 3001));
+            test.execute(ExpectInFastRecovery{true});
+            expect_segment(test, isn + 1001);
+            test.execute(ExpectNoSegment{});
+            test.execute(AckReceived{Wrap32{isn + 3001}}.with_win(60000));
+            test.execute(ExpectInFastRecovery{false});
+        }
+
+        {
+            TCPConfig cfg;
+            const Wrap32 isn(rd());
+            cfg.isn = isn;
+
+            TCPSenderTestHarness test{"without RACK-TLP a tail loss waits for the RTO", cfg};
+            connect(test, isn, SYN_RTT_MS);
+            test.execute(Push{string(3000, 'a')});
+            expect_segment(test, isn + 1);
+            expect_segment(test, isn + 1001);
+            expect_segment(test, isn + 2001);
+            test.execute(Tick{100});
+            test.execute(AckReceived{Wrap32{isn + 1001}}.with_win(60000));
+            test.execute(Tick{TCPConfig::TIMEOUT_DFLT - 1});
+            test.execute(ExpectNoSegment{});
+            test.execute(Tick{1});
+            expect_segment(test, isn + 1001);
+        }
+
+        tail_loss_test();
+    }
+    catch (const exception &e)
+    {
+        cerr << e.what() << endl;
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
@@ -195,6 +195,40 @@ int main()
             test.execute(ExpectSeqnosInFlight{0});
             test.execute(HasError{false});
         }
+        {
+            TCPConfig cfg;
+            const Wrap32 isn(rd());
+            const uint16_t retx_timeout = uniform_int_distribution<uint16_t>{10, 10000}(rd);
+            cfg.isn = isn;
+            cfg.rt_timeout = retx_timeout;
+
+            TCPSenderTestHarness test{"Partial ack trims the oldest segment, retx resends only the tail", cfg};
+            test.execute(Push{});
+            test.execute(ExpectMessage{}.with_no_flags().with_syn(true).with_payload_size(0).with_seqno(isn));
+            test.execute(AckReceived{Wrap32{isn + 1}}.with_win(1000));
+            test.execute(Push{"abcdefghij"});
+            test.execute(ExpectMessage{}.with_no_flags().with_data("abcdefghij").with_seqno(isn + 1));
+            test.execute(Push{"klmno"});
+            test.execute(ExpectMessage{}.with_no_flags().with_data("klmno").with_seqno(isn + 11));
+            test.execute(ExpectSeqnosInFlight{15});
+
+            // 对方只确认了第一个报文段的前 4 个字节
+            test.execute(AckReceived{Wrap32{isn + 5}}.with_win(1000));
+            test.execute(ExpectSeqnosInFlight{11});
+            test.execute(ExpectNoSegment{});
+            test.execute(Tick(retx_timeout));
+            test.execute(ExpectMessage{}.with_no_flags().with_data("efghij").with_seqno(isn + 5));
+            test.execute(ExpectNoSegment{});
+
+            // 再确认一部分，然后全部确认
+            test.execute(AckReceived{Wrap32{isn + 9}}.with_win(1000));
+            test.execute(ExpectSeqnosInFlight{7});
+            test.execute(Tick(2 * retx_timeout));
+            test.execute(ExpectMessage{}.with_no_flags().with_data("ij").with_seqno(isn + 9));
+            test.execute(AckReceived{Wrap32{isn + 16}}.with_win(1000));
+            test.execute(ExpectSeqnosInFlight{0});
+            test.execute(ExpectNoSegment{});
+        }
     }
     catch (const exception &e)
     {
@@ -0,0 +1,127 @@
+#include <iostream>
+#include <cstdint>
+#include <cstdlib>
+#include <exception>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include "random.h"
+#include "sender_test_harness.h"
+using namespace std;
+
+int main()
+{
+    try
+    {
+        auto rd = get_random_engine();
+
+        {
+            TCPConfig cfg;
+            const Wrap32 isn(rd());
+            cfg.isn = isn;
+
+            TCPSenderTestHarness test{"RTT is sampled but the RTO stays fixed by default", cfg};
+            test.execute(ExpectSmoothedRTT{nullopt});
+            connect(test, isn, 50, 1000);
+            test.execute(ExpectSmoothedRTT{50});
+            test.execute(ExpectRTO{TCPConfig::TIMEOUT_DFLT});
+        }
+
+        {
+            TCPConfig cfg;
+            const Wrap32 isn(rd());
+            cfg.isn = isn;
+            cfg.adaptive_rto = true;
+            cfg.rto_min = 10;
+
+            TCPSenderTestHarness test{"RTO converges to the measured RTT", cfg};
+            connect(test, isn, 100, 1000);
+
+            // 第一个样本：SRTT = R，RTTVAR = R / 2，RTO = SRTT + 4 * RTTVAR
+            test.execute(ExpectSmoothedRTT{100});
+            test.execute(ExpectRTO{300});
+
+            uint64_t seqno = 1;
+            for (int i = 0; i < 40; ++i)
+            {
+                test.execute(Push{"x"});
+                test.execute(ExpectMessage{}.with_data("x"));
+                test.execute(Tick{20});
+                test.execute(AckReceived{Wrap32{isn + static_cast<uint32_t>(++seqno)}}.with_win(1000));
+            }
+            test.execute(ExpectSmoothedRTT{20});
+            test.execute(ExpectRTO{24});
+
+            // 新的 RTO 决定了下一次超时的时间
+            test.execute(Push{"y"});
+            test.execute(ExpectMessage{}.with_data("y"));
+            test.execute(Tick{23});
+            test.execute(ExpectNoSegment{});
+            test.execute(Tick{1});
+            test.execute(ExpectMessage{}.with_data("y"));
+            test.execute(ExpectRTO{48});
+        }
+
+        {
+            TCPConfig cfg;
+            const Wrap32 isn(rd());
+            cfg.isn = isn;
+            cfg.adaptive_rto = true;
+            cfg.rto_min = 10;
+
+            TCPSenderTestHarness test{"Karn: acks of retransmitted segments are not sampled", cfg};
+            connect(test, isn, 100, 1000);
+            test.execute(Push{"abc"});
+            test.execute(ExpectMessage{}.with_data("abc"));
+            test.execute(Tick{300});
+            test.execute(ExpectMessage{}.with_data("abc"));
+            test.execute(ExpectRTO{600});
+
+            // 如果采样，这个确认会给出 310 ms 的 RTT
+            test.execute(Tick{10});
+            test.execute(AckReceived{Wrap32{isn + 4}}.with_win(1000));
+            test.execute(ExpectSmoothedRTT{100});
+            test.execute(ExpectRTO{300});
+        }
+
+        {
+            TCPConfig cfg;
+            const Wrap32 isn(rd());
+            cfg.isn = isn;
+            cfg.adaptive_rto = true;
+
+            TCPSenderTestHarness test{"RTO is clamped to rto_min", cfg};
+            connect(test, isn, 0, 1000);
+            test.execute(ExpectSmoothedRTT{0});
+            test.execute(ExpectRTO{200});
+        }
+
+        {
+            TCPConfig cfg;
+            const Wrap32 isn(rd());
+            cfg.isn = isn;
+            cfg.adaptive_rto = true;
+            cfg.rto_max = 2500;
+
+            TCPSenderTestHarness test{"Backoff is clamped to rto_max", cfg};
+            test.execute(Push{});
+            test.execute(ExpectMessage{}.with_syn(true));
+            test.execute(Tick{1000});
+            test.execute(ExpectMessage{}.with_syn(true));
+            test.execute(ExpectRTO{2000});
+            test.execute(Tick{2000});
+            test.execute(ExpectMessage{}.with_syn(true));
+            test.execute(ExpectRTO{2500});
+            test.execute(Tick{2500});
+            test.execute(ExpectMessage{}.with_syn(true));
+            test.execute(ExpectRTO{2500});
+        }
+    }
+    catch (const exception &e)
+    {
+        cerr << e.what() << endl;
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,218 @@
+#include <iostream>
+#include <cstdint>
+#include <cstdlib>
+#include <exception>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include "bottleneck_link.h"
+#include "random.h"
+#include "sender_test_harness.h"
+using namespace std;
+
+// 一个窗口内丢失多个报文段：SACK 让发送端在一个往返内补上所有空洞，而不是每个往返补一个
+void multiple_losses_test()
+{
+    const string data(500'000, 'x');
+    BottleneckConfig link;
+    link.queue_packets = 100; // 队列足够大，只有人为丢弃的报文丢失
+    link.drop_packets = {100, 103, 106, 109};
+
+    TransferResult results[2];
+    for (const bool sack : {false, true})
+    {
+        TCPConfig cfg;
+        cfg.congestion_control = CongestionControl::Algorithm::NewReno;
+        cfg.sack = sack;
+        results[sack] = run_bottleneck_transfer(cfg, link, data, 60'000);
+        if (!results[sack].finished || results[sack].packets_dropped != link.drop_packets.size())
+        {
+            throw runtime_error(string{"multiple losses: transfer did not complete with SACK "} + (sack ? "on" : "off"));
+        }
+    }
+
+    // 没有 SACK 时每个部分确认只暴露一个空洞，四个空洞要多花几个往返
+    const uint64_t rtt = 2 * link.one_way_delay_ms;
+    if (results[true].duration_ms + rtt > results[false].duration_ms)
+    {
+        throw runtime_error("multiple losses: transfer took " + to_string(results[true].duration_ms) + " ms with SACK, "
+                            + to_string(results[false].duration_ms) + " ms without (RTT " + to_string(rtt) + " ms)");
+    }
+}
+
+int main()
+{
+    try
+    {
+        auto rd = get_random_engine();
+
+        {
+            TCPConfig cfg;
+            const Wrap32 isn(rd());
+            cfg.isn = isn;
+            cfg.sack = true;
+
+            TCPSenderTestHarness test{"SYN carries SACK-permitted when enabled", cfg};
+            test.execute(Push{});
+            test.execute(ExpectMessage{}.with_syn(true).with_seqno(isn));
+        }
+
+        {
+            TCPConfig cfg;
+            const Wrap32 isn(rd());
+            cfg.isn = isn;
+
+            TCPSenderTestHarness test{"SACK retransmits every hole and nothing else", cfg};
+            connect(test, isn);
+            test.execute(Push{string(8000, 'a')});
+            for (uint32_t i = 0; i < 8; ++i)
+            {
+                expect_segment(test, isn + 1 + 1000 * i);
+            }
+
+            // 第二个和第五个报文段丢失
+            test.execute(AckReceived{Wrap32{isn + 1001}}.with_win(60000));
+            test.execute(AckReceived{Wrap32{isn + 1001}}.with_win(60000).with_sack(isn + 2001, isn + 3001));
+            test.execute(AckReceived{Wrap32{isn + 1001}}.with_win(60000).with_sack(isn + 2001, isn + 4001));
+            test.execute(ExpectNoSegment{});
+            test.execute(ExpectSeqnosSacked{2000});
+
+            // 第三个重复确认：两个空洞都在一个往返内重传，仍在途中的第七、八个报文段不重传
+            test.execute(AckReceived{Wrap32{isn + 1001}}
+                             .with_win(60000)
+                             .with_sack(isn + 5001, isn + 6001)
+                             .with_sack(isn + 2001, isn + 4001));
+            test.execute(ExpectInFastRecovery{true});
+            expect_segment(test, isn + 1001);
+            expect_segment(test, isn + 4001);
+            test.execute(ExpectNoSegment{});
+
+            // 部分确认不会再次重传已经重传过的空洞
+            test.execute(AckReceived{Wrap32{isn + 4001}}.with_win(60000).with_sack(isn + 5001, isn + 8001));
+            test.execute(ExpectNoSegment{});
+            test.execute(ExpectSeqnosSacked{3000});
+            test.execute(AckReceived{Wrap32{isn + 8001}}.with_win(60000));
+            test.execute(ExpectInFastRecovery{false});
+            test.execute(ExpectSeqnosInFlight{0});
+        }
+
+        {
+            TCPConfig cfg;
+            const Wrap32 isn(rd());
+            cfg.isn = isn;
+            cfg.congestion_control = CongestionControl::Algorithm::NewReno;
+
+            TCPSenderTestHarness test{"SACKed segments leave the pipe during recovery", cfg};
+            connect(test, isn);
+            test.execute(Push{string(10000, 'a')});
+            for (uint32_t i = 0; i < 4; ++i)
+            {
+                expect_segment(test, isn + 1 + 1000 * i);
+            }
+            test.execute(AckReceived{Wrap32{isn + 1}}.with_win(60000).with_sack(isn + 1001, isn + 2001));
+            test.execute(AckReceived{Wrap32{isn + 1}}.with_win(60000).with_sack(isn + 1001, isn + 3001));
+            test.execute(ExpectNoSegment{});
+
+            // 第一个报文段丢失：ssthresh = 2000，管道中只剩重传的一个报文段，可以再发一个新报文段
+            test.execute(AckReceived{Wrap32{isn + 1}}.with_win(60000).with_sack(isn + 1001, isn + 4001));
+            expect_segment(test, isn + 1);
+            expect_segment(test, isn + 4001);
+            test.execute(ExpectNoSegment{});
+            test.execute(ExpectCongestionWindow{2000});
+
+            // 新报文段被 SACK，又离开了管道
+            test.execute(AckReceived{Wrap32{isn + 1}}.with_win(60000).with_sack(isn + 1001, isn + 5001));
+            expect_segment(test, isn + 5001);
+            test.execute(ExpectNoSegment{});
+
+            test.execute(AckReceived{Wrap32{isn + 5001}}.with_win(60000));
+            test.execute(ExpectInFastRecovery{false});
+        }
+
+        {
+            TCPConfig cfg;
+            const Wrap32 isn(rd());
+            cfg.isn = isn;
+            cfg.congestion_control = CongestionControl::Algorithm::NewReno;
+
+            TCPSenderTestHarness test{"a timeout discards SACK information", cfg};
+            connect(test, isn);
+            test.execute(Push{string(10000, 'a')});
+            for (uint32_t i = 0; i < 4; ++i)
+            {
+                expect_segment(test, isn + 1 + 1000 * i);
+            }
+
+            // 第一和第四个报文段丢失，接收窗口限制为 4000，只有两个报文段被 SACK，不足以触发快速重传
+            test.execute(AckReceived{Wrap32{isn + 1}}.with_win(4000).with_sack(isn + 1001, isn + 3001));
+            test.execute(ExpectNoSegment{});
+            test.execute(ExpectSeqnosSacked{2000});
+            test.execute(Tick{1000});
+            expect_segment(test, isn + 1);
+            test.execute(ExpectNoSegment{});
+            test.execute(ExpectSeqnosSacked{0});
+
+            // 重传的报文段到达后，第四个报文段不必等下一次超时
+            test.execute(AckReceived{Wrap32{isn + 3001}}.with_win(4000));
+            test.execute(ExpectCongestionWindow{2000});
+            expect_segment(test, isn + 3001);
+            expect_segment(test, isn + 4001);
+            test.execute(ExpectNoSegment{});
+        }
+
+        {
+            TCPConfig cfg;
+            const Wrap32 isn(rd());
+            cfg.isn = isn;
+            cfg.congestion_control = CongestionControl::Algorithm::NewReno;
+
+            TCPSenderTestHarness test{"after a timeout, SACKed data the receiver dropped is resent", cfg};
+            connect(test, isn);
+            test.execute(Push{string(10000, 'a')});
+            for (uint32_t i = 0; i < 4; ++i)
+            {
+                expect_segment(test, isn + 1 + 1000 * i);
+            }
+            test.execute(AckReceived{Wrap32{isn + 1}}.with_win(4000).with_sack(isn + 1001, isn + 3001));
+            test.execute(Tick{1000});
+            expect_segment(test, isn + 1);
+            test.execute(ExpectNoSegment{});
+
+            // 接收端丢弃了 SACK 过的第二、三个报文段（违约），确认只前进到重传的报文段之后：
+            // 这两个报文段也要重传，而不是跳过它们发送第四个
+            test.execute(AckReceived{Wrap32{isn + 1001}}.with_win(4000));
+            test.execute(ExpectCongestionWindow{2000});
+            expect_segment(test, isn + 1001);
+            expect_segment(test, isn + 2001);
+            test.execute(ExpectNoSegment{});
+            test.execute(AckReceived{Wrap32{isn + 3001}}.with_win(4000));
+            expect_segment(test, isn + 3001);
+            expect_segment(test, isn + 4001);
+        }
+
+        {
+            TCPConfig cfg;
+            const Wrap32 isn(rd());
+            cfg.isn = isn;
+
+            TCPSenderTestHarness test{"invalid SACK blocks are ignored", cfg};
+            connect(test, isn);
+            test.execute(Push{string(2000, 'a')});
+            expect_segment(test, isn + 1);
+            expect_segment(test, isn + 1001);
+            test.execute(AckReceived{Wrap32{isn + 1}}.with_win(60000).with_sack(isn + 1001, isn + 5001));
+            test.execute(AckReceived{Wrap32{isn + 1}}.with_win(60000).with_sack(isn + 1001, isn + 1));
+            test.execute(ExpectSeqnosSacked{0});
+            test.execute(ExpectNoSegment{});
+        }
+
+        multiple_losses_test();
+    }
+    catch (const exception &e)
+    {
+        cerr << e.what() << endl;
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
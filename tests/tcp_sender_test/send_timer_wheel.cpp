@@ -0,0 +1,224 @@
+#include <iostream>
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include <exception>
+#include <map>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include "random.h"
+#include "tcp_sender.h"
+#include "timer_wheel.h"
+using namespace std;
+
+// 推进 ms 毫秒，期望到期的键恰好是 expected（按顺序）
+void expect_expired(TimerWheel &wheel, uint64_t ms, const vector<uint64_t> &expected, const string &what)
+{
+    const vector<uint64_t> &expired = wheel.advance(ms);
+    if (expired != expected)
+    {
+        throw runtime_error(what + ": expected " + to_string(expected.size()) + " timers to expire at "
+                            + to_string(wheel.now_ms()) + " ms, got " + to_string(expired.size()));
+    }
+}
+
+void basic_test()
+{
+    TimerWheel wheel;
+    auto a = wheel.arm(10, 1);
+    auto b = wheel.arm(10, 2);
+    auto c = wheel.arm(5000, 3);
+    expect_expired(wheel, 9, {}, "before the deadline");
+    expect_expired(wheel, 1, {1, 2}, "at the deadline");
+    if (!wheel.has_expired(a) || wheel.is_armed(b) || !wheel.is_armed(c) || wheel.size() != 1)
+    {
+        throw runtime_error("handles do not reflect expired timers");
+    }
+
+    // 取消后不再到期，句柄被清空；节点复用后旧句柄不会指向新的定时器
+    if (!wheel.cancel(c) || wheel.has_expired(c) || wheel.cancel(c))
+    {
+        throw runtime_error("cancel did not disarm the timer");
+    }
+    const auto d = wheel.arm(20, 4);
+    if (wheel.is_armed(a) || wheel.is_armed(b) || !wheel.is_armed(d))
+    {
+        throw runtime_error("a stale handle refers to a reused timer");
+    }
+    expect_expired(wheel, 10'000, {4}, "cancelled timer expired");
+
+    // 不晚于当前时间的定时器在下一毫秒到期
+    wheel.arm(0, 5);
+    expect_expired(wheel, 1, {5}, "past deadline");
+
+    // 跨越多层的定时器按到期时间依次到期
+    const uint64_t now = wheel.now_ms();
+    wheel.arm(now + 100'000, 8);
+    wheel.arm(now + 64, 6);
+    wheel.arm(now + 4097, 7);
+    expect_expired(wheel, 200'000, {6, 7, 8}, "timers on different levels");
+}
+
+// 与逐个比较到期时间的朴素实现对照：随机设置、取消和推进，包括超出时间轮跨度的定时器
+void random_test(default_random_engine &rd)
+{
+    TimerWheel wheel;
+    struct Timer
+    {
+        TimerWheel::TimerId id{};
+        uint64_t deadline{};
+    };
+    map<uint64_t, Timer> pending;
+    uint64_t next_key = 0;
+
+    for (unsigned round = 0; round < 20'000; ++round)
+    {
+        const unsigned op = uniform_int_distribution<unsigned>{0, 9}(rd);
+        if (op < 5)
+        {
+            // 到期时间的数量级从几毫秒到远超时间轮跨度（约 12 天）不等
+            const unsigned bits = uniform_int_distribution<unsigned>{0, 34}(rd);
+            const uint64_t delta = uniform_int_distribution<uint64_t>{0, (uint64_t{1} << bits)}(rd);
+            const uint64_t deadline = wheel.now_ms() + delta - min<uint64_t>(wheel.now_ms(), op == 0 ? 10 : 0);
+            const uint64_t key = next_key++;
+            pending[key] = {wheel.arm(deadline, key), max(deadline, wheel.now_ms() + 1)};
+        }
+        else if (op < 7 && !pending.empty())
+        {
+            auto it = pending.lower_bound(uniform_int_distribution<uint64_t>{0, next_key}(rd));
+            if (it == pending.end())
+            {
+                it = pending.begin();
+            }
+            if (!wheel.cancel(it->second.id))
+            {
+                throw runtime_error("failed to cancel a pending timer");
+            }
+            pending.erase(it);
+        }
+        else
+        {
+            const unsigned bits = uniform_int_distribution<unsigned>{0, 32}(rd);
+            const uint64_t ms = uniform_int_distribution<uint64_t>{0, (uint64_t{1} << bits)}(rd);
+            const vector<uint64_t> expired = wheel.advance(ms);
+
+            vector<uint64_t> expected;
+            for (const auto &[key, timer] : pending)
+            {
+                if (timer.deadline <= wheel.now_ms())
+                {
+                    expected.push_back(key);
+                }
+            }
+            vector<uint64_t> sorted = expired;
+            sort(sorted.begin(), sorted.end());
+            if (sorted != expected)
+            {
+                throw runtime_error("round " + to_string(round) + ": " + to_string(expired.size()) + " timers expired, expected "
+                                    + to_string(expected.size()));
+            }
+            for (size_t i = 1; i < expired.size(); ++i)
+            {
+                if (pending.at(expired[i - 1]).deadline > pending.at(expired[i]).deadline)
+                {
+                    throw runtime_error("timers expired out of order");
+                }
+            }
+            for (const uint64_t key : expired)
+            {
+                if (!wheel.has_expired(pending.at(key).id))
+                {
+                    throw runtime_error("handle of an expired timer is still armed");
+                }
+                pending.erase(key);
+            }
+        }
+        if (wheel.size() != pending.size())
+        {
+            throw runtime_error("wheel holds " + to_string(wheel.size()) + " timers, expected " + to_string(pending.size()));
+        }
+    }
+}
+
+// 两个发送器共享一个时间轮：定时器带着各自的键，时间只由时间轮的所有者推进，
+// 发送节奏推迟了新数据时也设置定时器，所有者只需 tick 键到期的发送器
+void shared_wheel_test()
+{
+    TimerWheel wheel;
+    uint64_t sent = 0;
+    const auto transmit = [&](const TCPSenderMessage &) { ++sent; };
+    TCPSender paced{ByteStream{100'000}, Wrap32{0}, 1000, {.pacing = {.enabled = true, .rate_bytes_per_ms = 10}}, {wheel, 1}};
+    TCPSender idle{ByteStream{100'000}, Wrap32{0}, 3000, {}, {wheel, 2}};
+
+    idle.push(transmit);
+    idle.tick(500, transmit);
+    if (wheel.now_ms() != 0 || sent != 1)
+    {
+        throw runtime_error("a sender on a shared wheel advanced the wheel itself");
+    }
+
+    // 连接建立后写入的数据超过令牌桶的深度
+    paced.push(transmit);
+    paced.receive(TCPReceiverMessage{.ackno = Wrap32{1}, .window_size = 60'000});
+    paced.writer().push(string(20'000, 'x'));
+    paced.push(transmit);
+    const uint64_t burst = sent;
+    if (burst <= 2 || wheel.size() != 3)
+    {
+        throw runtime_error("pacing did not defer data with a timer on the shared wheel");
+    }
+
+    // 令牌足够时节奏定时器到期，tick 之后发出更多数据
+    uint64_t waited = 0;
+    while (sent == burst && waited < 1000)
+    {
+        const vector<uint64_t> expired = wheel.advance(1);
+        ++waited;
+        for (const uint64_t key : expired)
+        {
+            (key == 1 ? paced : idle).tick(0, transmit);
+        }
+    }
+    if (sent == burst)
+    {
+        throw runtime_error("the pacing timer never released deferred data");
+    }
+
+    // 另一个发送器只在它自己的 RTO 到期时被 tick
+    while (wheel.now_ms() < 3000)
+    {
+        const vector<uint64_t> expired = wheel.advance(1);
+        for (const uint64_t key : expired)
+        {
+            if (key == 2 && wheel.now_ms() != 3000)
+            {
+                throw runtime_error("the idle sender's timer expired at " + to_string(wheel.now_ms()) + " ms instead of its RTO");
+            }
+            (key == 1 ? paced : idle).tick(0, transmit);
+        }
+    }
+    if (idle.consecutive_retransmissions() != 1)
+    {
+        throw runtime_error("the idle sender did not retransmit its SYN when its RTO expired");
+    }
+}
+
+int main()
+{
+    try
+    {
+        auto rd = get_random_engine();
+        basic_test();
+        random_test(rd);
+        shared_wheel_test();
+    }
+    catch (const exception &e)
+    {
+        cerr << e.what() << endl;
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
@@ -109,6 +109,35 @@ int main()
             test.execute(AckReceived{Wrap32{isn + 1 + static_cast<uint32_t>(bytes_sent)}});
             test.execute(ExpectSeqnosInFlight{0});
         }
+        {
+            TCPConfig cfg;
+            const Wrap32 isn(rd());
+            cfg.isn = isn;
+            cfg.send_capacity = 10;
+
+            // 已发送的数据留在输入流中直到被确认：占用输入流的容量，重传时从流中切出，可以跨过环的折回点
+            TCPSenderTestHarness test{"In-flight data stays in the input stream until acknowledged", cfg};
+            test.execute(Push{});
+            test.execute(ExpectMessage{}.with_no_flags().with_syn(true).with_payload_size(0).with_seqno(isn));
+            test.execute(AckReceived{Wrap32{isn + 1}}.with_win(4));
+            test.execute(Push{"0123456789"});
+            test.execute(ExpectMessage{}.with_data("0123"));
+            test.execute(ExpectAvailableCapacity{0});
+            test.execute(AckReceived{Wrap32{isn + 3}}.with_win(4));
+            test.execute(ExpectMessage{}.with_data("45"));
+            test.execute(ExpectAvailableCapacity{2});
+            test.execute(Push{"ab"});
+            test.execute(ExpectAvailableCapacity{0});
+            test.execute(AckReceived{Wrap32{isn + 7}}.with_win(8));
+            test.execute(ExpectMessage{}.with_data("6789ab"));
+            test.execute(ExpectAvailableCapacity{4});
+            test.execute(ExpectNoSegment{});
+            test.execute(Tick{cfg.rt_timeout});
+            test.execute(ExpectMessage{}.with_data("6789ab"));
+            test.execute(AckReceived{Wrap32{isn + 13}}.with_win(8));
+            test.execute(ExpectAvailableCapacity{10});
+            test.execute(ExpectSeqnosInFlight{0});
+        }
         {
             TCPConfig cfg;
             const Wrap32 isn(rd());
@@ -0,0 +1,95 @@
+#include <iostream>
+#include <cstdint>
+#include <cstdlib>
+#include <exception>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include "bottleneck_link.h"
+#include "random.h"
+#include "sender_test_harness.h"
+using namespace std;
+
+// 长肥管道：带宽时延积远大于 64 KB，没有窗口扩大时吞吐量受限于 65535 字节每往返
+void long_fat_pipe_test()
+{
+    const string data(8'000'000, 'x');
+    BottleneckConfig link;
+    link.rate_bytes_per_ms = 10'000; // 80 Mbit/s
+    link.one_way_delay_ms = 50;      // 带宽时延积约 1 MB
+    link.queue_packets = 1000;
+
+    TransferResult results[2];
+    for (const bool scaling : {false, true})
+    {
+        TCPConfig cfg;
+        cfg.congestion_control = CongestionControl::Algorithm::NewReno;
+        cfg.sack = true;
+        cfg.window_scaling = scaling;
+        cfg.send_capacity = 4'000'000;
+        cfg.recv_capacity = 4'000'000;
+        results[scaling] = run_bottleneck_transfer(cfg, link, data, 60'000);
+        if (!results[scaling].finished)
+        {
+            throw runtime_error(string{"long fat pipe: transfer did not complete with window scaling "} + (scaling ? "on" : "off"));
+        }
+    }
+
+    if (results[true].goodput_mbps() < 4 * results[false].goodput_mbps())
+    {
+        throw runtime_error("long fat pipe: " + to_string(results[true].goodput_mbps()) + " Mbit/s with window scaling, "
+                            + to_string(results[false].goodput_mbps()) + " Mbit/s without");
+    }
+}
+
+int main()
+{
+    try
+    {
+        auto rd = get_random_engine();
+
+        {
+            TCPConfig cfg;
+            const Wrap32 isn(rd());
+            cfg.isn = isn;
+            cfg.window_scaling = true;
+            cfg.recv_capacity = 1'000'000;
+
+            TCPSenderTestHarness test{"SYN carries the window scale option when enabled", cfg};
+            test.execute(Push{});
+            test.execute(ExpectMessage{}.with_syn(true).with_seqno(isn));
+            if (cfg.window_scale() != 4)
+            {
+                throw runtime_error("a 1000000-byte buffer needs a shift of 4");
+            }
+        }
+
+        {
+            TCPConfig cfg;
+            const Wrap32 isn(rd());
+            cfg.isn = isn;
+            cfg.send_capacity = 200'000;
+
+            TCPSenderTestHarness test{"window larger than 65535 fills the pipe", cfg};
+            test.execute(Push{});
+            test.execute(ExpectMessage{}.with_syn(true).with_seqno(isn));
+            test.execute(AckReceived{Wrap32{isn + 1}}.with_win(150'000));
+            test.execute(Push{string(200'000, 'a')});
+            for (uint32_t i = 0; i < 150; ++i)
+            {
+                test.execute(ExpectMessage{}.with_payload_size(TCPConfig::MAX_PAYLOAD_SIZE).with_seqno(isn + 1 + 1000 * i));
+            }
+            test.execute(ExpectNoSegment{});
+            test.execute(ExpectSeqnosInFlight{150'000});
+        }
+
+        long_fat_pipe_test();
+    }
+    catch (const exception &e)
+    {
+        cerr << e.what() << endl;
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
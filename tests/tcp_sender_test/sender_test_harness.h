@@ -86,6 +86,14 @@ struct ExpectSeqnosInFlight : public ExpectNumber<SenderAndOutput, uint64_t>
     uint64_t value(SenderAndOutput &ss) const override { return ss.sender.sequence_numbers_in_flight(); }
 };
 
+// 期望输入流的可用容量：已发送、尚未确认的数据也占用容量
+struct ExpectAvailableCapacity : public ExpectNumber<SenderAndOutput, uint64_t>
+{
+    using ExpectNumber::ExpectNumber;
+    std::string name() const override { return "available_capacity"; }
+    uint64_t value(SenderAndOutput &ss) const override { return ss.sender.writer().available_capacity(); }
+};
+
 // 期望连续重传次数
 struct ExpectConsecutiveRetransmissions : public ExpectNumber<SenderAndOutput, uint64_t>
 {
@@ -94,6 +102,70 @@ struct ExpectConsecutiveRetransmissions : public ExpectNumber<SenderAndOutput, u
     uint64_t value(SenderAndOutput &ss) const override { return ss.sender.consecutive_retransmissions(); }
 };
 
+// 期望拥塞窗口
+struct ExpectCongestionWindow : public ExpectNumber<SenderAndOutput, uint64_t>
+{
+    using ExpectNumber::ExpectNumber;
+    std::string name() const override { return "cwnd"; }
+    uint64_t value(SenderAndOutput &ss) const override { return ss.sender.congestion_control().cwnd(); }
+};
+
+// 期望慢启动阈值
+struct ExpectSlowStartThreshold : public ExpectNumber<SenderAndOutput, uint64_t>
+{
+    using ExpectNumber::ExpectNumber;
+    std::string name() const override { return "ssthresh"; }
+    uint64_t value(SenderAndOutput &ss) const override { return ss.sender.congestion_control().ssthresh(); }
+};
+
+// 期望平滑后的RTT（尚无样本时为空）
+struct ExpectSmoothedRTT : public ExpectNumber<SenderAndOutput, std::optional<uint64_t>>
+{
+    using ExpectNumber::ExpectNumber;
+    std::string name() const override { return "srtt_ms"; }
+    std::optional<uint64_t> value(SenderAndOutput &ss) const override { return ss.sender.srtt_ms(); }
+};
+
+// 期望当前的重传超时
+struct ExpectRTO : public ExpectNumber<SenderAndOutput, uint64_t>
+{
+    using ExpectNumber::ExpectNumber;
+    std::string name() const override { return "rto_ms"; }
+    uint64_t value(SenderAndOutput &ss) const override { return ss.sender.rto_ms(); }
+};
+
+// 期望当前的报文段长度上限
+struct ExpectMSS : public ExpectNumber<SenderAndOutput, uint64_t>
+{
+    using ExpectNumber::ExpectNumber;
+    std::string name() const override { return "mss"; }
+    uint64_t value(SenderAndOutput &ss) const override { return ss.sender.mss(); }
+};
+
+// 期望发送速率（字节/毫秒）
+struct ExpectPacingRate : public ExpectNumber<SenderAndOutput, uint64_t>
+{
+    using ExpectNumber::ExpectNumber;
+    std::string name() const override { return "pacing_rate"; }
+    uint64_t value(SenderAndOutput &ss) const override { return ss.sender.pacing_rate(); }
+};
+
+// 期望在途数据中已被 SACK 的序列号数
+struct ExpectSeqnosSacked : public ExpectNumber<SenderAndOutput, uint64_t>
+{
+    using ExpectNumber::ExpectNumber;
+    std::string name() const override { return "sequence_numbers_sacked"; }
+    uint64_t value(SenderAndOutput &ss) const override { return ss.sender.sequence_numbers_sacked(); }
+};
+
+// 期望是否处于快速恢复阶段
+struct ExpectInFastRecovery : public ExpectBool<SenderAndOutput>
+{
+    using ExpectBool::ExpectBool;
+    std::string name() const override { return "in_fast_recovery"; }
+    bool value(SenderAndOutput &ss) const override { return ss.sender.in_fast_recovery(); }
+};
+
 // 期望没有发送的消息
 struct ExpectNoSegment : public Expectation<SenderAndOutput>
 {
@@ -168,6 +240,30 @@ struct Push : public Action<SenderAndOutput>
     }
 };
 
+// 对方的 SYN 到达，告知它声明的 MSS（为空表示没有 MSS 选项）
+struct PeerMSS : public Action<SenderAndOutput>
+{
+    std::optional<uint16_t> mss_; // 对方声明的 MSS
+
+    explicit PeerMSS(std::optional<uint16_t> mss) : mss_(mss) {} // 构造函数
+
+    std::string description() const override { return "peer's SYN carries " + (mss_ ? "mss=" + std::to_string(*mss_) : std::string{"no MSS option"}); }
+
+    void execute(SenderAndOutput &ss) const override { ss.sender.set_peer_mss(mss_); }
+};
+
+// 之后的报文段附带 bytes 字节的接收方选项（SACK 块）
+struct OptionLength : public Action<SenderAndOutput>
+{
+    uint64_t bytes_; // 选项的字节数
+
+    explicit OptionLength(uint64_t bytes) : bytes_(bytes) {} // 构造函数
+
+    std::string description() const override { return "segments carry " + std::to_string(bytes_) + " bytes of receiver options"; }
+
+    void execute(SenderAndOutput &ss) const override { ss.sender.set_option_length(bytes_); }
+};
+
 // 模拟时间流逝的操作
 struct Tick : public Action<SenderAndOutput>
 {
@@ -231,7 +327,12 @@ struct Receive : public Action<SenderAndOutput>
     std::string description() const override
     {
         std::ostringstream desc;
-        desc << "receive(ack=" << to_string(msg_.ackno) << ", win=" << msg_.window_size << ")";
+        desc << "receive(ack=" << to_string(msg_.ackno) << ", win=" << msg_.window_size;
+        for (const auto &block : msg_.sack_blocks)
+        {
+            desc << ", sack=[" << block.begin << ", " << block.end << ")";
+        }
+        desc << ")";
         if (push_)
         {
             desc << ", then push stream to TCPSender";
@@ -240,12 +341,19 @@ struct Receive : public Action<SenderAndOutput>
     }
 
     // 设置窗口大小
-    Receive &with_win(uint16_t win)
+    Receive &with_win(uint32_t win)
     {
         msg_.window_size = win;
         return *this;
     }
 
+    // 附带一个 SACK 块 [begin, end)
+    Receive &with_sack(Wrap32 begin, Wrap32 end)
+    {
+        msg_.sack_blocks.push_back({begin, end});
+        return *this;
+    }
+
     // 执行接收操作
     void execute(SenderAndOutput &ss) const override
     {
@@ -285,6 +393,7 @@ struct ExpectMessage : public Expectation<SenderAndOutput>
     std::optional<Wrap32> seqno{};        // 序列号
     std::optional<std::string> data{};    // 负载数据
     std::optional<size_t> payload_size{}; // 负载大小
+    std::optional<uint16_t> mss{};        // SYN 中的 MSS 选项
 
     // 设置 SYN 标志
     ExpectMessage &with_syn(bool syn_)
@@ -331,6 +440,13 @@ struct ExpectMessage : public Expectation<SenderAndOutput>
         return *this;
     }
 
+    // 设置 MSS 选项
+    ExpectMessage &with_mss(uint16_t mss_)
+    {
+        mss = mss_;
+        return *this;
+    }
+
     // 设置负载数据
     ExpectMessage &with_data(std::string data_)
     {
@@ -373,6 +489,10 @@ struct ExpectMessage : public Expectation<SenderAndOutput>
         {
             o << (rst.value() ? " +RST" : " (no RST)");
         }
+        if (mss.has_value())
+        {
+            o << " mss=" << mss.value();
+        }
         return o.str();
     }
 
@@ -417,7 +537,11 @@ struct ExpectMessage : public Expectation<SenderAndOutput>
         {
             throw ExpectationViolation("payload_size", payload_size.value(), seg.payload.size());
         }
-        if (seg.payload.size() > TCPConfig::MAX_PAYLOAD_SIZE)
+        if (mss.has_value() and seg.mss != mss)
+        {
+            throw ExpectationViolation("MSS option", mss.value(), seg.mss.value_or(0));
+        }
+        if (seg.payload.size() > ss.sender.max_mss())
         {
             throw ExpectationViolation("payload has length (" + std::to_string(seg.payload.size()) + ") greater than the maximum");
         }
@@ -438,9 +562,28 @@ public:
     TCPSenderTestHarness(std::string name, TCPConfig config)
         : TestHarness(move(name),
                       "initial_RTO_ms=" + to_string(config.rt_timeout),
-                      {TCPSender{ByteStream{config.send_capacity}, config.isn, config.rt_timeout}})
+                      {TCPSender{ByteStream{config.send_capacity}, config.isn, config.rt_timeout, TCPSender::Options::from_config(config)}})
     {
     }
 };
 
+// 发送 SYN，经过 rtt 毫秒后收到确认并打开 window 字节的接收窗口；rtt 不为 0 时得到一个 RTT 样本
+inline void connect(TCPSenderTestHarness &test, Wrap32 isn, uint64_t rtt = 0, uint32_t window = 60000)
+{
+    test.execute(Push{});
+    test.execute(ExpectMessage{}.with_no_flags().with_syn(true).with_payload_size(0).with_seqno(isn));
+    if (rtt > 0)
+    {
+        test.execute(Tick{rtt});
+    }
+    test.execute(AckReceived{Wrap32{isn + 1}}.with_win(window));
+    test.execute(ExpectNoSegment{});
+}
+
+// 期望发出一个以 seqno 开始、有效载荷为 size 字节（默认满载）的报文段
+inline void expect_segment(TCPSenderTestHarness &test, Wrap32 seqno, size_t size = TCPConfig::MAX_PAYLOAD_SIZE)
+{
+    test.execute(ExpectMessage{}.with_no_flags().with_payload_size(size).with_seqno(seqno));
+}
+
 #endif
@@ -0,0 +1,131 @@
+#include <iostream>      // 引入输入输出流库，用于输出信息
+#include <algorithm>     // 引入算法库，用于给到期的键去重
+#include <chrono>        // 引入时间库，用于测量时间
+#include <fstream>       // 引入文件流库，用于文件操作
+#include <iomanip>       // 引入格式化库，用于设置输出格式
+#include <vector>        // 引入向量库，用于保存发送器
+#include "tcp_sender.h"  // 引入 TCPSender 的定义
+#include "timer_wheel.h" // 引入分层时间轮
+
+using namespace std;         // 使用标准命名空间
+using namespace std::chrono; // 使用chrono命名空间，方便使用时间相关的功能
+
+constexpr uint64_t CONNECTIONS = 10'000; // 连接数
+constexpr uint64_t TICK_MS = 10;         // 与 TCPMinnowSocket 的 TCP_TICK_MS 相同
+constexpr uint64_t TICKS = 2'000;        // 模拟 20 秒
+
+// 每条连接的初始 RTO 在 1 到 3 秒之间（RFC 6298 的初始 RTO 为 1 秒）
+uint64_t rto_of(uint64_t connection)
+{
+    return 1000 + connection % 2000;
+}
+
+// 一条连接的发送器：发出 SYN 后对方一直没有回应，按指数退避重传；wheel 为空时使用自己的时间轮
+TCPSender make_sender(uint64_t connection, TimerWheel *wheel)
+{
+    return TCPSender{ByteStream{1000},
+                     Wrap32{static_cast<uint32_t>(connection)},
+                     rto_of(connection),
+                     {},
+                     wheel == nullptr ? WheelRef{} : WheelRef{*wheel, connection}};
+}
+
+// 每条连接一个时间轮：每个 tick 调用所有发送器的 tick()，返回发出的报文段数
+uint64_t tick_every_sender()
+{
+    uint64_t sent = 0;
+    const auto transmit = [&](const TCPSenderMessage &) { ++sent; };
+    vector<TCPSender> senders;
+    senders.reserve(CONNECTIONS);
+    for (uint64_t i = 0; i < CONNECTIONS; ++i)
+    {
+        senders.push_back(make_sender(i, nullptr));
+        senders.back().push(transmit);
+    }
+
+    for (uint64_t tick = 0; tick < TICKS; ++tick)
+    {
+        for (auto &sender : senders)
+        {
+            sender.tick(TICK_MS, transmit);
+        }
+    }
+    return sent;
+}
+
+// 所有连接共享一个时间轮，定时器的键是连接的编号：每个 tick 只调用定时器到期的发送器的 tick()，返回发出的报文段数
+uint64_t tick_expired_senders()
+{
+    uint64_t sent = 0;
+    const auto transmit = [&](const TCPSenderMessage &) { ++sent; };
+    TimerWheel wheel;
+    vector<TCPSender> senders;
+    senders.reserve(CONNECTIONS);
+    for (uint64_t i = 0; i < CONNECTIONS; ++i)
+    {
+        senders.push_back(make_sender(i, &wheel));
+        senders.back().push(transmit);
+    }
+
+    vector<uint64_t> expired;
+    for (uint64_t tick = 0; tick < TICKS; ++tick)
+    {
+        expired = wheel.advance(TICK_MS);
+        sort(expired.begin(), expired.end());
+        expired.erase(unique(expired.begin(), expired.end()), expired.end());
+        for (const uint64_t connection : expired)
+        {
+            senders[connection].tick(TICK_MS, transmit);
+        }
+    }
+    return sent;
+}
+
+void program_body()
+{
+    const auto every_start = steady_clock::now();
+    const uint64_t every_sent = tick_every_sender();
+    const auto every_time = duration_cast<duration<double>>(steady_clock::now() - every_start);
+
+    const auto shared_start = steady_clock::now();
+    const uint64_t shared_sent = tick_expired_senders();
+    const auto shared_time = duration_cast<duration<double>>(steady_clock::now() - shared_start);
+
+    if (every_sent != shared_sent)
+    {
+        throw runtime_error("senders on a shared wheel sent " + to_string(shared_sent) + " segments, senders ticked every time sent "
+                            + to_string(every_sent));
+    }
+
+    const double every_us = every_time.count() * 1e6 / TICKS;
+    const double shared_us = shared_time.count() * 1e6 / TICKS;
+
+    fstream debug_output;          // 创建文件流对象
+    debug_output.open("/dev/tty"); // 打开终端设备
+
+    cout << CONNECTIONS << " unanswered SYNs, " << TICK_MS << " ms ticks, " << shared_sent << " segments sent: ticking every sender "
+         << fixed << setprecision(2) << every_us << " us/tick, ticking only expired senders on a shared wheel " << shared_us
+         << " us/tick.\n";
+
+    debug_output << "           Timer wheel tick cost: " << fixed << setprecision(2) << shared_us << " us (ticking every sender "
+                 << every_us << " us)\n";
+
+    if (shared_time >= every_time)
+    {
+        throw runtime_error("a shared timer wheel was not faster than ticking every sender");
+    }
+}
+
+int main()
+{
+    try
+    {
+        program_body();
+    }
+    catch (const exception &e)
+    {
+        cerr << "Exception: " << e.what() << "\n";
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}
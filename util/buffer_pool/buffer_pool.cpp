@@ -0,0 +1,210 @@
+#include <algorithm>
+#include <new>
+#include <sys/mman.h>
+#include "buffer_pool.h"
+
+namespace {
+
+// 每个 slab 的大小，小规格的块从一个 slab 中切出多块
+constexpr size_t SLAB_BYTES = 65536;
+
+// 一个 slab 切出的块数
+constexpr size_t chunks_per_slab(size_t cls)
+{
+    return SLAB_BYTES / BufferPool::CHUNK_SIZES.at(cls);
+}
+
+// 线程本地缓存的上限（块数），每个规格大约缓存一个 slab，超过时把一半归还全局；为空时一次从全局取四分之一
+constexpr size_t cache_limit(size_t cls)
+{
+    return std::max<size_t>(8, chunks_per_slab(cls));
+}
+constexpr size_t batch(size_t cls)
+{
+    return cache_limit(cls) / 4;
+}
+
+// 返回 size 所属的块规格下标，超过最大规格时返回 NUM_CLASSES
+size_t class_of(size_t size)
+{
+    const auto *it = std::lower_bound(BufferPool::CHUNK_SIZES.begin(), BufferPool::CHUNK_SIZES.end(), size);
+    return static_cast<size_t>(it - BufferPool::CHUNK_SIZES.begin());
+}
+
+} // namespace
+
+namespace {
+// 本线程的缓存是否已析构（例如静态对象在线程退出之后才释放缓冲区），此后直接使用全局链表
+thread_local bool thread_cache_destroyed = false; // NOLINT(*-avoid-non-const-global-variables)
+} // namespace
+
+// 线程本地的空闲块缓存，线程退出时把剩余的块归还全局链表
+class BufferPoolThreadCache
+{
+public:
+    std::array<std::vector<char *>, BufferPool::NUM_CLASSES> free{};
+
+    ~BufferPoolThreadCache()
+    {
+        thread_cache_destroyed = true;
+        for (size_t cls = 0; cls < BufferPool::NUM_CLASSES; ++cls)
+        {
+            BufferPool::global().release(cls, free[cls], free[cls].size());
+        }
+    }
+};
+
+namespace {
+thread_local BufferPoolThreadCache thread_cache; // NOLINT(*-avoid-non-const-global-variables)
+} // namespace
+
+BufferPool &BufferPool::global()
+{
+    // 有意不析构：其他线程的本地缓存可能在静态对象析构之后才归还块
+    static BufferPool *pool = new BufferPool; // NOLINT(*-owning-memory)
+    return *pool;
+}
+
+size_t BufferPool::chunk_size(size_t size)
+{
+    const size_t cls = class_of(size);
+    return cls < NUM_CLASSES ? CHUNK_SIZES.at(cls) : size;
+}
+
+char *BufferPool::allocate(size_t size)
+{
+    if (size == 0)
+    {
+        return nullptr;
+    }
+
+    const size_t cls = class_of(size);
+    bytes_outstanding_.fetch_add(chunk_size(size), std::memory_order_relaxed);
+    if (cls == NUM_CLASSES)
+    {
+        misses_.fetch_add(1, std::memory_order_relaxed);
+        return static_cast<char *>(::operator new(size));
+    }
+
+    std::vector<char *> fallback;
+    auto &local = thread_cache_destroyed ? fallback : thread_cache.free.at(cls);
+    if (local.empty() && refill(cls, batch(cls), local))
+    {
+        misses_.fetch_add(1, std::memory_order_relaxed);
+    }
+    else
+    {
+        hits_.fetch_add(1, std::memory_order_relaxed);
+    }
+    char *chunk = local.back();
+    local.pop_back();
+    if (!fallback.empty())
+    {
+        release(cls, fallback, fallback.size());
+    }
+    return chunk;
+}
+
+void BufferPool::deallocate(char *ptr, size_t size)
+{
+    if (ptr == nullptr)
+    {
+        return;
+    }
+
+    const size_t cls = class_of(size);
+    bytes_outstanding_.fetch_sub(chunk_size(size), std::memory_order_relaxed);
+    if (cls == NUM_CLASSES)
+    {
+        ::operator delete(ptr);
+        return;
+    }
+
+    if (thread_cache_destroyed)
+    {
+        std::vector<char *> single{ptr};
+        release(cls, single, 1);
+        return;
+    }
+
+    auto &local = thread_cache.free.at(cls);
+    local.push_back(ptr);
+    if (local.size() > cache_limit(cls))
+    {
+        release(cls, local, local.size() / 2);
+    }
+}
+
+bool BufferPool::refill(size_t cls, size_t count, std::vector<char *> &out)
+{
+    const std::lock_guard lock{mutex_};
+    auto &partial = partial_.at(cls);
+    bool new_slab = false;
+    if (partial.empty())
+    {
+        void *memory = ::mmap(nullptr, SLAB_BYTES, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (memory == MAP_FAILED)
+        {
+            throw std::bad_alloc{};
+        }
+        char *base = static_cast<char *>(memory);
+        Slab &slab = slabs_.emplace(base, Slab{cls}).first->second;
+        const size_t chunk = CHUNK_SIZES.at(cls);
+        for (size_t i = chunks_per_slab(cls); i > 0; --i)
+        {
+            slab.free.push_back(base + (i - 1) * chunk);
+        }
+        partial.push_back(base);
+        bytes_reserved_.fetch_add(SLAB_BYTES, std::memory_order_relaxed);
+        new_slab = true;
+    }
+
+    // 优先从最近有空闲块的 slab 取，取空的 slab 不再留在 partial 中
+    while (count > 0 && !partial.empty())
+    {
+        auto &free = slabs_.at(partial.back()).free;
+        const size_t n = std::min(count, free.size());
+        out.insert(out.end(), free.end() - static_cast<ptrdiff_t>(n), free.end());
+        free.resize(free.size() - n);
+        count -= n;
+        if (free.empty())
+        {
+            partial.pop_back();
+        }
+    }
+    return new_slab;
+}
+
+void BufferPool::release(size_t cls, std::vector<char *> &chunks, size_t count)
+{
+    const std::lock_guard lock{mutex_};
+    auto &partial = partial_.at(cls);
+    for (auto it = chunks.end() - static_cast<ptrdiff_t>(count); it != chunks.end(); ++it)
+    {
+        const auto slab = slabs_.lower_bound(*it); // 起始地址不大于块地址的第一个 slab
+        auto &free = slab->second.free;
+        if (free.empty())
+        {
+            partial.push_back(slab->first);
+        }
+        free.push_back(*it);
+
+        // 整个 slab 都空闲、且同规格还有别的 slab 可用时，交还系统
+        if (free.size() == chunks_per_slab(cls) && partial.size() > 1)
+        {
+            partial.erase(std::find(partial.begin(), partial.end(), slab->first));
+            ::munmap(slab->first, SLAB_BYTES);
+            slabs_.erase(slab);
+            bytes_reserved_.fetch_sub(SLAB_BYTES, std::memory_order_relaxed);
+        }
+    }
+    chunks.resize(chunks.size() - count);
+}
+
+BufferPool::Stats BufferPool::stats() const
+{
+    return {hits_.load(std::memory_order_relaxed),
+            misses_.load(std::memory_order_relaxed),
+            bytes_outstanding_.load(std::memory_order_relaxed),
+            bytes_reserved_.load(std::memory_order_relaxed)};
+}
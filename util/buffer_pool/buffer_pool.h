@@ -0,0 +1,101 @@
+#ifndef BUFFER_POOL_H
+#define BUFFER_POOL_H
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <string>
+#include <vector>
+
+// BufferPool 是进程共享的定长块内存池，为 ByteStream、Reassembler 等频繁申请字节缓冲区的地方服务。
+//
+// 请求按大小归入 256 B 到 64 KB 之间 2 的幂的块规格，得到不小于请求的最小一块，浪费不超过一半；
+// 更大的请求直接交给 operator new。每个线程有一份本地空闲块缓存，分配和释放通常不加锁；本地缓存为空或过多时，
+// 才成批地与全局空闲链表交换。全局也没有空闲块时，用 mmap 向系统申请一个 64 KB 的 slab 切成若干块。
+// 一个 slab 的块全部归还后，只要同规格还有别的 slab 可用，就把它 munmap 还给系统；
+// 每个规格至少留一个 slab，避免在申请和释放交替时反复映射。
+class BufferPool
+{
+public:
+    static constexpr std::array<size_t, 9> CHUNK_SIZES{256, 512, 1024, 2048, 4096, 8192, 16384, 32768, 65536}; // 块规格（字节）
+    static constexpr size_t NUM_CLASSES = CHUNK_SIZES.size();
+
+    // 池的运行统计
+    struct Stats
+    {
+        uint64_t hits;              // 由空闲块（线程缓存或全局链表）满足的分配次数
+        uint64_t misses;            // 需要向系统申请内存的分配次数（新 slab 或超过最大规格）
+        uint64_t bytes_outstanding; // 当前已借出、尚未归还的字节数（按块大小计）
+        uint64_t bytes_reserved;    // 当前向系统映射的 slab 字节数
+    };
+
+    // 进程唯一的内存池
+    static BufferPool &global();
+
+    // 申请至少 size 字节的缓冲区；size 为 0 时返回 nullptr
+    char *allocate(size_t size);
+    // 归还 allocate(size) 得到的缓冲区，size 必须与申请时相同
+    void deallocate(char *ptr, size_t size);
+
+    Stats stats() const;
+
+    // 一个缓冲区实际占用的字节数：所在块规格的大小，超过最大规格时为 size 本身
+    static size_t chunk_size(size_t size);
+
+    BufferPool(const BufferPool &) = delete;
+    BufferPool &operator=(const BufferPool &) = delete;
+
+private:
+    BufferPool() = default;
+    ~BufferPool() = default;
+
+    friend class BufferPoolThreadCache;
+
+    // 从系统映射的一块内存，切成同一规格的若干块
+    struct Slab
+    {
+        size_t cls;                 // 块规格下标
+        std::vector<char *> free{}; // 已归还全局、尚未再借出的块
+    };
+
+    // 从全局取出至多 count 个空闲块放入 out，必要时申请新的 slab；返回是否新申请了 slab
+    bool refill(size_t cls, size_t count, std::vector<char *> &out);
+    // 把 chunks 末尾的 count 个块归还各自的 slab，全部空闲的 slab 交还系统
+    void release(size_t cls, std::vector<char *> &chunks, size_t count);
+
+    mutable std::mutex mutex_{};
+    std::map<char *, Slab, std::greater<>> slabs_{};         // 所有 slab，按起始地址降序，lower_bound 找到块所属的 slab
+    std::array<std::vector<char *>, NUM_CLASSES> partial_{}; // 每个规格中有空闲块的 slab 的起始地址
+
+    std::atomic<uint64_t> hits_{0};
+    std::atomic<uint64_t> misses_{0};
+    std::atomic<uint64_t> bytes_outstanding_{0};
+    std::atomic<uint64_t> bytes_reserved_{0};
+};
+
+// 从 BufferPool 分配内存的标准分配器，可用于 std::basic_string 等容器
+template <typename T>
+class PoolAllocator
+{
+public:
+    using value_type = T;
+
+    PoolAllocator() = default;
+    template <typename U>
+    PoolAllocator(const PoolAllocator<U> & /*unused*/) noexcept {} // NOLINT(*-explicit-*)
+
+    T *allocate(size_t n) { return reinterpret_cast<T *>(BufferPool::global().allocate(n * sizeof(T))); } // NOLINT(*-reinterpret-cast)
+    void deallocate(T *ptr, size_t n) { BufferPool::global().deallocate(reinterpret_cast<char *>(ptr), n * sizeof(T)); } // NOLINT(*-reinterpret-cast)
+
+    template <typename U>
+    bool operator==(const PoolAllocator<U> & /*unused*/) const noexcept { return true; }
+};
+
+// 内存来自 BufferPool 的字符串
+using PooledString = std::basic_string<char, std::char_traits<char>, PoolAllocator<char>>;
+
+#endif // BUFFER_POOL_H
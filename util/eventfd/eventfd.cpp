@@ -0,0 +1,38 @@
+#include <poll.h>         // 引入 poll 函数的定义
+#include <unistd.h>       // 引入 POSIX 操作系统 API
+#include <sys/eventfd.h>  // 引入 eventfd 的定义
+#include <cerrno>         // 引入错误码定义
+#include "eventfd.h"      // 引入 EventFD 类的头文件
+#include "exception.h"    // 引入自定义异常处理类头文件
+
+// EventFD 构造函数，创建非阻塞的 eventfd
+EventFD::EventFD() : FileDescriptor(::CheckSystemCall("eventfd", ::eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC))) {}
+
+void EventFD::notify()
+{
+    const uint64_t one = 1;
+    // 计数器只有在接近 UINT64_MAX 时才会 EAGAIN，此时描述符本来就是可读的，可以忽略
+    CheckSystemCall("write", ::write(fd_num(), &one, sizeof(one)));
+    register_write();
+}
+
+uint64_t EventFD::drain()
+{
+    uint64_t count = 0;
+    // 非阻塞模式下没有信号时 read 返回 EAGAIN，CheckSystemCall 将其视为 0，count 保持为 0
+    CheckSystemCall("read", ::read(fd_num(), &count, sizeof(count)));
+    register_read();
+    return count;
+}
+
+void EventFD::wait()
+{
+    pollfd pfd{fd_num(), POLLIN, 0};
+    while (::poll(&pfd, 1, -1) < 0)
+    {
+        if (errno != EINTR)
+        {
+            throw unix_error{"poll"};
+        }
+    }
+}
@@ -0,0 +1,22 @@
+#ifndef EVENTFD_H
+#define EVENTFD_H
+
+#include "file_descriptor.h" // 引入自定义的文件描述符类
+
+// EventFD 类封装 Linux eventfd，用作线程间的轻量唤醒信号。
+// notify() 使计数器加一，描述符随即变为可读；drain() 读出并清零计数器。
+// 描述符总是非阻塞的，可以直接交给 EventLoop 或 poll() 等待。
+class EventFD : public FileDescriptor
+{
+public:
+    EventFD();
+
+    // 发出一次唤醒信号
+    void notify();
+    // 清除所有未处理的唤醒信号，返回自上次清除以来的信号次数（没有信号时为 0）
+    uint64_t drain();
+    // 阻塞直到收到唤醒信号（不清除信号）
+    void wait();
+};
+
+#endif // EVENTFD_H
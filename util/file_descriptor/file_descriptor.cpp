@@ -6,9 +6,34 @@
 #include <sys/stat.h>         // 包含文件状态的定义
 #include <sys/types.h>        // 包含数据类型的定义
 #include <algorithm>          // 包含算法函数
+#include <array>              // 包含 std::array
+#include <vector>             // 包含 std::vector
 #include "exception.h"        // 自定义异常类的头文件
 #include "file_descriptor.h"  // FileDescriptor 类的头文件
 
+namespace
+{
+// readv/writev 的 iovec 数组：不超过 N 个时放在栈上，否则在堆上分配，不截断调用者的缓冲区
+template <size_t N>
+class IovecArray
+{
+public:
+    explicit IovecArray(std::ptrdiff_t count)
+    {
+        if (static_cast<size_t>(count) > N)
+        {
+            heap_.resize(count);
+        }
+    }
+    iovec &operator[](size_t i) { return data()[i]; }
+    iovec *data() { return heap_.empty() ? stack_.data() : heap_.data(); }
+
+private:
+    std::array<iovec, N> stack_{};
+    std::vector<iovec> heap_{};
+};
+} // namespace
+
 // 检查系统调用的返回值
 template <typename T>
 T FileDescriptor::FDWrapper::CheckSystemCall(std::string_view s_attempt, T return_value) const
@@ -177,10 +202,54 @@ void FileDescriptor::read(std::vector<std::string> &buffers)
     }
 }
 
+// 从文件描述符直接读取数据到给定的内存区间
+size_t FileDescriptor::read(std::span<const std::span<char>> buffers)
+{
+    IovecArray<kMaxIovecs> iovecs{std::ranges::count_if(buffers, [](const auto &buf) { return !buf.empty(); })};
+    size_t count = 0;      // 有效的 iovec 数量
+    size_t total_size = 0; // 记录总大小
+    for (const auto &buf : buffers)
+    {
+        if (!buf.empty())
+        {
+            iovecs[count++] = {buf.data(), buf.size()};
+            total_size += buf.size();
+        }
+    }
+    if (total_size == 0) // 没有可写入的空间，不发起系统调用（否则会被误判为 EOF）
+    {
+        return 0;
+    }
+
+    // 使用 readv 进行读取
+    const ssize_t bytes_read = ::readv(fd_num(), iovecs.data(), static_cast<int>(count));
+    if (bytes_read < 0) // 检查读取是否成功
+    {
+        if (internal_fd_->non_blocking_ && (errno == EAGAIN || errno == EINPROGRESS))
+        {
+            return 0; // 如果是非阻塞模式且没有数据，返回 0
+        }
+        throw unix_error{"readv"}; // 否则抛出异常
+    }
+
+    register_read(); // 注册读取操作
+
+    if (bytes_read == 0) // 如果读取到 EOF
+    {
+        internal_fd_->eof_ = true; // 设置 EOF 标志
+    }
+
+    if (bytes_read > static_cast<ssize_t>(total_size)) // 检查读取的字节数是否超过总大小
+    {
+        throw std::runtime_error("read() read more than requested");
+    }
+    return bytes_read; // 返回读取的字节数
+}
+
 // 写入数据到文件描述符
 size_t FileDescriptor::write(std::string_view buffer)
 {
-    return write(std::vector<std::string_view>{buffer}); // 将字符串视图转换为字符串向量并调用写入方法
+    return write(std::span<const std::string_view>{&buffer, 1}); // 单个视图直接走 writev 路径，不再构造临时向量
 }
 
 // 写入字符串向量到文件描述符
@@ -198,17 +267,28 @@ size_t FileDescriptor::write(const std::vector<std::string> &buffers)
 // 写入字符串视图向量到文件描述符
 size_t FileDescriptor::write(const std::vector<std::string_view> &buffers)
 {
-    std::vector<iovec> iovecs;      // 创建 iovec 结构的向量
-    iovecs.reserve(buffers.size()); // 预留空间
-    size_t total_size = 0;          // 记录总大小
-    for (const auto x : buffers)    // 遍历字符串视图向量
+    return write(std::span<const std::string_view>{buffers});
+}
+
+// 写入一组字符串视图到文件描述符
+size_t FileDescriptor::write(std::span<const std::string_view> buffers)
+{
+    // 所有缓冲区在一次 writev 中写出：写入 TUN 等数据报设备时，一次写入就是一个完整的数据报
+    IovecArray<kMaxIovecs> iovecs{std::ranges::count_if(buffers, [](const auto x) { return !x.empty(); })};
+    size_t count = 0;            // 有效的 iovec 数量
+    size_t total_size = 0;       // 记录总大小
+    for (const auto x : buffers) // 遍历字符串视图
     {
-        iovecs.push_back({const_cast<char *>(x.data()), x.size()}); // 将每个字符串视图添加到 iovec
-        total_size += x.size();                                     // 累加总大小
+        if (x.empty())
+        {
+            continue; // 跳过空视图
+        }
+        iovecs[count++] = {const_cast<char *>(x.data()), x.size()}; // 将字符串视图添加到 iovec
+        total_size += x.size();                                      // 累加总大小
     }
 
     // 使用 writev 进行写入
-    const ssize_t bytes_written = CheckSystemCall("writev", ::writev(fd_num(), iovecs.data(), static_cast<int>(iovecs.size())));
+    const ssize_t bytes_written = CheckSystemCall("writev", ::writev(fd_num(), iovecs.data(), static_cast<int>(count)));
     register_write(); // 注册写入操作
 
     if (bytes_written == 0 && total_size != 0) // 检查写入是否成功
@@ -4,6 +4,8 @@
 #include <cstddef> // 包含 size_t 类型
 #include <limits>  // 包含数值限制
 #include <memory>  // 包含智能指针
+#include <span>    // 包含 std::span
+#include <string_view> // 包含字符串视图
 #include <vector>  // 包含向量类
 
 // FileDescriptor 类用于封装文件描述符的操作
@@ -45,6 +47,7 @@ class FileDescriptor
 
 protected:
     static constexpr size_t kReadBufferSize = 16384; // 读取缓冲区大小
+    static constexpr size_t kMaxIovecs = 16;         // 单次 readv/writev 在栈上准备的最大 iovec 数量，更多时改用堆
 
     // 设置 EOF 标志
     void set_eof() { internal_fd_->eof_ = true; }
@@ -67,11 +70,15 @@ public:
     void read(std::string &buffer);
     // 读取数据到字符串向量
     void read(std::vector<std::string> &buffers);
+    // 使用 readv 将数据直接读入调用者提供的内存区间（例如 Writer::prepare() 的返回值），返回读取的字节数
+    size_t read(std::span<const std::span<char>> buffers);
 
     // 写入数据，接受字符串视图
     size_t write(std::string_view buffer);
     // 写入数据，接受字符串视图向量
     size_t write(const std::vector<std::string_view> &buffers);
+    // 写入数据，接受一组字符串视图（例如 Reader::peek_iov() 的返回值），一次 writev 写出，返回写入的字节数
+    size_t write(std::span<const std::string_view> buffers);
     // 写入数据，接受字符串向量
     size_t write(const std::vector<std::string> &buffers);
 
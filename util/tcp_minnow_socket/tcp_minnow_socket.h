@@ -14,9 +14,12 @@
 #include <atomic>              // 包含原子操作的定义
 #include <cstdint>             // 包含固定宽度整数类型的定义
 #include <optional>            // 包含可选类型的定义
+#include <memory>              // 包含智能指针的定义
+#include <poll.h>              // 包含 poll 函数的定义
 #include <thread>              // 包含线程的定义
 #include <vector>              // 包含向量的定义
 #include "byte_stream.h"       // 包含字节流的定义
+#include "spsc_byte_stream.h"  // 包含单生产者单消费者字节流的定义
 #include "eventloop.h"         // 包含事件循环的定义
 #include "file_descriptor.h"   // 包含文件描述符的定义
 #include "socket.h"            // 包含套接字的定义
@@ -30,6 +33,13 @@
 // 定义 TCP 轮询的时间间隔（毫秒）
 static constexpr size_t TCP_TICK_MS = 10;
 
+// 所有者线程与 TCP 线程之间传递应用数据的方式
+enum class TCPMinnowTransport
+{
+    SocketPair,  // 经由 Unix 域套接字对，每个字节在内核中往返两次，套接字本身可直接交给 poll/EventLoop
+    SharedMemory // 经由一对 SPSCByteStream，read()/write() 只是用户态拷贝，必要时才用 eventfd 唤醒对端
+};
+
 // 获取当前时间戳（毫秒）
 inline uint64_t timestamp_ms()
 {
@@ -45,8 +55,21 @@ template <TCPDatagramAdapter AdaptT>
 class TCPMinnowSocket : public LocalStreamSocket
 {
 public:
-    // 构造函数，接受一个适配器接口，用于读取和写入数据报
-    explicit TCPMinnowSocket(AdaptT &&datagram_interface);
+    // 构造函数，接受一个适配器接口，用于读取和写入数据报，以及与 TCP 线程之间的传输方式
+    explicit TCPMinnowSocket(AdaptT &&datagram_interface, TCPMinnowTransport transport = TCPMinnowTransport::SocketPair);
+
+    // 所有者线程的应用数据接口，语义与非阻塞套接字的 read()/write() 相同，两种传输方式下都可以使用。
+    // SharedMemory 模式下只能通过这些接口收发数据：底层套接字不再承载数据，继承自 Socket 的
+    // read()/write()/shutdown()（包括经由 Socket & 的调用，例如 bidirectional_stream_copy）不经过共享内存环。
+    void app_read(std::string &buffer);
+    size_t app_write(std::string_view buffer);
+
+    // 阻塞直到有数据可读（或已到达 EOF）/ 可以写入
+    void app_wait_readable();
+    void app_wait_writable();
+
+    // 关闭读/写方向；SharedMemory 模式下关闭写方向同时关闭出站环，通知 TCP 线程数据已写完
+    void app_shutdown(int how);
 
     // 关闭套接字，并等待 TCPPeer 线程完成
     void wait_until_closed();
@@ -80,9 +103,17 @@ protected:
 private:
     LocalStreamSocket _thread_data; // 用于所有者和 TCP 线程之间读写的流套接字
 
+    TCPMinnowTransport _transport; // 所有者和 TCP 线程之间的传输方式
+
+    std::unique_ptr<SPSCByteStream> _app_outbound{}; // SharedMemory 模式下所有者写入、TCP 线程读出的数据
+    std::unique_ptr<SPSCByteStream> _app_inbound{};  // SharedMemory 模式下 TCP 线程写入、所有者读出的数据
+
     // 初始化 TCPPeer 和事件循环
     void _initialize_TCP(const TCPConfig &config);
 
+    // 为 SharedMemory 模式注册在 TCPPeer 与两个 SPSCByteStream 之间搬运数据的规则
+    void _initialize_shared_memory_rules();
+
     std::optional<TCPPeer> _tcp{}; // TCP 对等体的可选实例
 
     EventLoop _eventloop{}; // 处理所有事件的事件循环
@@ -96,7 +127,7 @@ private:
     std::thread _tcp_thread{}; // TCPPeer 线程的句柄，所有者线程在析构函数中调用 join()
 
     // 从套接字对构造 LocalStreamSocket 文件描述符，初始化事件循环
-    TCPMinnowSocket(std::pair<FileDescriptor, FileDescriptor> data_socket_pair, AdaptT &&datagram_interface);
+    TCPMinnowSocket(std::pair<FileDescriptor, FileDescriptor> data_socket_pair, AdaptT &&datagram_interface, TCPMinnowTransport transport);
 
     std::atomic_bool _abort{false}; // 用于强制 TCPPeer 线程关闭的标志
 
@@ -122,7 +153,16 @@ public:
     void connect(const Address &address)
     {
         TCPConfig tcp_config;        // 创建 TCP 配置对象
-        tcp_config.rt_timeout = 100; // 设置重传超时
+        tcp_config.rt_timeout = 100;    // 设置重传超时
+        tcp_config.adaptive_rto = true; // 由 RTT 估计后续的重传超时
+        tcp_config.sack = true;         // 声明支持 SACK，多个丢包时只重传缺失的区间
+        tcp_config.window_scaling = true; // 声明窗口扩大选项，接收缓冲区较大时窗口不受 65535 的限制
+        tcp_config.mss = 1460;          // 1500 字节的 MTU 减去 IPv4 和 TCP 首部
+        tcp_config.mtu_probing = true;  // 从 1000 字节的报文段开始，探测路径能否通过更大的报文段
+        tcp_config.rack = true;         // 按发送时间判定丢失，尾部丢包由探测发现而不必等待超时
+        tcp_config.delayed_ack = true;  // 每两个报文段确认一次，减少 TUN 上的纯确认报文
+        tcp_config.recv_capacity_max = 4 * 1024 * 1024; // 应用读得快时把接收缓冲区逐步扩大到 4 MiB
+        tcp_config.stream_storage = ByteStream::Storage::Mirrored; // 使用双重映射存储，每次写出全部缓冲数据
 
         FdAdapterConfig multiplexer_config;                                                              // 创建文件描述符适配器配置
         multiplexer_config.source = {"169.254.144.9", std::to_string(uint16_t(std::random_device()()))}; // 设置源地址和端口
@@ -166,10 +206,12 @@ void TCPMinnowSocket<AdaptT>::_tcp_loop(const std::function<bool()> &condition)
 // TCPMinnowSocket 构造函数
 template <TCPDatagramAdapter AdaptT>
 TCPMinnowSocket<AdaptT>::TCPMinnowSocket(std::pair<FileDescriptor, FileDescriptor> data_socket_pair,
-                                         AdaptT &&datagram_interface)
+                                         AdaptT &&datagram_interface,
+                                         TCPMinnowTransport transport)
     : LocalStreamSocket(std::move(data_socket_pair.first)), // 初始化基类 LocalStreamSocket
       _datagram_adapter(std::move(datagram_interface)),     // 初始化数据报适配器
-      _thread_data(std::move(data_socket_pair.second))
+      _thread_data(std::move(data_socket_pair.second)),
+      _transport(transport)
 {                                     // 初始化线程数据
     _thread_data.set_blocking(false); // 设置线程数据为非阻塞
     set_blocking(false);              // 设置当前套接字为非阻塞
@@ -200,7 +242,7 @@ void TCPMinnowSocket<AdaptT>::_initialize_TCP(const TCPConfig &config)
             }
 
             // 调试输出
-            if (_thread_data.eof() && _tcp.value().sender().sequence_numbers_in_flight() == 0 && !_fully_acked)
+            if (_outbound_shutdown && _tcp.value().sender().sequence_numbers_in_flight() == 0 && !_fully_acked)
             {
                 std::cerr << "DEBUG: minnow outbound stream to " << _datagram_adapter.config().destination.to_string();
                 std::cerr << " has been fully acknowledged.\n";
@@ -211,6 +253,14 @@ void TCPMinnowSocket<AdaptT>::_initialize_TCP(const TCPConfig &config)
         { return _tcp->active(); } // 仅在 TCP 连接处于活动状态时执行
     );
 
+    if (_transport == TCPMinnowTransport::SharedMemory)
+    {
+        _app_outbound = std::make_unique<SPSCByteStream>(config.send_capacity);
+        _app_inbound = std::make_unique<SPSCByteStream>(config.recv_capacity);
+        _initialize_shared_memory_rules();
+        return;
+    }
+
     // 规则 2：从管道读取到出站缓冲区
     _eventloop.add_rule(
         "push bytes to TCPPeer",
@@ -218,10 +268,9 @@ void TCPMinnowSocket<AdaptT>::_initialize_TCP(const TCPConfig &config)
         Direction::In, // 输入方向
         [&]
         {
-            std::string data;                                          // 存储读取的数据
-            data.resize(_tcp->outbound_writer().available_capacity()); // 调整大小以适应可用容量
-            _thread_data.read(data);                                   // 从线程数据读取
-            _tcp->outbound_writer().push(std::move(data));             // 推送到 TCP 的出站写入器
+            // 直接读入出站字节流的存储，避免临时字符串的清零和二次拷贝
+            Writer &outbound = _tcp->outbound_writer();
+            outbound.commit(_thread_data.read(outbound.prepare(outbound.available_capacity())));
 
             if (_thread_data.eof())
             {                                    // 如果到达文件末尾
@@ -262,9 +311,8 @@ void TCPMinnowSocket<AdaptT>::_initialize_TCP(const TCPConfig &config)
             // 从 inbound_stream 写入到管道，处理部分写入的可能性
             if (inbound.bytes_buffered())
             {                                                          // 如果有缓冲字节
-                const std::string_view buffer = inbound.peek();        // 查看缓冲区
-                const auto bytes_written = _thread_data.write(buffer); // 写入到线程数据
-                inbound.pop(bytes_written);                            // 从读取器中弹出已写入的字节
+                // 用一次 writev 写出所有缓冲的数据段，再弹出实际写入的字节
+                inbound.pop(_thread_data.write(inbound.peek_iov()));
             }
 
             // 检查传入流是否完成或有错误
@@ -290,6 +338,98 @@ void TCPMinnowSocket<AdaptT>::_initialize_TCP(const TCPConfig &config)
         });
 }
 
+// SharedMemory 模式下的规则 2 和规则 3
+template <TCPDatagramAdapter AdaptT>
+void TCPMinnowSocket<AdaptT>::_initialize_shared_memory_rules()
+{
+    // 规则 2a：所有者在出站环为空时写入会触发 eventfd，这里只负责清除信号、唤醒事件循环
+    _eventloop.add_rule(
+        "wake on bytes from owner",
+        _app_outbound->readable_event(),
+        Direction::In,
+        [&] { _app_outbound->readable_event().drain(); },
+        [&] { return _tcp->active() && !_outbound_shutdown; });
+
+    // 规则 2b：把出站环中的数据拷贝进 TCPPeer 的出站字节流。
+    // 不依赖 fd：ACK 腾出发送缓冲区后下一轮事件循环就会继续搬运
+    _eventloop.add_rule(
+        "push bytes to TCPPeer",
+        [&]
+        {
+            Writer &outbound = _tcp->outbound_writer();
+            uint64_t moved = 0;
+            for (const auto span : outbound.prepare(_app_outbound->bytes_buffered()))
+            {
+                moved += _app_outbound->read(span);
+            }
+            outbound.commit(moved);
+
+            if (_app_outbound->is_finished())
+            {
+                outbound.close();          // 关闭写入器
+                _outbound_shutdown = true; // 标记为出站关闭
+
+                // 调试输出
+                std::cerr << "DEBUG: minnow outbound stream to " << _datagram_adapter.config().destination.to_string();
+                std::cerr << " finished (" << _tcp.value().sender().sequence_numbers_in_flight() << " seqno";
+                std::cerr << (_tcp.value().sender().sequence_numbers_in_flight() == 1 ? "" : "s");
+                std::cerr << " still in flight).\n";
+            }
+            _tcp->push([&](auto x) { _datagram_adapter.write(x); }); // 推送数据到数据报适配器
+        },
+        [&]
+        {
+            return _tcp->active() && !_outbound_shutdown
+                   && ((_app_outbound->bytes_buffered() > 0 && _tcp->outbound_writer().available_capacity() > 0)
+                       || _app_outbound->is_finished());
+        });
+
+    // 规则 3a：入站环从满变为不满时所有者会触发 eventfd，这里只负责清除信号、唤醒事件循环
+    _eventloop.add_rule(
+        "wake on space from owner",
+        _app_inbound->writable_event(),
+        Direction::In,
+        [&] { _app_inbound->writable_event().drain(); },
+        [&] { return !_inbound_shutdown; });
+
+    // 规则 3b：把重组后的入站字节拷贝进入站环
+    _eventloop.add_rule(
+        "read bytes from inbound stream",
+        [&]
+        {
+            Reader &inbound = _tcp->inbound_reader();
+            // 入站字节流至多两段，逐段推入入站环，再弹出实际推入的字节
+            uint64_t moved = 0;
+            for (const auto view : inbound.peek_iov(_app_inbound->available_capacity()))
+            {
+                moved += _app_inbound->push(view);
+            }
+            inbound.pop(moved);
+
+            // 检查传入流是否完成或有错误
+            if (inbound.is_finished() || inbound.has_error())
+            {
+                if (inbound.has_error())
+                {
+                    _app_inbound->set_error();
+                }
+                _app_inbound->close();
+                _inbound_shutdown = true; // 标记为传入关闭
+
+                // 调试输出
+                std::cerr << "DEBUG: minnow inbound stream from " << _datagram_adapter.config().destination.to_string();
+                std::cerr << " finished " << (inbound.has_error() ? "uncleanly.\n" : "cleanly.\n");
+            }
+        },
+        [&]
+        {
+            const Reader &inbound = _tcp->inbound_reader();
+            return !_inbound_shutdown
+                   && ((inbound.bytes_buffered() > 0 && _app_inbound->available_capacity() > 0)
+                       || inbound.is_finished() || inbound.has_error());
+        });
+}
+
 // 调用 socketpair 并返回指定类型的连接 Unix 域套接字
 template <std::derived_from<Socket> SocketType>
 inline std::pair<SocketType, SocketType> socket_pair_helper(int domain, int type, int protocol = 0)
@@ -301,8 +441,80 @@ inline std::pair<SocketType, SocketType> socket_pair_helper(int domain, int type
 
 // datagram_interface 是底层接口（例如 UDP、IP 或以太网）
 template <TCPDatagramAdapter AdaptT>
-TCPMinnowSocket<AdaptT>::TCPMinnowSocket(AdaptT &&datagram_interface)
-    : TCPMinnowSocket(socket_pair_helper<LocalStreamSocket>(AF_UNIX, SOCK_STREAM), std::move(datagram_interface)) {}
+TCPMinnowSocket<AdaptT>::TCPMinnowSocket(AdaptT &&datagram_interface, TCPMinnowTransport transport)
+    : TCPMinnowSocket(socket_pair_helper<LocalStreamSocket>(AF_UNIX, SOCK_STREAM), std::move(datagram_interface), transport) {}
+
+// 所有者线程读取数据
+template <TCPDatagramAdapter AdaptT>
+void TCPMinnowSocket<AdaptT>::app_read(std::string &buffer)
+{
+    if (!_app_inbound)
+    {
+        LocalStreamSocket::read(buffer);
+        return;
+    }
+
+    if (buffer.empty())
+    { // 与 FileDescriptor::read 相同，空缓冲区按默认大小读取
+        buffer.resize(kReadBufferSize);
+    }
+    buffer.resize(_app_inbound->read(buffer));
+    register_read();
+    if (buffer.empty() && (_app_inbound->is_finished() || _app_inbound->has_error()))
+    {
+        set_eof(); // 流已结束，与套接字读到 0 字节时相同
+    }
+}
+
+// 所有者线程写入数据，返回实际写入的字节数
+template <TCPDatagramAdapter AdaptT>
+size_t TCPMinnowSocket<AdaptT>::app_write(std::string_view buffer)
+{
+    if (!_app_outbound)
+    {
+        return LocalStreamSocket::write(buffer);
+    }
+
+    register_write();
+    return _app_outbound->push(buffer);
+}
+
+// 关闭读/写方向
+template <TCPDatagramAdapter AdaptT>
+void TCPMinnowSocket<AdaptT>::app_shutdown(int how)
+{
+    if (_app_outbound && (how == SHUT_WR || how == SHUT_RDWR))
+    {
+        _app_outbound->close();
+    }
+    LocalStreamSocket::shutdown(how);
+}
+
+// 阻塞直到有数据可读
+template <TCPDatagramAdapter AdaptT>
+void TCPMinnowSocket<AdaptT>::app_wait_readable()
+{
+    if (_app_inbound)
+    {
+        _app_inbound->wait_readable();
+        return;
+    }
+    pollfd pfd{fd_num(), POLLIN, 0};
+    CheckSystemCall("poll", ::poll(&pfd, 1, -1));
+}
+
+// 阻塞直到可以写入
+template <TCPDatagramAdapter AdaptT>
+void TCPMinnowSocket<AdaptT>::app_wait_writable()
+{
+    if (_app_outbound)
+    {
+        _app_outbound->wait_writable();
+        return;
+    }
+    pollfd pfd{fd_num(), POLLOUT, 0};
+    CheckSystemCall("poll", ::poll(&pfd, 1, -1));
+}
 
 // TCPMinnowSocket 析构函数
 template <TCPDatagramAdapter AdaptT>
@@ -327,7 +539,7 @@ TCPMinnowSocket<AdaptT>::~TCPMinnowSocket()
 template <TCPDatagramAdapter AdaptT>
 void TCPMinnowSocket<AdaptT>::wait_until_closed()
 {
-    shutdown(SHUT_RDWR); // 关闭读写
+    app_shutdown(SHUT_RDWR); // 关闭读写，SharedMemory 模式下同时关闭出站环
     if (_tcp_thread.joinable())
     {                                                                // 如果 TCP 线程可连接
         std::cerr << "DEBUG: minnow waiting for clean shutdown... "; // 调试输出
@@ -408,8 +620,16 @@ void TCPMinnowSocket<AdaptT>::_tcp_main()
         {                                       // 检查 TCP 是否已初始化
             throw std::runtime_error("no TCP"); // 抛出异常
         }
-        _tcp_loop([] { return true; }); // 进入 TCP 循环
-        shutdown(SHUT_RDWR);            // 关闭读写
+        _tcp_loop([] { return true; });         // 进入 TCP 循环
+        LocalStreamSocket::shutdown(SHUT_RDWR); // 关闭读写（出站环只能由所有者关闭）
+        if (_app_inbound)
+        { // SharedMemory 模式下不再有人消费出站环或生产入站环，唤醒可能在等待的所有者
+            if (!_inbound_shutdown)
+            {
+                _app_inbound->set_error();
+            }
+            _app_outbound->set_error();
+        }
         if (!_tcp.value().active())
         { // 检查 TCP 连接是否仍然活动
             std::cerr << "DEBUG: minnow TCP connection finished ";
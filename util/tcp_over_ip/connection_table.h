@@ -0,0 +1,199 @@
+#ifndef CONNECTION_TABLE_H
+#define CONNECTION_TABLE_H
+
+#include <cstddef>   // 包含 size_t 的定义
+#include <cstdint>   // 包含固定宽度整数类型的定义
+#include <optional>  // 包含可选类型的定义
+#include <utility>   // 包含 std::move、std::pair 的定义
+#include <vector>    // 包含向量的定义
+
+// TCP 连接的四元组，从本端的角度描述；地址是与 IPv4Header 相同的数值形式
+struct FourTuple
+{
+    uint32_t local_ip{};    // 本端地址
+    uint32_t remote_ip{};   // 对方地址
+    uint16_t local_port{};  // 本端端口
+    uint16_t remote_port{}; // 对方端口
+
+    bool operator==(const FourTuple &other) const = default;
+
+    // 把四个字段混合成 64 位散列值（splitmix64 的终结函数），低位同样均匀，可以直接按 2 的幂取模
+    uint64_t hash() const
+    {
+        uint64_t x = (uint64_t{local_ip} << 32 | remote_ip) ^ ((uint64_t{local_port} << 16 | remote_port) * 0x9e3779b97f4a7c15ULL);
+        x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ULL;
+        x = (x ^ (x >> 27)) * 0x94d049bb133111ebULL;
+        return x ^ (x >> 31);
+    }
+};
+
+// ConnectionTable 是以四元组为键的开放寻址散列表（线性探测）。键和值连续存放在一个数组里，
+// 查找只计算一次散列、再顺序比较相邻的几个槽，代价不随连接数增长。
+//
+// 槽数是 2 的幂，元素超过槽数的 3/4 时加倍。删除时把后面同一探测序列上的元素前移（backward shift），
+// 不留墓碑：大量连接建立又关闭之后，探测长度也不会越来越长。
+//
+// 插入和删除会搬动元素：find() 返回的指针在下一次 emplace()/erase() 之前有效。
+// 值较大或需要固定地址时，存放 std::unique_ptr。
+template <class T>
+class ConnectionTable
+{
+public:
+    // 元素个数
+    size_t size() const { return size_; }
+    // 表是否为空
+    bool empty() const { return size_ == 0; }
+
+    // 查找键为 key 的元素，不存在时返回 nullptr
+    T *find(const FourTuple &key)
+    {
+        const size_t i = locate(key);
+        return i == NPOS ? nullptr : &*slots_[i].value;
+    }
+    const T *find(const FourTuple &key) const
+    {
+        const size_t i = locate(key);
+        return i == NPOS ? nullptr : &*slots_[i].value;
+    }
+
+    // 插入键为 key、由 args 构造的元素；key 已存在时不插入。返回元素和是否新插入
+    template <class... Args>
+    std::pair<T *, bool> emplace(const FourTuple &key, Args &&...args)
+    {
+        if (T *existing = find(key))
+        {
+            return {existing, false};
+        }
+        if ((size_ + 1) * 4 > slots_.size() * 3)
+        {
+            rehash(slots_.empty() ? MIN_SLOTS : slots_.size() * 2);
+        }
+
+        size_t i = home(key);
+        while (slots_[i].value.has_value())
+        {
+            i = (i + 1) & mask();
+        }
+        slots_[i].key = key;
+        slots_[i].value.emplace(std::forward<Args>(args)...);
+        ++size_;
+        return {&*slots_[i].value, true};
+    }
+
+    // 删除键为 key 的元素，返回它是否存在
+    bool erase(const FourTuple &key)
+    {
+        size_t hole = locate(key);
+        if (hole == NPOS)
+        {
+            return false;
+        }
+        slots_[hole].value.reset();
+        --size_;
+
+        // 之后的元素如果探测时经过了空出的槽，就前移填上，直到遇到空槽
+        for (size_t j = (hole + 1) & mask(); slots_[j].value.has_value(); j = (j + 1) & mask())
+        {
+            // 元素的起始槽在 (hole, j] 之间时，它的探测序列不经过 hole，留在原处
+            if (((j - home(slots_[j].key)) & mask()) < ((j - hole) & mask()))
+            {
+                continue;
+            }
+            slots_[hole].key = slots_[j].key;
+            slots_[hole].value = std::move(slots_[j].value);
+            slots_[j].value.reset();
+            hole = j;
+        }
+        return true;
+    }
+
+    // 按槽的顺序对每个元素调用 f(key, value)；f 中不能插入或删除元素
+    template <class F>
+    void for_each(F &&f)
+    {
+        for (auto &slot : slots_)
+        {
+            if (slot.value.has_value())
+            {
+                f(static_cast<const FourTuple &>(slot.key), *slot.value);
+            }
+        }
+    }
+
+    // 删除 pred(key, value) 为 true 的元素，返回删除的个数
+    template <class Pred>
+    size_t erase_if(Pred &&pred)
+    {
+        std::vector<FourTuple> doomed;
+        const auto collect = [&](const FourTuple &key, T &value)
+        {
+            if (pred(key, value))
+            {
+                doomed.push_back(key);
+            }
+        };
+        for_each(collect);
+        for (const auto &key : doomed)
+        {
+            erase(key);
+        }
+        return doomed.size();
+    }
+
+private:
+    static constexpr size_t MIN_SLOTS = 16;
+    static constexpr size_t NPOS = SIZE_MAX;
+
+    struct Slot
+    {
+        FourTuple key{};
+        std::optional<T> value{}; // 为空表示空槽
+    };
+
+    std::vector<Slot> slots_{};
+    size_t size_{};
+
+    size_t mask() const { return slots_.size() - 1; }
+    size_t home(const FourTuple &key) const { return static_cast<size_t>(key.hash()) & mask(); }
+
+    // 从起始槽开始探测，遇到空槽说明 key 不存在
+    size_t locate(const FourTuple &key) const
+    {
+        if (size_ == 0)
+        {
+            return NPOS;
+        }
+        for (size_t i = home(key);; i = (i + 1) & mask())
+        {
+            if (!slots_[i].value.has_value())
+            {
+                return NPOS;
+            }
+            if (slots_[i].key == key)
+            {
+                return i;
+            }
+        }
+    }
+
+    // 换成 count 个槽，重新放置全部元素
+    void rehash(size_t count)
+    {
+        std::vector<Slot> old = std::exchange(slots_, std::vector<Slot>(count));
+        for (auto &slot : old)
+        {
+            if (slot.value.has_value())
+            {
+                size_t i = home(slot.key);
+                while (slots_[i].value.has_value())
+                {
+                    i = (i + 1) & mask();
+                }
+                slots_[i].key = slot.key;
+                slots_[i].value = std::move(slot.value);
+            }
+        }
+    }
+};
+
+#endif
@@ -0,0 +1,262 @@
+#ifndef TCP_DEMUX_H
+#define TCP_DEMUX_H
+
+#include <algorithm>           // 包含 std::find 的定义
+#include <cstdint>             // 包含固定宽度整数类型的定义
+#include <functional>          // 包含 std::function 的定义
+#include <memory>              // 包含智能指针的定义
+#include <optional>            // 包含可选类型的定义
+#include <random>              // 包含随机数引擎的定义
+#include <unordered_map>       // 包含无序映射的定义
+#include <utility>             // 包含一些实用工具的定义
+#include <vector>              // 包含向量的定义
+#include "address.h"           // 包含地址的定义
+#include "connection_table.h"  // 包含以四元组为键的连接表
+#include "random.h"            // 包含随机数引擎的构造
+#include "tcp_over_ip.h"       // 包含 TCP 段与 IPv4 数据报之间的转换
+#include "tcp_peer.h"          // 包含 TCPPeer 的定义
+#include "timer_wheel.h"       // 包含时间轮的定义
+
+// 一个 TCPOverIPv4Demux 上的连接数上限。超过上限的 SYN 被丢弃，不分配连接，对方按自己的重传计时器重试
+struct DemuxLimits
+{
+    size_t max_connections = 65536;       // 连接总数
+    size_t max_half_open = 1024;          // 收到 SYN、对方还没有确认本端 SYN 的连接数
+    uint64_t half_open_timeout_ms = 3000; // 收到 SYN 后这么久对方还没有确认本端 SYN 时删除连接，不等 TCPPeer 用完
+                                          // 指数退避的重传次数，未被应答的 SYN 不会长时间占满 max_half_open
+};
+
+// TCPOverIPv4Demux 让一个适配器承载多条 TCP 连接。
+//
+// 收到的 IPv4 数据报只解析一次，按四元组在连接表（ConnectionTable，开放寻址）中找到对应的 TCPPeer，
+// 查找的代价不随连接数增长；发往监听端口、不属于任何连接的 SYN 在上限之内建立新连接。每条连接有自己的窗口扩大状态
+// 和随机的初始序列号，发出的报文段按连接的四元组封装成 IPv4 数据报，交给调用方提供的 transmit。
+// 所有连接的定时器都在同一个时间轮上，键是连接的编号：tick() 只处理定时器到期的连接，并在这时删除已经结束的连接。
+class TCPOverIPv4Demux
+{
+public:
+    using TransmitFunction = std::function<void(InternetDatagram)>;
+
+    // 构造函数，cfg 是每条新连接的 TCP 配置（初始序列号除外），limits 限制被动建立的连接数
+    explicit TCPOverIPv4Demux(const TCPConfig &cfg, DemuxLimits limits = {}) : cfg_(cfg), limits_(limits) {}
+
+    // 接受发往本地端口 port（任意本地地址）的连接
+    void listen(uint16_t port)
+    {
+        if (!is_listening(port))
+        {
+            listening_ports_.push_back(port);
+        }
+    }
+
+    // 主动建立从 local 到 remote 的连接并发出 SYN，返回连接的四元组；连接已存在时不做任何事
+    FourTuple connect(const Address &local, const Address &remote, const TransmitFunction &transmit)
+    {
+        const FourTuple tuple{.local_ip = local.ipv4_numeric(),
+                              .remote_ip = remote.ipv4_numeric(),
+                              .local_port = local.port(),
+                              .remote_port = remote.port()};
+        if (connections_.find(tuple) == nullptr)
+        {
+            Connection &c = add_connection(tuple);
+            c.peer.push(wrap(c, transmit));
+        }
+        return tuple;
+    }
+
+    // 处理收到的数据报，返回它所属连接的四元组；不是有效的 TCP 段、或不属于任何连接时返回空
+    std::optional<FourTuple> receive(const InternetDatagram &ip_dgram, const TransmitFunction &transmit)
+    {
+        std::optional<TCPSegment> seg = TCPOverIPv4Adapter::parse_segment(ip_dgram);
+        if (!seg.has_value())
+        {
+            return {};
+        }
+
+        const FourTuple tuple{.local_ip = ip_dgram.header.dst,
+                              .remote_ip = ip_dgram.header.src,
+                              .local_port = seg->udinfo.dst_port,
+                              .remote_port = seg->udinfo.src_port};
+        auto *connection = connections_.find(tuple);
+        if (connection == nullptr)
+        {
+            // 只有发往监听端口的 SYN 才建立新连接，超过上限时丢弃
+            const TCPSenderMessage &sender = seg->message.sender;
+            if (!sender.SYN || sender.RST || seg->message.receiver.ackno.has_value() || !is_listening(tuple.local_port)
+                || connections_.size() >= limits_.max_connections || half_open_ >= limits_.max_half_open)
+            {
+                return {};
+            }
+            Connection &c = add_connection(tuple);
+            c.half_open = true;
+            c.half_open_timer = timers_.arm(timers_.now_ms() + limits_.half_open_timeout_ms, c.key);
+            ++half_open_;
+            connection = connections_.find(tuple);
+        }
+
+        Connection &c = **connection;
+        c.scaling.on_receive(seg->message);
+        c.peer.receive(std::move(seg->message), wrap(c, transmit));
+        if (c.half_open && c.peer.sender().syn_acked())
+        {
+            c.half_open = false;
+            timers_.cancel(c.half_open_timer);
+            --half_open_;
+        }
+        return tuple;
+    }
+
+    // 时间前进 ms 毫秒：只 tick 定时器到期的连接，删除其中已经结束、收到的数据也已被应用读完的连接，
+    // 重传次数超过 TCPConfig::MAX_RETX_ATTEMPTS 的连接，以及超过 DemuxLimits::half_open_timeout_ms 的半开连接
+    void tick(uint64_t ms, const TransmitFunction &transmit)
+    {
+        expired_ = timers_.advance(ms);
+        std::sort(expired_.begin(), expired_.end());
+        expired_.erase(std::unique(expired_.begin(), expired_.end()), expired_.end());
+        for (const uint64_t key : expired_)
+        {
+            // 删除连接时取消了它的定时器，到期的键都对应现存的连接
+            Connection &c = **connections_.find(tuples_.at(key));
+            if (c.half_open && timers_.has_expired(c.half_open_timer))
+            {
+                erase(c);
+                continue;
+            }
+            c.peer.tick(ms, wrap(c, transmit));
+            if (c.peer.sender().consecutive_retransmissions() > TCPConfig::MAX_RETX_ATTEMPTS)
+            {
+                erase(c);
+            }
+            else if (!c.peer.active())
+            {
+                if (c.peer.inbound_reader().bytes_buffered() == 0)
+                {
+                    erase(c);
+                }
+                else if (!c.unread)
+                {
+                    c.unread = true;
+                    unread_.push_back(c.key);
+                }
+            }
+        }
+    }
+
+    // 应用向连接写入数据或读走数据后调用，发出窗口允许的报文段和窗口更新
+    void push(const FourTuple &tuple, const TransmitFunction &transmit)
+    {
+        if (auto *connection = connections_.find(tuple))
+        {
+            (*connection)->peer.push(wrap(**connection, transmit));
+        }
+    }
+
+    // 查找四元组对应的连接，不存在时返回 nullptr；指针在连接被 tick() 或 reap() 删除之前有效
+    TCPPeer *find(const FourTuple &tuple)
+    {
+        auto *connection = connections_.find(tuple);
+        return connection == nullptr ? nullptr : &(*connection)->peer;
+    }
+
+    // 删除 tick() 发现已经结束、但当时还有数据没被应用读走的连接中现在已读完的，返回删除的个数；
+    // 只检查这些连接，不遍历连接表
+    size_t reap()
+    {
+        size_t reaped = 0;
+        std::vector<uint64_t> still_unread;
+        for (const uint64_t key : unread_)
+        {
+            // 编号不复用，找不到说明连接已经因为别的原因被删除
+            const auto tuple = tuples_.find(key);
+            if (tuple == tuples_.end())
+            {
+                continue;
+            }
+            Connection &c = **connections_.find(tuple->second);
+            if (c.peer.inbound_reader().bytes_buffered() == 0)
+            {
+                erase(c);
+                ++reaped;
+            }
+            else
+            {
+                still_unread.push_back(key);
+            }
+        }
+        unread_ = std::move(still_unread);
+        return reaped;
+    }
+
+    // 连接数
+    size_t size() const { return connections_.size(); }
+
+    // 被动建立、对方还没有确认本端 SYN 的连接数
+    size_t half_open() const { return half_open_; }
+
+private:
+    // 一条连接：TCPPeer 和它在线路上的窗口扩大状态
+    struct Connection
+    {
+        Connection(const FourTuple &t, uint64_t k, const TCPConfig &cfg, TimerWheel &wheel) : tuple(t), key(k), peer(cfg, wheel, k) {}
+
+        FourTuple tuple;                       // 连接的四元组
+        uint64_t key;                          // 连接的编号，也是它的定时器在时间轮上的键
+        TCPPeer peer;                          // 本端的 TCP 状态机
+        WindowScaling scaling{};               // 线路上的窗口字段与实际窗口之间的换算
+        bool half_open{};                      // 被动建立、对方还没有确认本端的 SYN
+        TimerWheel::TimerId half_open_timer{}; // 半开连接的期限，对方确认 SYN 时取消
+        bool unread{};                         // 已经结束，编号在 unread_ 中等待应用读完数据
+    };
+
+    TCPConfig cfg_;                                              // 新连接的 TCP 配置
+    DemuxLimits limits_;                                         // 被动建立的连接数上限
+    ConnectionTable<std::unique_ptr<Connection>> connections_{}; // 连接表，TCPPeer 较大，单独分配以保持地址不变
+    std::vector<uint16_t> listening_ports_{};                    // 接受新连接的本地端口
+    std::default_random_engine rng_{get_random_engine()};        // 生成初始序列号
+    size_t half_open_{};                                         // 被动建立、对方还没有确认本端 SYN 的连接数
+
+    TimerWheel timers_{};                               // 所有连接的定时器，键是连接的编号
+    uint64_t next_key_{};                               // 下一条连接的编号，编号不复用
+    std::unordered_map<uint64_t, FourTuple> tuples_{};  // 连接的编号到四元组
+    std::vector<uint64_t> expired_{};                   // tick() 中定时器到期的连接
+    std::vector<uint64_t> unread_{};                    // 已经结束、还有数据没被应用读走的连接的编号
+
+    // 端口是否在监听
+    bool is_listening(uint16_t port) const
+    {
+        return std::find(listening_ports_.begin(), listening_ports_.end(), port) != listening_ports_.end();
+    }
+
+    // 加入一条新连接，使用 cfg_、随机的初始序列号和共享的时间轮；调用者保证四元组不存在
+    Connection &add_connection(const FourTuple &tuple)
+    {
+        TCPConfig cfg = cfg_;
+        cfg.isn = Wrap32{static_cast<uint32_t>(rng_())};
+        const uint64_t key = next_key_++;
+        tuples_.emplace(key, tuple);
+        return **connections_.emplace(tuple, std::make_unique<Connection>(tuple, key, cfg, timers_)).first;
+    }
+
+    // 删除连接并取消它在时间轮上的定时器；它在 unread_ 中的编号由 reap() 跳过，不必查找
+    void erase(Connection &c)
+    {
+        const FourTuple tuple = c.tuple;
+        half_open_ -= c.half_open;
+        timers_.cancel(c.half_open_timer);
+        c.peer.cancel_timers();
+        tuples_.erase(c.key);
+        connections_.erase(tuple);
+    }
+
+    // 连接发出的 TCPMessage 缩放窗口后按四元组封装，再交给 transmit
+    static TCPPeer::TransmitFunction wrap(Connection &c, const TransmitFunction &transmit)
+    {
+        return [&c, &transmit](TCPMessage msg)
+        {
+            c.scaling.on_send(msg);
+            transmit(TCPOverIPv4Adapter::make_datagram(c.tuple, std::move(msg)));
+        };
+    }
+};
+
+#endif
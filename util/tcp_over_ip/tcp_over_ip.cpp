@@ -22,18 +22,13 @@ std::optional<TCPMessage> TCPOverIPv4Adapter::unwrap_tcp_in_ip(const InternetDat
         return {}; // 如果不在监听状态且源地址不匹配，返回空
     }
 
-    // 检查 IPv4 数据报的协议是否为 TCP
-    if (ip_dgram.header.proto != IPv4Header::PROTO_TCP)
+    // 检查协议是否为 TCP，并尝试解析 TCP 段
+    std::optional<TCPSegment> parsed = parse_segment(ip_dgram);
+    if (!parsed.has_value())
     {
-        return {}; // 如果不是 TCP 协议，返回空
-    }
-
-    // 尝试解析 TCP 段
-    TCPSegment tcp_seg;
-    if (!parse(tcp_seg, ip_dgram.payload, ip_dgram.header.pseudo_checksum()))
-    {
-        return {}; // 如果解析失败，返回空
+        return {}; // 如果不是 TCP 协议或解析失败，返回空
     }
+    TCPSegment &tcp_seg = *parsed;
 
     // 检查 TCP 段的目标端口是否匹配
     if (tcp_seg.udinfo.dst_port != config().source.port())
@@ -63,21 +58,51 @@ std::optional<TCPMessage> TCPOverIPv4Adapter::unwrap_tcp_in_ip(const InternetDat
         return {}; // 如果源端口不匹配，返回空
     }
 
-    return tcp_seg.message; // 返回有效的 TCP 消息
+    window_scaling_.on_receive(tcp_seg.message); // 还原实际窗口
+    return std::move(tcp_seg.message);           // 返回有效的 TCP 消息
 }
 
 InternetDatagram TCPOverIPv4Adapter::wrap_tcp_in_ip(const TCPMessage &msg)
 {
-    TCPSegment seg{.message = msg}; // 创建 TCP 段并设置消息
+    TCPMessage scaled = msg;
+    window_scaling_.on_send(scaled); // 缩放到线路上的窗口字段
+
+    const FourTuple tuple{.local_ip = config().source.ipv4_numeric(),
+                          .remote_ip = config().destination.ipv4_numeric(),
+                          .local_port = config().source.port(),
+                          .remote_port = config().destination.port()};
+    return make_datagram(tuple, std::move(scaled));
+}
+
+std::optional<TCPSegment> TCPOverIPv4Adapter::parse_segment(const InternetDatagram &ip_dgram)
+{
+    // 检查 IPv4 数据报的协议是否为 TCP
+    if (ip_dgram.header.proto != IPv4Header::PROTO_TCP)
+    {
+        return {}; // 如果不是 TCP 协议，返回空
+    }
+
+    // 尝试解析 TCP 段
+    TCPSegment tcp_seg;
+    if (!parse(tcp_seg, ip_dgram.payload, ip_dgram.header.pseudo_checksum()))
+    {
+        return {}; // 如果解析失败，返回空
+    }
+    return tcp_seg;
+}
+
+InternetDatagram TCPOverIPv4Adapter::make_datagram(const FourTuple &tuple, TCPMessage msg)
+{
+    TCPSegment seg{.message = std::move(msg)}; // 创建 TCP 段并设置消息
     // 设置 TCP 段的源和目标端口
-    seg.udinfo.src_port = config().source.port();
-    seg.udinfo.dst_port = config().destination.port();
+    seg.udinfo.src_port = tuple.local_port;
+    seg.udinfo.dst_port = tuple.remote_port;
 
     // 创建一个 IPv4 数据报并设置其地址和长度
     InternetDatagram ip_dgram;
-    ip_dgram.header.src = config().source.ipv4_numeric();                                                         // 设置源地址
-    ip_dgram.header.dst = config().destination.ipv4_numeric();                                                    // 设置目标地址
-    ip_dgram.header.len = ip_dgram.header.hlen * 4 + 20 /* tcp header len */ + seg.message.sender.payload.size(); // 计算数据报长度
+    ip_dgram.header.src = tuple.local_ip;                                                                      // 设置源地址
+    ip_dgram.header.dst = tuple.remote_ip;                                                                     // 设置目标地址
+    ip_dgram.header.len = ip_dgram.header.hlen * 4 + seg.header_length() + seg.message.sender.payload.size(); // 计算数据报长度
 
     // 设置有效载荷，计算 TCP 校验和
     seg.compute_checksum(ip_dgram.header.pseudo_checksum()); // 计算 TCP 校验和
@@ -86,3 +111,29 @@ InternetDatagram TCPOverIPv4Adapter::wrap_tcp_in_ip(const TCPMessage &msg)
 
     return ip_dgram; // 返回封装后的 IPv4 数据报
 }
+
+void WindowScaling::on_send(TCPMessage &msg)
+{
+    // SYN 中的窗口不缩放；之后的窗口按本端声明的移位数缩放到 16 位字段
+    if (msg.sender.SYN)
+    {
+        local_window_scale_ = msg.sender.window_scale;
+    }
+    else if (enabled())
+    {
+        msg.receiver.window_size >>= *local_window_scale_;
+    }
+}
+
+void WindowScaling::on_receive(TCPMessage &msg)
+{
+    // SYN 中的窗口不缩放；之后的窗口按对方声明的移位数还原为实际字节数
+    if (msg.sender.SYN)
+    {
+        peer_window_scale_ = msg.sender.window_scale;
+    }
+    else if (enabled())
+    {
+        msg.receiver.window_size <<= *peer_window_scale_;
+    }
+}
@@ -1,12 +1,33 @@
 #ifndef TCP_OVER_IP_H
 #define TCP_OVER_IP_H
 
-#include <optional>         // 包含 std::optional 的定义
-#include "fd_adapter.h"     // 包含文件描述符适配器的基类定义
-#include "ipv4_datagram.h"  // 包含 IPv4 数据报的定义
-#include "tcp_segment.h"    // 包含 TCP 段的定义
+#include <optional>            // 包含 std::optional 的定义
+#include "connection_table.h"  // 包含四元组的定义
+#include "fd_adapter.h"        // 包含文件描述符适配器的基类定义
+#include "ipv4_datagram.h"     // 包含 IPv4 数据报的定义
+#include "tcp_segment.h"       // 包含 TCP 段的定义
 
-// TCPOverIPv4Adapter 类用于将 TCP 段转换为序列化的 IPv4 数据报
+// 一条连接的窗口扩大状态。TCPMessage 中的窗口是实际字节数；双方的 SYN 都带有窗口扩大选项（RFC 7323）后，
+// 线路上的 16 位窗口字段与实际窗口之间按各自声明的移位数换算。
+class WindowScaling
+{
+public:
+    // 发出报文段之前：记录本端 SYN 中声明的移位数，或把窗口缩放到线路上的字段
+    void on_send(TCPMessage &msg);
+
+    // 收到报文段之后：记录对方 SYN 中声明的移位数，或把线路上的字段还原为实际窗口
+    void on_receive(TCPMessage &msg);
+
+private:
+    std::optional<uint8_t> local_window_scale_{}; // 本端 SYN 中声明的移位数
+    std::optional<uint8_t> peer_window_scale_{};  // 对方 SYN 中声明的移位数
+
+    // 双方都声明了窗口扩大选项
+    bool enabled() const { return local_window_scale_.has_value() && peer_window_scale_.has_value(); }
+};
+
+// TCPOverIPv4Adapter 类用于将 TCP 段转换为序列化的 IPv4 数据报，只承载 config() 中的一条连接；
+// 多条连接共用一个适配器时见 TCPOverIPv4Demux。
 class TCPOverIPv4Adapter : public FdAdapterBase
 {
 public:
@@ -15,6 +36,15 @@ public:
 
     // 将 TCP 消息封装到 IPv4 数据报中
     InternetDatagram wrap_tcp_in_ip(const TCPMessage &msg);
+
+    // 解析 IPv4 数据报中的 TCP 段，不检查地址和端口；不是 TCP 或校验和错误时返回空
+    static std::optional<TCPSegment> parse_segment(const InternetDatagram &ip_dgram);
+
+    // 按四元组把 TCP 消息封装到 IPv4 数据报中，窗口应已换算为线路上的字段
+    static InternetDatagram make_datagram(const FourTuple &tuple, TCPMessage msg);
+
+private:
+    WindowScaling window_scaling_{}; // config() 中这条连接的窗口扩大状态
 };
 
 #endif
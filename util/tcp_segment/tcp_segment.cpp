@@ -1,9 +1,119 @@
+#include <algorithm>            // 包含 std::min 的定义
 #include <cstddef>              // 包含 size_t 的定义
+#include <string>               // 包含字符串类的定义
+#include <string_view>          // 包含字符串视图的定义
 #include "tcp_segment.h"        // 包含 TCPSegment 类的定义
 #include "checksum.h"           // 包含校验和计算的定义
 #include "wrapping_integers.h"  // 包含包装整数的定义
 
 static constexpr uint32_t TCPHeaderMinLen = 5; // TCP 头部的最小长度（以 32 位字为单位）
+static constexpr size_t TCPOptionsMaxLen = 40; // 选项区的最大长度（字节）
+
+// TCP 选项类型
+static constexpr uint8_t TCPOptionEnd = 0;           // 选项列表结束
+static constexpr uint8_t TCPOptionNop = 1;           // 填充，用于对齐
+static constexpr uint8_t TCPOptionMss = 2;           // 最大报文段长度，只出现在 SYN 上
+static constexpr uint8_t TCPOptionWindowScale = 3;   // 窗口扩大，只出现在 SYN 上（RFC 7323）
+static constexpr uint8_t TCPOptionSackPermitted = 4; // SACK 许可，只出现在 SYN 上（RFC 2018）
+static constexpr uint8_t TCPOptionSack = 5;          // SACK 块列表，每块 8 字节
+static constexpr uint8_t TCPMaxWindowScale = 14;     // 窗口扩大的最大移位数
+
+// Wrap32Serializable 类用于序列化 Wrap32 类型
+class Wrap32Serializable : public Wrap32
+{
+public:
+    uint32_t raw_value() const { return raw_value_; } // 返回原始值
+};
+
+// 从选项数据中读取大端序的 32 位整数
+static uint32_t read_u32(std::string_view data)
+{
+    uint32_t value = 0;
+    for (size_t i = 0; i < 4; ++i)
+    {
+        value = value << 8 | static_cast<uint8_t>(data[i]);
+    }
+    return value;
+}
+
+// 解析选项区，不认识的选项按长度跳过，格式错误时忽略其余选项
+static void parse_options(std::string_view options, TCPMessage &message)
+{
+    while (!options.empty() && options.front() != TCPOptionEnd)
+    {
+        const auto kind = static_cast<uint8_t>(options.front());
+        if (kind == TCPOptionNop)
+        {
+            options.remove_prefix(1);
+            continue;
+        }
+        const size_t len = options.size() >= 2 ? static_cast<uint8_t>(options[1]) : 0;
+        if (len < 2 || len > options.size())
+        {
+            return;
+        }
+        const auto body = options.substr(2, len - 2);
+        if (kind == TCPOptionMss && body.size() == 2)
+        {
+            message.sender.mss = static_cast<uint16_t>(static_cast<uint8_t>(body[0]) << 8 | static_cast<uint8_t>(body[1]));
+        }
+        else if (kind == TCPOptionSackPermitted && body.empty())
+        {
+            message.sender.sack_permitted = true;
+        }
+        else if (kind == TCPOptionWindowScale && body.size() == 1)
+        {
+            // 超过 14 的移位数按 14 处理（RFC 7323 2.3）
+            message.sender.window_scale = std::min(static_cast<uint8_t>(body.front()), TCPMaxWindowScale);
+        }
+        else if (kind == TCPOptionSack && !body.empty() && body.size() % 8 == 0)
+        {
+            for (size_t i = 0; i < body.size(); i += 8)
+            {
+                message.receiver.sack_blocks.push_back({Wrap32{read_u32(body.substr(i))}, Wrap32{read_u32(body.substr(i + 4))}});
+            }
+        }
+        options.remove_prefix(len);
+    }
+}
+
+// 生成选项区，用 NOP 填充使每个选项 4 字节对齐；SACK 块的数量受剩余空间限制
+static std::string serialize_options(const TCPMessage &message)
+{
+    std::string options;
+    const auto put_u32 = [&](uint32_t value)
+    {
+        for (int shift = 24; shift >= 0; shift -= 8)
+        {
+            options.push_back(static_cast<char>(value >> shift));
+        }
+    };
+
+    if (message.sender.SYN && message.sender.mss.has_value())
+    {
+        options += {TCPOptionMss, 4, static_cast<char>(*message.sender.mss >> 8), static_cast<char>(*message.sender.mss)};
+    }
+    if (message.sender.SYN && message.sender.sack_permitted)
+    {
+        options += {TCPOptionNop, TCPOptionNop, TCPOptionSackPermitted, 2};
+    }
+    if (message.sender.SYN && message.sender.window_scale.has_value())
+    {
+        options += {TCPOptionNop, TCPOptionWindowScale, 3, static_cast<char>(*message.sender.window_scale)};
+    }
+
+    const size_t blocks = std::min(message.receiver.sack_blocks.size(), (TCPOptionsMaxLen - options.size() - 4) / 8);
+    if (message.receiver.ackno.has_value() && blocks > 0)
+    {
+        options += {TCPOptionNop, TCPOptionNop, TCPOptionSack, static_cast<char>(2 + 8 * blocks)};
+        for (size_t i = 0; i < blocks; ++i)
+        {
+            put_u32(Wrap32Serializable{message.receiver.sack_blocks[i].begin}.raw_value());
+            put_u32(Wrap32Serializable{message.receiver.sack_blocks[i].end}.raw_value());
+        }
+    }
+    return options;
+}
 
 // 解析 TCP 段的函数
 void TCPSegment::parse(Parser &parser, uint32_t datagram_layer_pseudo_checksum)
@@ -49,29 +159,30 @@ void TCPSegment::parse(Parser &parser, uint32_t datagram_layer_pseudo_checksum)
     message.sender.SYN = octet & 0b0000'0010;                        // SYN 标志
     message.sender.FIN = octet & 0b0000'0001;                        // FIN 标志
 
-    // 解析窗口大小
-    parser.integer(message.receiver.window_size);
+    // 解析窗口大小（线路上的 16 位值，由适配器按协商的移位数还原）
+    parser.integer(raw16);
+    message.receiver.window_size = raw16;
     parser.integer(udinfo.cksum); // 解析校验和
     parser.integer(raw16);        // 解析紧急指针（未使用）
 
-    // 跳过 TCP 头部中的选项或额外内容
+    // 解析 TCP 头部中的选项
     if (data_offset < TCPHeaderMinLen)
     {                       // 如果数据偏移小于最小长度
         parser.set_error(); // 设置解析器错误状态
+        return;
     }
-    parser.remove_prefix(data_offset * 4 - TCPHeaderMinLen * 4); // 移除多余的前缀
+    std::string options(data_offset * 4 - TCPHeaderMinLen * 4, 0); // 选项区的原始字节
+    parser.string(options);
+    if (parser.has_error())
+    {
+        return;
+    }
+    parse_options(options, message);
 
     // 解析剩余的有效载荷
     parser.all_remaining(message.sender.payload);
 }
 
-// Wrap32Serializable 类用于序列化 Wrap32 类型
-class Wrap32Serializable : public Wrap32
-{
-public:
-    uint32_t raw_value() const { return raw_value_; } // 返回原始值
-};
-
 // 序列化 TCP 段的函数
 void TCPSegment::serialize(Serializer &serializer) const
 {
@@ -85,8 +196,9 @@ void TCPSegment::serialize(Serializer &serializer) const
     // 序列化确认号，若无确认号则使用默认值 0
     serializer.integer(Wrap32Serializable{message.receiver.ackno.value_or(Wrap32{0})}.raw_value());
 
-    // 序列化数据偏移（以 32 位字为单位）
-    serializer.integer(uint8_t{TCPHeaderMinLen << 4}); // 数据偏移
+    // 序列化数据偏移（以 32 位字为单位），包括选项区
+    const std::string options = serialize_options(message);
+    serializer.integer(static_cast<uint8_t>((TCPHeaderMinLen + options.size() / 4) << 4)); // 数据偏移
 
     // 计算标志位
     const bool reset = message.sender.RST || message.receiver.RST;                  // 检查 RST 标志
@@ -96,15 +208,27 @@ void TCPSegment::serialize(Serializer &serializer) const
                           (message.sender.FIN ? 0b0000'0001U : 0);                  // FIN 标志
     serializer.integer(flags);                                                      // 序列化标志位
 
-    // 序列化窗口大小
-    serializer.integer(message.receiver.window_size);
+    // 序列化窗口大小（适配器已按协商的移位数缩放，这里只截断到 16 位字段）
+    serializer.integer(static_cast<uint16_t>(std::min<uint32_t>(message.receiver.window_size, UINT16_MAX)));
     serializer.integer(udinfo.cksum); // 序列化校验和
     serializer.integer(uint16_t{0});  // 紧急指针（未使用）
 
+    // 序列化选项
+    for (const char c : options)
+    {
+        serializer.integer(static_cast<uint8_t>(c));
+    }
+
     // 序列化发送者的有效载荷
     serializer.buffer(message.sender.payload);
 }
 
+// 计算 TCP 首部（含选项）的长度
+size_t TCPSegment::header_length() const
+{
+    return TCPHeaderMinLen * 4 + serialize_options(message).size();
+}
+
 // 计算 TCP 段的校验和
 void TCPSegment::compute_checksum(uint32_t datagram_layer_pseudo_checksum)
 {
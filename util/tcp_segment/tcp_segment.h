@@ -25,6 +25,9 @@ struct TCPSegment
     // 序列化 TCP 段的函数，将其转换为可传输的格式
     void serialize(Serializer &serializer) const;
 
+    // TCP 首部（含选项）的字节数
+    size_t header_length() const;
+
     // 计算 TCP 段的校验和，使用给定的伪校验和
     void compute_checksum(uint32_t datagram_layer_pseudo_checksum);
 };
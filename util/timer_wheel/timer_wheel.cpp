@@ -0,0 +1,162 @@
+#include "timer_wheel.h"
+
+#include <algorithm>
+#include <bit>
+
+TimerWheel::TimerId TimerWheel::arm(uint64_t deadline_ms, uint64_t key)
+{
+    uint32_t index = 0;
+    if (free_.empty())
+    {
+        index = static_cast<uint32_t>(nodes_.size());
+        nodes_.emplace_back();
+    }
+    else
+    {
+        index = free_.back();
+        free_.pop_back();
+    }
+    Node &node = nodes_[index];
+    node.deadline_ms = deadline_ms;
+    node.key = key;
+    place(index, now_ms_ + 1);
+    ++size_;
+    return {index, node.generation};
+}
+
+bool TimerWheel::cancel(TimerId &id)
+{
+    const bool armed = is_armed(id);
+    if (armed)
+    {
+        unlink(id.index);
+        release(id.index);
+    }
+    id = {};
+    return armed;
+}
+
+bool TimerWheel::is_armed(TimerId id) const
+{
+    return id.index < nodes_.size() && nodes_[id.index].generation == id.generation && nodes_[id.index].list != NIL;
+}
+
+const std::vector<uint64_t> &TimerWheel::advance(uint64_t ms)
+{
+    expired_.clear();
+    const uint64_t target = now_ms_ + ms;
+    for (uint64_t next = next_event_ms(); next <= target; next = next_event_ms())
+    {
+        now_ms_ = next;
+        process_current();
+    }
+    now_ms_ = target;
+    return expired_;
+}
+
+uint64_t TimerWheel::next_event_ms() const
+{
+    uint64_t next = UINT64_MAX;
+    for (unsigned level = 0; level < LEVELS; ++level)
+    {
+        if (occupied_[level] == 0)
+        {
+            continue;
+        }
+        // 第 l 层的槽只在更低各层的下标都为 0 的时刻处理：从此后第一个这样的时刻起，找本圈剩余部分中的非空槽，
+        // 没有就是下一圈的第一个非空槽
+        const unsigned shift = SLOT_BITS * level;
+        const uint64_t first = (now_ms_ + (uint64_t{1} << shift)) >> shift;
+        const uint64_t pending = occupied_[level] & (~uint64_t{0} << (first & SLOT_MASK));
+        const uint64_t round = first & ~SLOT_MASK;
+        const uint64_t slot = pending != 0 ? round + static_cast<uint64_t>(std::countr_zero(pending))
+                                           : round + SLOTS + static_cast<uint64_t>(std::countr_zero(occupied_[level]));
+        next = std::min(next, slot << shift);
+    }
+    return next;
+}
+
+void TimerWheel::process_current()
+{
+    // 第 l 层的槽在低一层转完一圈时重新分配；这一层的下标不为 0 时更高层还没有转到
+    if ((now_ms_ & SLOT_MASK) == 0)
+    {
+        for (unsigned level = 1; level < LEVELS; ++level)
+        {
+            const uint64_t slot = (now_ms_ >> (SLOT_BITS * level)) & SLOT_MASK;
+            for (uint32_t index = detach(static_cast<uint32_t>(level * SLOTS + slot)); index != NIL;)
+            {
+                const uint32_t next = nodes_[index].next;
+                place(index, now_ms_);
+                index = next;
+            }
+            if (slot != 0)
+            {
+                break;
+            }
+        }
+    }
+
+    for (uint32_t index = detach(static_cast<uint32_t>(now_ms_ & SLOT_MASK)); index != NIL;)
+    {
+        const uint32_t next = nodes_[index].next;
+        expired_.push_back(nodes_[index].key);
+        release(index);
+        index = next;
+    }
+}
+
+void TimerWheel::place(uint32_t index, uint64_t base)
+{
+    // 已经过期的定时器放进下一个要处理的槽；太远的先按最远能容纳的时间放置
+    const uint64_t expires = base + std::min(std::max(nodes_[index].deadline_ms, base) - base, MAX_SPAN);
+    const uint64_t distance = expires - base;
+    unsigned level = 0;
+    while (level + 1 < LEVELS && distance >= (uint64_t{1} << (SLOT_BITS * (level + 1))))
+    {
+        ++level;
+    }
+    const uint64_t slot = (expires >> (SLOT_BITS * level)) & SLOT_MASK;
+    link(static_cast<uint32_t>(level * SLOTS + slot), index);
+}
+
+void TimerWheel::link(uint32_t list, uint32_t index)
+{
+    Node &node = nodes_[index];
+    List &slot = lists_[list];
+    node.list = list;
+    node.prev = slot.tail;
+    node.next = NIL;
+    (slot.tail == NIL ? slot.head : nodes_[slot.tail].next) = index;
+    slot.tail = index;
+    occupied_[list / SLOTS] |= uint64_t{1} << (list % SLOTS);
+}
+
+void TimerWheel::unlink(uint32_t index)
+{
+    Node &node = nodes_[index];
+    List &slot = lists_[node.list];
+    (node.prev == NIL ? slot.head : nodes_[node.prev].next) = node.next;
+    (node.next == NIL ? slot.tail : nodes_[node.next].prev) = node.prev;
+    if (slot.head == NIL)
+    {
+        occupied_[node.list / SLOTS] &= ~(uint64_t{1} << (node.list % SLOTS));
+    }
+}
+
+void TimerWheel::release(uint32_t index)
+{
+    Node &node = nodes_[index];
+    node.list = NIL;
+    ++node.generation;
+    free_.push_back(index);
+    --size_;
+}
+
+uint32_t TimerWheel::detach(uint32_t list)
+{
+    const uint32_t head = lists_[list].head;
+    lists_[list] = {};
+    occupied_[list / SLOTS] &= ~(uint64_t{1} << (list % SLOTS));
+    return head;
+}
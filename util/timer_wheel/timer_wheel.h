@@ -0,0 +1,135 @@
+#ifndef TIMER_WHEEL_H
+#define TIMER_WHEEL_H
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+// TimerWheel 是分层时间轮（Varghese & Lauck），以毫秒为单位管理大量定时器。
+//
+// 共 LEVELS 层，每层 SLOTS 个槽：第 0 层每个槽是 1 毫秒，第 l 层每个槽覆盖 SLOTS^l 毫秒。
+// 定时器按到期时间与当前时间的距离放进能容纳它的最低一层；低一层转完一圈时，把高一层对应槽里的
+// 定时器重新分配到更低的层。设置、取消都是 O(1)，每个定时器到期前最多被搬动 LEVELS - 1 次；
+// 推进时间时借助每层的占用位图直接跳到下一个非空槽，时间流逝本身几乎不花代价。
+//
+// 定时器只带一个 64 位的键，不带回调：advance() 按到期顺序返回到期定时器的键，由调用方分派。
+// 同时驱动很多连接的上层（TCPOverIPv4Demux）只用一个时间轮，用键区分连接，见下面的 WheelRef。
+class TimerWheel
+{
+public:
+    // 定时器句柄：定时器到期或被取消后失效，节点被复用后旧句柄也不会指向新的定时器
+    struct TimerId
+    {
+        uint32_t index{UINT32_MAX};
+        uint32_t generation{};
+    };
+
+    // 当前时间（毫秒），从 0 开始，由 advance() 推进
+    uint64_t now_ms() const { return now_ms_; }
+    // 尚未到期的定时器数
+    size_t size() const { return size_; }
+
+    // 设置一个在 deadline_ms 到期的定时器；deadline_ms 不晚于当前时间时在下一毫秒到期
+    TimerId arm(uint64_t deadline_ms, uint64_t key = 0);
+    // 取消定时器并清空句柄，返回它是否仍在等待到期
+    bool cancel(TimerId &id);
+    // 定时器是否仍在等待到期
+    bool is_armed(TimerId id) const;
+    // 定时器是否已经到期：句柄有效（没有被 cancel() 清空）但已不在等待到期。
+    // 不需要分派键的使用者可以在 advance() 之后用它检查自己的定时器
+    bool has_expired(TimerId id) const { return id.index != NIL && !is_armed(id); }
+
+    // 时间前进 ms 毫秒，返回这段时间内到期的定时器的键（按到期时间排序），在下一次 advance() 之前有效
+    const std::vector<uint64_t> &advance(uint64_t ms);
+
+private:
+    static constexpr unsigned SLOT_BITS = 6;
+    static constexpr uint64_t SLOTS = uint64_t{1} << SLOT_BITS;
+    static constexpr uint64_t SLOT_MASK = SLOTS - 1;
+    static constexpr unsigned LEVELS = 5;                                          // 可直接容纳约 12 天内的到期时间
+    static constexpr uint64_t MAX_SPAN = (uint64_t{1} << (SLOT_BITS * LEVELS)) - 1; // 更远的定时器先放在最高层，转到时再重新分配
+    static constexpr uint32_t NIL = UINT32_MAX;
+
+    struct Node
+    {
+        uint64_t deadline_ms{};
+        uint64_t key{};
+        uint32_t prev{NIL};
+        uint32_t next{NIL};
+        uint32_t list{NIL}; // 所在的槽，NIL 表示空闲
+        uint32_t generation{};
+    };
+    struct List
+    {
+        uint32_t head{NIL};
+        uint32_t tail{NIL};
+    };
+
+    // 按到期时间把节点放进合适的槽，base 是下一个要处理的时刻
+    void place(uint32_t index, uint64_t base);
+    void link(uint32_t list, uint32_t index);
+    void unlink(uint32_t index);
+    void release(uint32_t index);
+    // 摘下一个槽里的全部节点，返回链表头
+    uint32_t detach(uint32_t list);
+    // 此后第一个需要处理的时刻：有定时器到期，或有高层的槽需要重新分配；没有定时器时为 UINT64_MAX
+    uint64_t next_event_ms() const;
+    // 处理时刻 now_ms_：低层转完一圈时从高层重新分配定时器，再让第 0 层当前槽里的定时器到期
+    void process_current();
+
+    std::vector<Node> nodes_{};
+    std::vector<uint32_t> free_{};                    // 空闲节点
+    std::array<List, LEVELS * SLOTS> lists_{};        // 各层的槽
+    std::array<uint64_t, LEVELS> occupied_{};         // 各层非空槽的位图
+    uint64_t now_ms_{};
+    size_t size_{};
+    std::vector<uint64_t> expired_{};
+};
+
+// WheelRef 是 TCPSender、TCPPeer 使用时间轮的方式。单独使用时自己拥有一个时间轮，由组件的 tick() 推进；
+// 上层同时驱动很多连接时注入共享的时间轮和这条连接的键：组件设置的定时器都带上这个键，时间由上层推进，
+// 上层只 tick advance() 返回的键所对应的连接，不再每个 tick 遍历所有连接。
+// 自有的时间轮单独分配，组件移动时不必搬动它，同一连接的其他组件也可以通过 wheel() 共享它。
+class WheelRef
+{
+public:
+    // 自己拥有一个时间轮
+    WheelRef() : owned_(std::make_unique<TimerWheel>()), wheel_(owned_.get()) {}
+    // 使用上层的时间轮，定时器的键为 key
+    WheelRef(TimerWheel &shared, uint64_t key) : wheel_(&shared), key_(key) {}
+
+    // 复制会让两个组件在同一个自有时间轮上设置定时器，只允许移动
+    WheelRef(const WheelRef &) = delete;
+    WheelRef &operator=(const WheelRef &) = delete;
+    WheelRef(WheelRef &&) = default;
+    WheelRef &operator=(WheelRef &&) = default;
+    ~WheelRef() = default;
+
+    // 使用的时间轮和定时器的键，用于让同一连接的其他组件共享
+    TimerWheel &wheel() const { return *wheel_; }
+    uint64_t key() const { return key_; }
+
+    uint64_t now_ms() const { return wheel_->now_ms(); }
+    TimerWheel::TimerId arm(uint64_t deadline_ms) { return wheel_->arm(deadline_ms, key_); }
+    bool cancel(TimerWheel::TimerId &id) { return wheel_->cancel(id); }
+    bool is_armed(TimerWheel::TimerId id) const { return wheel_->is_armed(id); }
+    bool has_expired(TimerWheel::TimerId id) const { return wheel_->has_expired(id); }
+
+    // 自有的时间轮前进 ms 毫秒；共享的时间轮由上层推进，这里不做任何事
+    void advance(uint64_t ms)
+    {
+        if (owned_)
+        {
+            owned_->advance(ms);
+        }
+    }
+
+private:
+    std::unique_ptr<TimerWheel> owned_{}; // 自有的时间轮，使用共享的时间轮时为空
+    TimerWheel *wheel_;                   // 使用的时间轮
+    uint64_t key_{};                      // 定时器的键
+};
+
+#endif // TIMER_WHEEL_H
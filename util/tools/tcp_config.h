@@ -1,11 +1,15 @@
 #ifndef TCP_CONFIG_H
 #define TCP_CONFIG_H
 
-#include <cstddef>             // 包含 size_t 的定义
-#include <cstdint>             // 包含固定宽度整数类型的定义
-#include <optional>            // 包含 std::optional 的定义
-#include "address.h"           // 包含自定义的地址类定义
-#include "wrapping_integers.h" // 包含自定义的包装整数类定义
+#include <algorithm>            // 包含 std::max 的定义
+#include <cstddef>              // 包含 size_t 的定义
+#include <cstdint>              // 包含固定宽度整数类型的定义
+#include <optional>             // 包含 std::optional 的定义
+#include "address.h"            // 包含自定义的地址类定义
+#include "byte_stream.h"        // 包含字节流的定义
+#include "congestion_control.h" // 包含拥塞控制算法的定义
+#include "reassembler.h"        // 包含重组器的定义
+#include "wrapping_integers.h"  // 包含自定义的包装整数类定义
 
 // TCPConfig 类用于配置 TCP 发送器和接收器的参数
 class TCPConfig
@@ -24,6 +28,61 @@ public:
     size_t recv_capacity = DEFAULT_CAPACITY; // 接收缓冲区的容量，单位为字节
     size_t send_capacity = DEFAULT_CAPACITY; // 发送缓冲区的容量，单位为字节
     Wrap32 isn{137};                         // 默认初始序列号，使用 Wrap32 类型
+
+    // 收发字节流的底层存储模式，Mirrored 使 peek() 一次返回全部缓冲数据
+    ByteStream::Storage stream_storage = ByteStream::Storage::Heap;
+    // 接收端重组器的乱序数据存储方式，Bitmap 直接写入接收字节流的存储，内存固定为窗口大小
+    Reassembler::Engine reassembler_engine = Reassembler::Engine::IntervalMap;
+    // 接收端重组器的乱序数据最多占用的池内存（字节），超出时丢弃最远的数据；进程上限见 Reassembler::set_global_pending_limit
+    uint64_t reassembler_pending_limit = UINT64_MAX;
+    // 按 RFC 6298 由 RTT 样本计算 RTO；关闭时每次收到新确认都回到 rt_timeout
+    bool adaptive_rto = false;
+    uint64_t rto_min = 200;   // 自适应 RTO 的下限，单位为毫秒
+    uint64_t rto_max = 60000; // 自适应 RTO 的上限，单位为毫秒
+    // 发送端的拥塞控制算法，None 时只受接收窗口限制
+    CongestionControl::Algorithm congestion_control = CongestionControl::Algorithm::None;
+    // 在 SYN 中声明支持 SACK（RFC 2018），对方也声明时接收端报告乱序到达的区间
+    bool sack = false;
+    // 在 SYN 中声明窗口扩大选项（RFC 7323），对方也声明时接收窗口可以超过 65535 字节
+    bool window_scaling = false;
+    // 发送端按令牌桶把窗口内的数据分散到一个往返内发出，而不是一次突发
+    bool pacing = false;
+    uint64_t pacing_rate = 0; // 固定的发送速率，单位为字节/毫秒，0 表示由拥塞窗口和 SRTT 计算
+    // 在 SYN 中声明的 MSS，也是发出的报文段长度的上限；实际长度不超过双方声明值中较小的一个
+    uint16_t mss = MAX_PAYLOAD_SIZE;
+    // 按 RFC 4821 探测路径 MTU：报文段长度从 MAX_PAYLOAD_SIZE 开始，探测成功后增长到协商的 MSS
+    bool mtu_probing = false;
+    // 按 RFC 8985 RACK-TLP 检测丢失：比已送达的报文段发得早、等待超过一个 RTT 的报文段判定丢失，
+    // 尾部丢失由约 2 * SRTT 后的探测重传发现，而不必等待 RTO
+    bool rack = false;
+    // 按 RFC 1122 4.2.3.2 延迟确认：按序到达的数据至少每两个满长报文段确认一次，否则至多等待 delayed_ack_ms；
+    // 乱序、填补空洞或带 SYN/FIN 的报文段立即确认。应用读走数据后，窗口右沿前移 min(接收缓冲区的一半, MSS)
+    // 以上才主动发送窗口更新（RFC 1122 4.2.3.3，避免糊涂窗口）
+    bool delayed_ack = false;
+    uint64_t delayed_ack_ms = 40; // 延迟确认的最长等待时间，单位为毫秒（RFC 1122 要求不超过 500）
+    // 接收缓冲区自动调整的上限：大于 recv_capacity 时，接收端按应用每个 RTT 读走的字节数
+    // 把缓冲区从 recv_capacity 逐步扩大到这里（类似 Linux 的 tcp_rmem 动态调整），0 表示不调整
+    size_t recv_capacity_max = 0;
+    // 首部预测（Van Jacobson）：本端空闲时按序到达、不带标志的数据跳过序列号展开和重组，
+    // 不在恢复或退避中时只推进确认号的纯确认跳过 SACK 记分板、重复确认和丢失检测等一般处理；其余报文段不受影响
+    bool header_prediction = true;
+
+    // 窗口扩大选项的移位数：能让整个接收缓冲区（自动调整时按上限）在 16 位窗口字段中表示的最小值（不超过 14），
+    // 未启用时为空
+    std::optional<uint8_t> window_scale() const
+    {
+        if (!window_scaling)
+        {
+            return std::nullopt;
+        }
+        const size_t capacity = std::max(recv_capacity, recv_capacity_max);
+        uint8_t shift = 0;
+        while (shift < 14 && (capacity >> shift) > UINT16_MAX)
+        {
+            ++shift;
+        }
+        return shift;
+    }
 };
 
 // FdAdapterConfig 类用于配置与文件描述符适配器相关的参数
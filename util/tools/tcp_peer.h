@@ -1,6 +1,7 @@
 #ifndef TCP_PEER_H
 #define TCP_PEER_H
 
+#include <algorithm>               // 包含 std::min、std::max 的定义
 #include <optional>                // 包含 std::optional 的定义
 #include <functional>              // 包含 std::function 的定义
 #include "tcp_config.h"            // 包含 TCP 配置的定义
@@ -9,6 +10,7 @@
 #include "tcp_segment.h"           // 包含 TCP 段的定义
 #include "tcp_sender.h"            // 包含 TCP 发送器的定义
 #include "tcp_sender_message.h"    // 包含 TCP 发送器消息的定义
+#include "timer_wheel.h"           // 包含时间轮的定义
 
 // TCPPeer 类用于管理 TCP 连接的发送和接收
 class TCPPeer
@@ -22,7 +24,10 @@ private:
 
 public:
     // 构造函数，接受 TCP 配置
-    explicit TCPPeer(const TCPConfig &cfg) : cfg_(cfg) {}
+    explicit TCPPeer(const TCPConfig &cfg) : cfg_(cfg) { restart_linger_timer(); }
+
+    // 使用上层共享的时间轮，本连接的定时器的键为 key：时间由上层推进，上层只在这个键的定时器到期时调用 tick()
+    TCPPeer(const TCPConfig &cfg, TimerWheel &wheel, uint64_t key) : cfg_(cfg), timers_(wheel, key) { restart_linger_timer(); }
 
     // 获取发送器的写入器
     Writer &outbound_writer() { return sender_.writer(); }
@@ -33,26 +38,50 @@ public:
     // 定义传输函数类型
     using TransmitFunction = std::function<void(TCPMessage)>;
 
-    // 将传输函数推送到发送器
-    void push(const TransmitFunction &transmit) { sender_.push(make_send(transmit)); }
+    // 应用写入或读走数据后调用：发出窗口允许的报文段，应用读走数据使窗口打开得足够多时发送窗口更新
+    void push(const TransmitFunction &transmit)
+    {
+        sync_option_length();
+        sender_.push(make_send(transmit));
+        if (window_update_due())
+        {
+            send(sender_.make_empty_message(), transmit);
+        }
+    }
 
-    // 处理时间推移，更新发送器状态
+    // 处理时间推移，更新发送器状态；使用共享的时间轮时 t 不起作用
     void tick(uint64_t t, const TransmitFunction &transmit)
     {
-        cumulative_time_ += t;                // 累加时间
+        timers_.advance(t);                   // 推进时间，延迟计时器到期后不再延迟
+        sync_option_length();                 // 重传也按当前的选项长度切分
         sender_.tick(t, make_send(transmit)); // 更新发送器状态
+        receiver_.autotune(timers_.now_ms(), sender_.srtt_ms()); // 按应用的读取速度扩大接收缓冲区
+
+        // 延迟确认到期，或者窗口已经打开得足够多
+        if (timers_.has_expired(delayed_ack_timer_) || window_update_due())
+        {
+            send(sender_.make_empty_message(), transmit);
+        }
+    }
+
+    // 取消本连接在时间轮上的所有定时器，上层删除连接之前调用
+    void cancel_timers()
+    {
+        timers_.cancel(linger_timer_);
+        timers_.cancel(delayed_ack_timer_);
+        sender_.cancel_timers();
     }
 
     // 检查是否有确认号
-    bool has_ackno() const { return receiver_.send().ackno.has_value(); }
+    bool has_ackno() const { return receiver_.ackno().has_value(); }
 
     // 检查 TCPPeer 是否处于活动状态
     bool active() const
     {
         const bool any_errors = receiver_.reader().has_error() || sender_.writer().has_error();                                     // 检查是否有错误
-        const bool sender_active = sender_.sequence_numbers_in_flight() || !sender_.reader().is_finished();                         // 检查发送器是否活跃
+        const bool sender_active = sender_.sequence_numbers_in_flight() || !sender_.input_sent();                                   // 检查发送器是否活跃
         const bool receiver_active = !receiver_.writer().is_closed();                                                               // 检查接收器是否活跃
-        const bool lingering = linger_after_streams_finish_ && (cumulative_time_ < time_of_last_receipt_ + 10UL * cfg_.rt_timeout); // 检查是否处于延迟状态
+        const bool lingering = linger_after_streams_finish_ && timers_.is_armed(linger_timer_);                                     // 检查是否处于延迟状态
 
         return (!any_errors) && (sender_active || receiver_active || lingering); // 返回活动状态
     }
@@ -66,24 +95,55 @@ public:
             return;
         }
 
-        // 更新最后接收时间
-        time_of_last_receipt_ = cumulative_time_;
+        // 首部预测命中时走快速路径
+        if (cfg_.header_prediction && receive_predicted(msg, transmit))
+        {
+            return;
+        }
+
+        // 从最后接收时间重新开始延迟计时
+        restart_linger_timer();
 
-        // 检查是否需要发送
-        need_send_ |= (msg.sender.sequence_length() > 0);
+        const auto our_ackno = receiver_.ackno();                                                // 获取当前的确认号
+        const bool keep_alive = our_ackno.has_value() && msg.sender.seqno + 1 == our_ackno.value(); // 保活探测需要回应
+        const bool occupies = msg.sender.sequence_length() > 0;                                  // 占用序列号的报文段需要确认
 
-        const auto our_ackno = receiver_.send().ackno;                                      // 获取当前的确认号
-        need_send_ |= (our_ackno.has_value() && msg.sender.seqno + 1 == our_ackno.value()); // 检查是否需要发送
+        // 检查是否需要立即发送：延迟确认时，只有按序到达的纯数据报文段可以等待
+        bool ack_now = keep_alive || (occupies && !cfg_.delayed_ack);
+        if (cfg_.delayed_ack && occupies)
+        {
+            const bool in_order = our_ackno.has_value() && msg.sender.seqno == our_ackno.value();
+            const bool fills_hole = receiver_.reassembler().bytes_pending() > 0;
+            ack_now |= !in_order || fills_hole || msg.sender.SYN || msg.sender.FIN;
+            rcv_mss_ = std::max<uint64_t>(rcv_mss_, msg.sender.payload.size());
+            unacked_bytes_ += msg.sender.payload.size();
+            ack_now |= unacked_bytes_ >= 2 * rcv_mss_;
+        }
 
         // 如果接收器的写入器已关闭且发送器的读取器未完成，设置延迟状态
-        if (receiver_.writer().is_closed() && !sender_.reader().is_finished())
+        if (receiver_.writer().is_closed() && !sender_.input_sent())
         {
             linger_after_streams_finish_ = false;
         }
 
+        // 对方的 SYN 决定本端发出的报文段长度上限
+        if (msg.sender.SYN)
+        {
+            sender_.set_peer_mss(msg.sender.mss);
+        }
+
         // 接收消息并处理
         receiver_.receive(std::move(msg.sender)); // 处理发送者消息
         sender_.receive(msg.receiver);            // 处理接收者消息
+        receiver_.autotune(timers_.now_ms(), sender_.srtt_ms());
+
+        // 没有被接收（例如超出窗口）的数据也立即确认，让对方知道当前的确认号和窗口
+        ack_now |= cfg_.delayed_ack && occupies && receiver_.ackno() == our_ackno;
+        need_send_ |= ack_now;
+        if (cfg_.delayed_ack && occupies && !ack_now && !timers_.is_armed(delayed_ack_timer_))
+        {
+            delayed_ack_timer_ = timers_.arm(timers_.now_ms() + cfg_.delayed_ack_ms);
+        }
 
         push(transmit); // 推送传输函数
         if (need_send_)
@@ -100,22 +160,117 @@ public:
 
 private:
     TCPConfig cfg_;                                                               // TCP 配置
-    TCPSender sender_{ByteStream{cfg_.send_capacity}, cfg_.isn, cfg_.rt_timeout}; // 创建发送器
-    TCPReceiver receiver_{Reassembler{ByteStream{cfg_.recv_capacity}}};           // 创建接收器
+    WheelRef timers_{};                                                           // 当前时间及本连接的定时器，发送器也使用它
+    TCPSender sender_{ByteStream{cfg_.send_capacity, cfg_.stream_storage}, cfg_.isn, cfg_.rt_timeout, TCPSender::Options::from_config(cfg_), {timers_.wheel(), timers_.key()}}; // 创建发送器
+    TCPReceiver receiver_{Reassembler{ByteStream{cfg_.recv_capacity, cfg_.stream_storage}, cfg_.reassembler_engine, cfg_.reassembler_pending_limit}, cfg_.window_scale(), cfg_.recv_capacity_max}; // 创建接收器
 
     bool need_send_{}; // 标记是否需要发送
 
+    // 首部预测的快速路径（cfg_.header_prediction）：按序到达的纯数据报文段在本端没有待发送的数据时
+    // 只需交给接收器并决定何时确认；推进确认号的纯确认（或本端空闲时不改变任何状态的确认）跳过接收器的一般处理，
+    // 发送器只弹出被确认的报文段并重新启动计时器，然后发出窗口允许的新数据。
+    // 两种情况下的结果都与 receive() 的一般路径相同，不满足条件时返回 false
+    bool receive_predicted(TCPMessage &msg, const TransmitFunction &transmit)
+    {
+        const bool occupies = !msg.sender.payload.empty();
+        if (msg.receiver.RST || sender_.writer().has_error() || !receiver_.predicted(msg.sender))
+        {
+            return false;
+        }
+        const bool idle = sender_.is_idle(msg.receiver);
+        if (occupies ? !idle : !idle && !sender_.predicted(msg.receiver))
+        {
+            return false;
+        }
+
+        restart_linger_timer();
+        if (!occupies)
+        {
+            receiver_.receive_predicted(std::move(msg.sender));
+            if (!idle)
+            {
+                sender_.receive_predicted(msg.receiver);
+            }
+            push(transmit);
+        }
+        else
+        {
+            // 延迟确认时按序数据每两个满长报文段确认一次；发送器空闲，确认不会改变它的状态
+            bool ack_now = !cfg_.delayed_ack;
+            if (cfg_.delayed_ack)
+            {
+                rcv_mss_ = std::max<uint64_t>(rcv_mss_, msg.sender.payload.size());
+                unacked_bytes_ += msg.sender.payload.size();
+                ack_now = unacked_bytes_ >= 2 * rcv_mss_;
+            }
+            receiver_.receive_predicted(std::move(msg.sender));
+            receiver_.autotune(timers_.now_ms(), sender_.srtt_ms());
+            need_send_ |= ack_now;
+            if (cfg_.delayed_ack && !ack_now && !timers_.is_armed(delayed_ack_timer_))
+            {
+                delayed_ack_timer_ = timers_.arm(timers_.now_ms() + cfg_.delayed_ack_ms);
+            }
+        }
+
+        if (need_send_)
+        {
+            send(sender_.make_empty_message(), transmit);
+        }
+        return true;
+    }
+
     // 发送消息的私有方法
     void send(const TCPSenderMessage &sender_message, const TransmitFunction &transmit)
     {
         TCPMessage msg{sender_message, receiver_.send()}; // 创建 TCP 消息
+        receiver_.sent();                                 // 接收器记录通告的窗口
+        advertised_right_edge_ = receiver_.writer().bytes_pushed() + msg.receiver.window_size; // 记录通告的窗口右沿
         transmit(std::move(msg));                         // 传输消息
         need_send_ = false;                               // 重置发送标记
+        unacked_bytes_ = 0;                               // 每个报文段都携带确认
+        timers_.cancel(delayed_ack_timer_);
+    }
+
+    // 发出的报文段会带上接收器的 SACK 块，发送器据此减少有效载荷
+    void sync_option_length() { sender_.set_option_length(receiver_.sack_option_length()); }
+
+    // 延迟确认时，对方可用的窗口已不足接收缓冲区的一半、而应用读走数据后窗口右沿又前移了
+    // min(接收缓冲区的一半, 对方的报文段长度) 以上，才单独发送窗口更新
+    bool window_update_due() const
+    {
+        if (!cfg_.delayed_ack || !has_ackno() || receiver_.writer().is_closed())
+        {
+            return false;
+        }
+        const uint64_t half_buffer = receiver_.writer().capacity() / 2;
+        const uint64_t usable = advertised_right_edge_ - std::min(advertised_right_edge_, receiver_.writer().bytes_pushed());
+        const uint64_t threshold = std::max<uint64_t>(std::min(half_buffer, rcv_mss_), 1);
+        return usable < half_buffer && receiver_.window_right_edge() >= advertised_right_edge_ + threshold;
     }
 
     bool linger_after_streams_finish_{true}; // 标记是否在流结束后延迟
-    uint64_t cumulative_time_{};             // 累计时间
-    uint64_t time_of_last_receipt_{};        // 最后接收时间
+    TimerWheel::TimerId linger_timer_{};     // 最后接收时间之后 10 个 RTO 到期
+    uint64_t linger_deadline_{};             // 延迟计时器的到期时间
+
+    // 延迟确认（cfg_.delayed_ack）
+    TimerWheel::TimerId delayed_ack_timer_{}; // 有尚未确认的数据时，到期后发送确认
+    uint64_t unacked_bytes_{};                // 上次发送后收到的、尚未确认的按序数据
+    uint64_t rcv_mss_{};                      // 对方发来的最长有效载荷，视为满长报文段
+    uint64_t advertised_right_edge_{};        // 上次发送时通告的窗口右沿
+
+    // 从当前时间重新开始延迟计时
+    void restart_linger_timer()
+    {
+        // 同一毫秒内收到多个报文段时到期时间不变，不必重新挂到时间轮上
+        const uint64_t deadline = timers_.now_ms() + 10UL * cfg_.rt_timeout;
+        if (deadline == linger_deadline_ && timers_.is_armed(linger_timer_))
+        {
+            return;
+        }
+        timers_.cancel(linger_timer_);
+        linger_timer_ = timers_.arm(deadline);
+        linger_deadline_ = deadline;
+    }
 };
 
 #endif
@@ -1,7 +1,10 @@
 #ifndef TCP_RECEIVER_MESSAGE_H
 #define TCP_RECEIVER_MESSAGE_H
 
+#include <algorithm>            // 引入 std::min
+#include <cstddef>              // 引入 size_t
 #include <optional>             // 引入 std::optional，用于表示可选值
+#include <vector>               // 引入 std::vector，用于存储 SACK 块
 #include "wrapping_integers.h"  // 引入自定义的整数包装类，用于处理序列号
 
 /*
@@ -13,17 +16,39 @@
  *    这是一个可选字段，如果 TCPReceiver 尚未接收到初始序列号，则为空。
  *
  * 2) 窗口大小 (window_size): TCP 接收方希望接收的序列号的数量，
- *    从 ackno 开始（如果存在）。最大值为 65,535 (UINT16_MAX 来自 <cstdint> 头文件)。
+ *    从 ackno 开始（如果存在）。没有协商窗口扩大（RFC 7323）时最大值为 65,535，
+ *    协商后可达 65,535 << 14；线路上的 16 位字段由 TCPOverIPv4Adapter 按协商的移位数缩放。
  *
  * 3) RST (重置) 标志: 如果设置，表示流发生错误，连接应被中止。
+ *
+ * 4) SACK 块 (sack_blocks): 接收方已收到、但因前面有空洞而尚未确认的序列号区间（RFC 2018）。
+ *    只有对方在 SYN 中声明支持 SACK 时才会填写，第一个块包含最近收到的报文段。
  */
 
+// 一个 SACK 块：已收到的序列号区间 [begin, end)
+struct SackBlock
+{
+    Wrap32 begin{0}; // 区间的第一个序列号
+    Wrap32 end{0};   // 区间之后的第一个序列号
+};
+
 // TCPReceiverMessage 结构体定义
 struct TCPReceiverMessage
 {
     std::optional<Wrap32> ackno{}; // 确认号，表示下一个期望的序列号，使用 std::optional 表示可选性
-    uint16_t window_size{};        // 窗口大小，表示接收方希望接收的序列号数量
+    uint32_t window_size{};        // 窗口大小，表示接收方希望接收的序列号数量
     bool RST{};                    // RST 标志，表示连接是否应被重置
+
+    std::vector<SackBlock> sack_blocks{}; // SACK 块，最多 MAX_SACK_BLOCKS 个
+
+    // TCP 选项区（40 字节）最多容纳的 SACK 块数
+    static constexpr size_t MAX_SACK_BLOCKS = 4;
+
+    // SACK 选项在线路上占用的字节数（包括对齐用的两个 NOP），不带 SACK 块时为 0
+    size_t sack_option_length() const
+    {
+        return !ackno.has_value() || sack_blocks.empty() ? 0 : 4 + 8 * std::min(sack_blocks.size(), MAX_SACK_BLOCKS);
+    }
 };
 
 #endif // TCP_RECEIVER_MESSAGE_H
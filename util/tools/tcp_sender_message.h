@@ -1,6 +1,8 @@
 #ifndef TCP_SENDER_MESSAGE_H
 #define TCP_SENDER_MESSAGE_H
 
+#include <cstdint>              // 引入固定宽度整数类型
+#include <optional>             // 引入 std::optional，用于表示可选的选项
 #include <string>               // 引入字符串类
 #include "wrapping_integers.h"  // 引入自定义的整数包装类，用于处理序列号
 
@@ -19,6 +21,13 @@
  * 4) FIN 标志: 如果设置，有效载荷表示字节流的结束。
  *
  * 5) RST (重置) 标志: 如果设置，表示流发生错误，连接应被中止。
+ *
+ * 6) SACK 许可 (sack_permitted): 只在 SYN 上有意义，表示发送方愿意接收 SACK 块（RFC 2018）。
+ *
+ * 7) 窗口扩大 (window_scale): 只在 SYN 上有意义，发送方接收窗口的移位数（RFC 7323）。
+ *    双方的 SYN 都带有该选项时，之后的窗口字段按各自声明的移位数缩放。
+ *
+ * 8) 最大报文段长度 (mss): 只在 SYN 上有意义，发送方能接收的最大有效载荷（RFC 9293 3.7.1）。
  */
 
 // TCPSenderMessage 结构体定义
@@ -32,6 +41,10 @@ struct TCPSenderMessage
 
     bool RST{}; // RST 标志，表示连接是否应被重置
 
+    bool sack_permitted{};                // SYN 上的 SACK 许可选项
+    std::optional<uint8_t> window_scale{}; // SYN 上的窗口扩大选项
+    std::optional<uint16_t> mss{};         // SYN 上的最大报文段长度选项
+
     // 计算该段使用的序列号数量
     size_t sequence_length() const
     {